@@ -0,0 +1,313 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_adc.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/adc.h>
+#include <driverlib/timer.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dma.h"
+#include "timebase.h"
+#include "adc.h"
+
+// Periodic trigger for both ADCs, full 32-bit width
+#define ADC_TIMER_BASE      TIMER3_BASE
+#define ADC_TIMER_PERIPH    SYSCTL_PERIPH_TIMER3
+
+// Sequencer 0 is the only one with an eight sample FIFO
+#define ADC_SEQ             0
+
+#define ADC_CHANNELS        12
+
+typedef struct {
+    uint32_t base;
+    uint32_t periph;
+    uint32_t int_num;
+    dma_pingpong_t dma;
+
+    adc_stream_config_t config;
+    bool configured;
+
+    // Block index loaded into the primary and alternate structures
+    uint32_t armed[2];
+
+    // Blocks neither armed nor held by the caller
+    volatile uint32_t free;
+
+    adc_stream_stats_t stats;
+    uint32_t completions;
+    uint64_t first_ns;
+    uint64_t last_ns;
+} adc_stream_t;
+
+static adc_stream_t adc_streams[2] = {
+    {ADC0_BASE, SYSCTL_PERIPH_ADC0, INT_ADC0SS0, {UDMA_CHANNEL_ADC0}},
+    {ADC1_BASE, SYSCTL_PERIPH_ADC1, INT_ADC1SS0, {UDMA_SEC_CHANNEL_ADC10}},
+};
+
+// Pin behind each analog input
+static const struct {
+    uint32_t periph;
+    uint32_t base;
+    uint8_t pin;
+} adc_pins[ADC_CHANNELS] = {
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_3},
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_2},
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_1},
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_0},
+    {SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_3},
+    {SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_2},
+    {SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_1},
+    {SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE, GPIO_PIN_0},
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_5},
+    {SYSCTL_PERIPH_GPIOE, GPIO_PORTE_BASE, GPIO_PIN_4},
+    {SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PIN_4},
+    {SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE, GPIO_PIN_5},
+};
+
+// uDMA burst per frame, indexed by log2 of the channel count
+static const uint32_t adc_arb[4] = {UDMA_ARB_1, UDMA_ARB_2, UDMA_ARB_4, UDMA_ARB_8};
+
+static uint32_t adc_rate_hz;
+
+static uint16_t *adc_block(const adc_stream_t *s, uint32_t index) {
+    return s->config.blocks + index * s->config.block_len;
+}
+
+static void adc_arm(const adc_stream_t *s, uint32_t half, uint32_t index) {
+    MAP_uDMAChannelTransferSet(s->dma.channel | (half ? UDMA_ALT_SELECT : UDMA_PRI_SELECT),
+                               UDMA_MODE_PINGPONG,
+                               (void *)(s->base + ADC_O_SSFIFO0),
+                               adc_block(s, index), s->config.block_len);
+}
+
+uint32_t adc_stream_init(uint32_t rate_hz) {
+    uint32_t load;
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(ADC_TIMER_PERIPH);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    load = MAP_SysCtlClockGet() / rate_hz;
+    if(load == 0) {
+        load = 1;
+    }
+
+    MAP_TimerConfigure(ADC_TIMER_BASE, TIMER_CFG_PERIODIC);
+    MAP_TimerLoadSet(ADC_TIMER_BASE, TIMER_A, load - 1);
+    MAP_TimerControlTrigger(ADC_TIMER_BASE, TIMER_A, true);
+
+    adc_rate_hz = MAP_SysCtlClockGet() / load;
+    return adc_rate_hz;
+}
+
+int adc_stream_config(uint32_t adc, const adc_stream_config_t *config) {
+    adc_stream_t *s;
+    uint32_t i, n = config->nchannels;
+
+    if(adc > 1 || !adc_rate_hz) {
+        return -1;
+    }
+    if((n != 1 && n != 2 && n != 4 && n != 8) || adc_rate_hz > ADC_STREAM_MAX_SPS / n) {
+        return -1;
+    }
+    if(config->block_len == 0 || config->block_len % n ||
+       config->block_len > ADC_STREAM_BLOCK_MAX) {
+        return -1;
+    }
+    if(config->nblocks < 3 || config->nblocks > 32 || !config->callback) {
+        return -1;
+    }
+    for(i = 0; i < n; i++) {
+        if(config->channels[i] >= ADC_CHANNELS) {
+            return -1;
+        }
+    }
+
+    s = &adc_streams[adc];
+    s->config = *config;
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(s->periph);
+    for(i = 0; i < n; i++) {
+        MAP_SysCtlPeripheralEnable(adc_pins[config->channels[i]].periph);
+    }
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    for(i = 0; i < n; i++) {
+        MAP_GPIOPinTypeADC(adc_pins[config->channels[i]].base, adc_pins[config->channels[i]].pin);
+    }
+
+    // One step per channel, the last one ends the frame and requests the
+    // uDMA burst. The sequencer interrupt itself stays masked
+    MAP_ADCSequenceDisable(s->base, ADC_SEQ);
+    MAP_ADCSequenceConfigure(s->base, ADC_SEQ, ADC_TRIGGER_TIMER, 0);
+    for(i = 0; i < n; i++) {
+        MAP_ADCSequenceStepConfigure(s->base, ADC_SEQ, i, (ADC_CTL_CH0 + config->channels[i]) |
+                                     ((i == n - 1) ? (ADC_CTL_IE | ADC_CTL_END) : 0));
+    }
+
+    dma_init();
+    if(adc == 1) {
+        MAP_uDMAChannelAssign(UDMA_CH24_ADC1_0);
+    }
+    MAP_uDMAChannelAttributeDisable(s->dma.channel, UDMA_ATTR_ALTSELECT | UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelAttributeEnable(s->dma.channel, UDMA_ATTR_HIGH_PRIORITY);
+    MAP_uDMAChannelControlSet(s->dma.channel | UDMA_PRI_SELECT, UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_16 | adc_arb[__builtin_ctz(n)]);
+    MAP_uDMAChannelControlSet(s->dma.channel | UDMA_ALT_SELECT, UDMA_SIZE_16 | UDMA_SRC_INC_NONE |
+                              UDMA_DST_INC_16 | adc_arb[__builtin_ctz(n)]);
+
+    s->configured = true;
+    return 0;
+}
+
+void adc_stream_start(void) {
+    adc_stream_t *s;
+    uint32_t adc;
+
+    for(adc = 0; adc < 2; adc++) {
+        s = &adc_streams[adc];
+        if(!s->configured) {
+            continue;
+        }
+
+        s->armed[0] = 0;
+        s->armed[1] = 1;
+        s->free = ((s->config.nblocks == 32) ? 0xFFFFFFFF : (1u << s->config.nblocks) - 1) & ~3u;
+        s->completions = 0;
+        memset(&s->stats, 0, sizeof(s->stats));
+        s->stats.rate_hz = adc_rate_hz;
+
+        adc_arm(s, 0, 0);
+        adc_arm(s, 1, 1);
+        dma_pingpong_start(&s->dma);
+
+        MAP_ADCSequenceOverflowClear(s->base, ADC_SEQ);
+        MAP_ADCIntClear(s->base, ADC_SEQ);
+        MAP_ADCSequenceDMAEnable(s->base, ADC_SEQ);
+        MAP_ADCSequenceEnable(s->base, ADC_SEQ);
+        MAP_IntEnable(s->int_num);
+    }
+
+    MAP_TimerEnable(ADC_TIMER_BASE, TIMER_A);
+}
+
+void adc_stream_stop(void) {
+    adc_stream_t *s;
+    uint32_t adc;
+
+    MAP_TimerDisable(ADC_TIMER_BASE, TIMER_A);
+
+    for(adc = 0; adc < 2; adc++) {
+        s = &adc_streams[adc];
+        if(!s->configured) {
+            continue;
+        }
+
+        MAP_IntDisable(s->int_num);
+        MAP_ADCSequenceDisable(s->base, ADC_SEQ);
+        MAP_ADCSequenceDMADisable(s->base, ADC_SEQ);
+        MAP_uDMAChannelDisable(s->dma.channel);
+    }
+}
+
+void adc_stream_release(uint32_t adc, const uint16_t *block) {
+    adc_stream_t *s = &adc_streams[adc];
+    uint32_t primask;
+
+    primask = cpu_irq_save();
+    s->free |= 1u << ((block - s->config.blocks) / s->config.block_len);
+    cpu_irq_restore(primask);
+}
+
+void adc_stream_stats_get(uint32_t adc, adc_stream_stats_t *stats) {
+    adc_stream_t *s = &adc_streams[adc];
+    uint32_t primask, completions;
+    uint64_t elapsed;
+
+    primask = cpu_irq_save();
+    *stats = s->stats;
+    completions = s->completions;
+    elapsed = s->last_ns - s->first_ns;
+    cpu_irq_restore(primask);
+
+    // Frames from the end of the first block to the end of the latest
+    if(completions > 1 && elapsed) {
+        stats->measured_hz = (uint64_t)(completions - 1) * (s->config.block_len / s->config.nchannels) *
+                             1000000000ULL / elapsed;
+    }
+}
+
+// A half finished. Re-arm it first, the other half is already filling
+// and this one has until that completes
+static bool adc_complete(void *ctx, uint32_t half) {
+    adc_stream_t *s = ctx;
+    uint32_t done = s->armed[half];
+    uint32_t index;
+    bool deliver = s->free != 0;
+    uint64_t now = timebase_ns();
+
+    if(deliver) {
+        index = __builtin_ctz(s->free);
+        s->free &= ~(1u << index);
+    } else {
+        index = done;
+        s->stats.dropped++;
+    }
+
+    adc_arm(s, half, index);
+    s->armed[half] = index;
+
+    if(s->completions++ == 0) {
+        s->first_ns = now;
+    }
+    s->last_ns = now;
+
+    if(deliver) {
+        s->stats.blocks++;
+        s->stats.samples += s->config.block_len;
+        s->config.callback(s->config.ctx, adc_block(s, done), s->config.block_len);
+    }
+    return true;
+}
+
+static void adc_service(adc_stream_t *s) {
+    MAP_ADCIntClear(s->base, ADC_SEQ);
+
+    if(MAP_ADCSequenceOverflow(s->base, ADC_SEQ)) {
+        MAP_ADCSequenceOverflowClear(s->base, ADC_SEQ);
+        s->stats.overflows++;
+    }
+
+    // Both halves ran out before this interrupt got to re-arm either, so
+    // the channel stopped. The FIFO overflow above counts the gap
+    if(!dma_pingpong_service(&s->dma, adc_complete, s)) {
+        dma_pingpong_restart(&s->dma);
+    }
+}
+
+// Bound into nvic_table by name
+void adc0_seq0_handler(void) {
+    adc_service(&adc_streams[0]);
+}
+
+// Bound into nvic_table by name
+void adc1_seq0_handler(void) {
+    adc_service(&adc_streams[1]);
+}
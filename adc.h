@@ -0,0 +1,95 @@
+#ifndef __ADC_H__
+#define __ADC_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Continuous ADC sampling into caller supplied blocks, with no interrupt
+ * per sample.
+ *
+ * Timer 3A triggers sample sequencer 0 of each ADC in use, and every
+ * trigger converts each configured channel once (a frame). The last step
+ * of the sequence requests one uDMA burst that moves the whole frame out
+ * of the sequencer FIFO. uDMA runs in ping-pong mode between two blocks,
+ * so the CPU sees one interrupt per filled block. That interrupt re-arms
+ * the finished half with a free block and passes the filled one to the
+ * callback in place. The block then belongs to the caller until
+ * adc_stream_release(), so it can be processed in the callback or later
+ * from the main loop without a copy.
+ *
+ * If no block is free when a half needs re-arming, the block that just
+ * filled is reused and its samples are counted as dropped. Blocks that
+ * are still being processed are never overwritten.
+ *
+ * Both ADCs share the trigger, so two streams of up to eight channels each
+ * sample in step. Samples within a block are interleaved by channel in
+ * the order given.
+ *
+ *     static uint16_t blocks[4][256];
+ *     static const uint8_t channels[] = {0, 1};
+ *
+ *     adc_stream_config_t config = {
+ *         channels, 2, &blocks[0][0], 256, 4, process_block, NULL
+ *     };
+ *
+ *     adc_stream_init(100000);
+ *     adc_stream_config(0, &config);
+ *     adc_stream_start();
+ */
+
+// Conversions per second one ADC can sustain
+#define ADC_STREAM_MAX_SPS      1000000
+
+// Longest block, one uDMA transfer
+#define ADC_STREAM_BLOCK_MAX    1024
+
+// Called from the ADC interrupt with a filled block of len samples
+typedef void (*adc_stream_cb_t)(void *ctx, uint16_t *block, uint32_t len);
+
+typedef struct {
+    const uint8_t *channels;    // AIN numbers 0-11, sampled in this order
+    uint32_t nchannels;         // 1, 2, 4 or 8
+    uint16_t *blocks;           // nblocks * block_len samples
+    uint32_t block_len;         // multiple of nchannels, up to ADC_STREAM_BLOCK_MAX
+    uint32_t nblocks;           // 3 to 32
+    adc_stream_cb_t callback;
+    void *ctx;
+} adc_stream_config_t;
+
+typedef struct {
+    uint32_t blocks;            // blocks passed to the callback
+    uint32_t dropped;           // blocks lost because none was free
+    uint32_t overflows;         // sequencer FIFO overflows, uDMA fell behind
+    uint64_t samples;           // samples passed to the callback
+    uint32_t rate_hz;           // frame rate the timer was set to
+    uint32_t measured_hz;       // frame rate seen between the first and latest block
+} adc_stream_stats_t;
+
+// Set up the trigger timer for rate_hz frames per second. Returns the rate
+// actually produced, which is the core clock over a whole divisor
+uint32_t adc_stream_init(uint32_t rate_hz);
+
+// Configure ADC 0 or 1 for streaming. Call after adc_stream_init() and
+// while stopped. Returns -1 if the configuration is invalid or the frame
+// rate is more than the ADC can convert
+int adc_stream_config(uint32_t adc, const adc_stream_config_t *config);
+
+// Start or stop every configured stream. Starting clears the statistics
+// and takes back any blocks still held
+void adc_stream_start(void);
+void adc_stream_stop(void);
+
+// Hand a block passed to the callback back for reuse. Safe from interrupts
+void adc_stream_release(uint32_t adc, const uint16_t *block);
+
+void adc_stream_stats_get(uint32_t adc, adc_stream_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
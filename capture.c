@@ -0,0 +1,413 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_timer.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dma.h"
+#include "gpiopin.h"
+#include "timebase.h"
+#include "capture.h"
+
+// Timer halves, A then B of each timer
+#define CAPTURE_TIMERS      5
+#define CAPTURE_CHANNELS    (CAPTURE_TIMERS * 2)
+
+// Half mode register values: capture, counting up, edge time or count
+#define CAPTURE_MR_TIME     (TIMER_TAMR_TACDIR | TIMER_TAMR_TACMR | TIMER_TAMR_TAMR_CAP)
+#define CAPTURE_MR_COUNT    (TIMER_TAMR_TACDIR | TIMER_TAMR_TAMR_CAP)
+
+// uDMA channel number out of a uDMAChannelAssign() mapping
+#define CAPTURE_DMA_CHANNEL(assign) ((assign) & 0xFF)
+
+static const struct {
+    uint32_t base;
+    uint32_t periph;
+    bool wide;
+} capture_timers[CAPTURE_TIMERS] = {
+    {TIMER1_BASE,  SYSCTL_PERIPH_TIMER1,  false},
+    {TIMER2_BASE,  SYSCTL_PERIPH_TIMER2,  false},
+    {WTIMER1_BASE, SYSCTL_PERIPH_WTIMER1, true},
+    {WTIMER2_BASE, SYSCTL_PERIPH_WTIMER2, true},
+    {WTIMER4_BASE, SYSCTL_PERIPH_WTIMER4, true},
+};
+
+// Interrupt and uDMA mapping of each half
+static const struct {
+    uint32_t int_num;
+    uint32_t dma_assign;
+} capture_halves[CAPTURE_CHANNELS] = {
+    {INT_TIMER1A,  UDMA_CH20_TIMER1A},
+    {INT_TIMER1B,  UDMA_CH21_TIMER1B},
+    {INT_TIMER2A,  UDMA_CH4_TIMER2A},
+    {INT_TIMER2B,  UDMA_CH5_TIMER2B},
+    {INT_WTIMER1A, UDMA_CH12_WTIMER1A},
+    {INT_WTIMER1B, UDMA_CH13_WTIMER1B},
+    {INT_WTIMER2A, UDMA_CH16_WTIMER2A},
+    {INT_WTIMER2B, UDMA_CH17_WTIMER2B},
+    {INT_WTIMER4A, UDMA_CH26_WTIMER4A},
+    {INT_WTIMER4B, UDMA_CH27_WTIMER4B},
+};
+
+// Capture pins, and the half each one feeds
+static const struct {
+    uint8_t port;
+    uint8_t pin;
+    uint8_t ch;
+    uint32_t pin_config;
+} capture_pins[] = {
+    {1, 4, 0, GPIO_PB4_T1CCP0},
+    {5, 2, 0, GPIO_PF2_T1CCP0},
+    {1, 5, 1, GPIO_PB5_T1CCP1},
+    {5, 3, 1, GPIO_PF3_T1CCP1},
+    {1, 0, 2, GPIO_PB0_T2CCP0},
+    {5, 4, 2, GPIO_PF4_T2CCP0},
+    {1, 1, 3, GPIO_PB1_T2CCP1},
+    {2, 6, 4, GPIO_PC6_WT1CCP0},
+    {2, 7, 5, GPIO_PC7_WT1CCP1},
+    {3, 0, 6, GPIO_PD0_WT2CCP0},
+    {3, 1, 7, GPIO_PD1_WT2CCP1},
+    {3, 4, 8, GPIO_PD4_WT4CCP0},
+    {3, 5, 9, GPIO_PD5_WT4CCP1},
+};
+
+#define CAPTURE_NUM_PINS    (sizeof(capture_pins) / sizeof(*capture_pins))
+
+typedef struct {
+    capture_config_t config;
+    bool open;
+
+    uint32_t base;
+    uint32_t half;              // TIMER_A or TIMER_B
+    dma_pingpong_t dma;
+    uint32_t port_base;
+    uint8_t pin_mask;
+    uint32_t mask;              // timestamp width
+    uint32_t clock_hz;
+
+    // Edge time: the last edge seen
+    uint32_t last;
+    bool rising;                // the next edge captured is rising
+    bool primed;                // last is valid
+
+    // Edge count: cycle count at the previous match
+    uint64_t last_cycles;
+
+    capture_result_t result;
+} capture_channel_t;
+
+static capture_channel_t capture_channels[CAPTURE_CHANNELS];
+
+// Open halves per timer, the split configuration is set by the first
+static uint8_t capture_users[CAPTURE_TIMERS];
+
+static void capture_arm(const capture_channel_t *c, uint32_t half) {
+    uint32_t len = 2 * c->config.window;
+
+    MAP_uDMAChannelTransferSet(c->dma.channel | (half ? UDMA_ALT_SELECT : UDMA_PRI_SELECT),
+                               UDMA_MODE_PINGPONG,
+                               (void *)(c->base + ((c->half == TIMER_A) ? TIMER_O_TAR : TIMER_O_TBR)),
+                               c->config.buffer + half * len, len);
+}
+
+// Latch the polarity of the next edge and let the half run. Only the time
+// of an edge is captured, so the stream of edges is only as right as this
+static void capture_sync(capture_channel_t *c) {
+    uint32_t primask = cpu_irq_save();
+
+    c->rising = !MAP_GPIOPinRead(c->port_base, c->pin_mask);
+    c->primed = false;
+    MAP_TimerEnable(c->base, c->half);
+
+    cpu_irq_restore(primask);
+}
+
+int capture_open(uint32_t port, uint32_t pin, const capture_config_t *config) {
+    capture_channel_t *c;
+    uint32_t i, ch, timer, primask, port_base, port_periph;
+    bool wide;
+
+    for(i = 0; i < CAPTURE_NUM_PINS; i++) {
+        if(capture_pins[i].port == port && capture_pins[i].pin == pin) {
+            break;
+        }
+    }
+    if(i == CAPTURE_NUM_PINS || gpio_port_lookup(port, &port_base, &port_periph) < 0) {
+        return -1;
+    }
+    if(config->window == 0) {
+        return -1;
+    }
+    if(config->mode == CAPTURE_EDGE_TIME) {
+        if(config->window > CAPTURE_WINDOW_MAX || !config->buffer) {
+            return -1;
+        }
+    } else if(config->mode != CAPTURE_EDGE_COUNT || config->window > CAPTURE_COUNT_MAX) {
+        return -1;
+    }
+
+    ch = capture_pins[i].ch;
+    timer = ch / 2;
+    wide = capture_timers[timer].wide;
+    c = &capture_channels[ch];
+
+    primask = cpu_irq_save();
+    if(c->open) {
+        cpu_irq_restore(primask);
+        return -1;
+    }
+    c->open = true;
+    cpu_irq_restore(primask);
+
+    c->config = *config;
+    c->base = capture_timers[timer].base;
+    c->half = (ch & 1) ? TIMER_B : TIMER_A;
+    c->dma.channel = CAPTURE_DMA_CHANNEL(capture_halves[ch].dma_assign);
+    c->port_base = port_base;
+    c->pin_mask = 1 << pin;
+    c->mask = wide ? 0xFFFFFFFF : 0xFFFFFF;
+    c->clock_hz = MAP_SysCtlClockGet();
+    memset(&c->result, 0, sizeof(c->result));
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(capture_timers[timer].periph);
+    MAP_SysCtlPeripheralEnable(port_periph);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_GPIOPinConfigure(capture_pins[i].pin_config);
+    MAP_GPIOPinTypeTimer(c->port_base, c->pin_mask);
+
+    // TimerConfigure() sets both halves at once and stops them, so the
+    // halves are set up through their own mode registers instead
+    MAP_TimerDisable(c->base, c->half);
+    if(capture_users[timer]++ == 0) {
+        HWREG(c->base + TIMER_O_CFG) = TIMER_CFG_16_BIT;
+    }
+    HWREG(c->base + ((c->half == TIMER_A) ? TIMER_O_TAMR : TIMER_O_TBMR)) =
+        (config->mode == CAPTURE_EDGE_TIME) ? CAPTURE_MR_TIME : CAPTURE_MR_COUNT;
+
+    // Count up through the full range. On the 16/32-bit timers the
+    // prescaler extends the count to 24 bits, in the captured value too
+    MAP_TimerLoadSet(c->base, c->half, wide ? 0xFFFFFFFF : 0xFFFF);
+    MAP_TimerPrescaleSet(c->base, c->half, wide ? 0 : 0xFF);
+
+    if(config->mode == CAPTURE_EDGE_TIME) {
+        MAP_TimerControlEvent(c->base, c->half, TIMER_EVENT_BOTH_EDGES);
+
+        // Each capture event requests one transfer of the latched value.
+        // The event interrupt stays masked, the timer vector only sees
+        // uDMA completions
+        dma_init();
+        MAP_uDMAChannelAssign(capture_halves[ch].dma_assign);
+        MAP_uDMAChannelAttributeDisable(c->dma.channel, UDMA_ATTR_ALTSELECT | UDMA_ATTR_REQMASK);
+        MAP_uDMAChannelAttributeEnable(c->dma.channel, UDMA_ATTR_HIGH_PRIORITY);
+        MAP_uDMAChannelControlSet(c->dma.channel | UDMA_PRI_SELECT, UDMA_SIZE_32 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_32 | UDMA_ARB_1);
+        MAP_uDMAChannelControlSet(c->dma.channel | UDMA_ALT_SELECT, UDMA_SIZE_32 | UDMA_SRC_INC_NONE |
+                                  UDMA_DST_INC_32 | UDMA_ARB_1);
+        capture_arm(c, 0);
+        capture_arm(c, 1);
+        dma_pingpong_start(&c->dma);
+    } else {
+        // Up counting edge count starts again from 0 at the match and
+        // carries on, so no edge is missed while the interrupt is pending
+        MAP_TimerControlEvent(c->base, c->half, TIMER_EVENT_POS_EDGE);
+        MAP_TimerMatchSet(c->base, c->half, config->window);
+        MAP_TimerPrescaleMatchSet(c->base, c->half, 0);
+        MAP_TimerIntClear(c->base, (c->half == TIMER_A) ? TIMER_CAPA_MATCH : TIMER_CAPB_MATCH);
+        MAP_TimerIntEnable(c->base, (c->half == TIMER_A) ? TIMER_CAPA_MATCH : TIMER_CAPB_MATCH);
+    }
+
+    MAP_IntEnable(capture_halves[ch].int_num);
+    capture_sync(c);
+
+    return ch;
+}
+
+void capture_close(int ch) {
+    capture_channel_t *c;
+
+    if(ch < 0 || ch >= CAPTURE_CHANNELS || !capture_channels[ch].open) {
+        return;
+    }
+    c = &capture_channels[ch];
+
+    MAP_IntDisable(capture_halves[ch].int_num);
+    MAP_TimerDisable(c->base, c->half);
+    MAP_TimerIntDisable(c->base, (c->half == TIMER_A) ? TIMER_CAPA_MATCH : TIMER_CAPB_MATCH);
+    if(c->config.mode == CAPTURE_EDGE_TIME) {
+        MAP_uDMAChannelDisable(c->dma.channel);
+    }
+
+    capture_users[ch / 2]--;
+    c->open = false;
+}
+
+int capture_get(int ch, capture_result_t *result) {
+    capture_channel_t *c;
+    uint32_t primask;
+
+    if(ch < 0 || ch >= CAPTURE_CHANNELS || !capture_channels[ch].open) {
+        return -1;
+    }
+    c = &capture_channels[ch];
+
+    primask = cpu_irq_save();
+    *result = c->result;
+    cpu_irq_restore(primask);
+
+    return 0;
+}
+
+static void capture_publish(capture_channel_t *c, uint32_t periods, uint64_t total, uint64_t high) {
+    capture_result_t *r = &c->result;
+
+    r->windows++;
+    r->periods = periods;
+    r->period_ticks = total;
+    r->high_ticks = high;
+    if(total) {
+        r->frequency_hz = (float)c->clock_hz * periods / total;
+        r->period_us = (float)total * 1e6f / ((float)c->clock_hz * periods);
+        r->pulse_us = (float)high * 1e6f / ((float)c->clock_hz * periods);
+        r->duty = (float)high / total;
+    }
+
+    if(c->config.callback) {
+        c->config.callback(c->config.ctx, r);
+    }
+}
+
+// Sum a window of timestamps. The interval before a falling edge was high
+static void capture_window(capture_channel_t *c, const uint32_t *edges, uint32_t len) {
+    uint64_t total = 0, high = 0;
+    uint32_t i = 0, last = c->last, interval;
+    bool rising = c->rising;
+    bool primed = c->primed;
+
+    // The first edge after a start has nothing before it, and leaves the
+    // window an interval short. Use it to seed the next one
+    if(!primed) {
+        last = edges[0];
+        rising = !rising;
+        i = 1;
+    }
+
+    for(; i < len; i++) {
+        interval = (edges[i] - last) & c->mask;
+        total += interval;
+        if(!rising) {
+            high += interval;
+        }
+        last = edges[i];
+        rising = !rising;
+    }
+
+    c->last = last;
+    c->rising = rising;
+    c->primed = true;
+
+    if(primed) {
+        capture_publish(c, c->config.window, total, high);
+    }
+}
+
+// A uDMA half finished. Re-arm it first, the other half is already filling
+// and this one has until that completes
+static bool capture_complete(void *ctx, uint32_t half) {
+    capture_channel_t *c = ctx;
+    uint32_t len = 2 * c->config.window;
+    const uint32_t *edges = c->config.buffer + half * len;
+
+    capture_arm(c, half);
+
+    if(c->config.log) {
+        c->config.log(c->config.ctx, edges, len);
+    }
+    capture_window(c, edges, len);
+    return true;
+}
+
+static void capture_service(capture_channel_t *c) {
+    uint32_t match = (c->half == TIMER_A) ? TIMER_CAPA_MATCH : TIMER_CAPB_MATCH;
+    uint64_t now;
+
+    if(c->config.mode == CAPTURE_EDGE_COUNT) {
+        now = timebase_cycles();
+        HWREG(c->base + TIMER_O_ICR) = match;
+        if(c->primed) {
+            capture_publish(c, c->config.window, now - c->last_cycles, 0);
+        }
+        c->last_cycles = now;
+        c->primed = true;
+        return;
+    }
+
+    // Both halves ran out before this interrupt got to re-arm either, so
+    // edges went by uncaptured and the polarity can no longer be trusted.
+    // Start again from the pin level
+    if(!dma_pingpong_service(&c->dma, capture_complete, c)) {
+        MAP_TimerDisable(c->base, c->half);
+        capture_arm(c, 0);
+        capture_arm(c, 1);
+        dma_pingpong_start(&c->dma);
+        c->result.overruns++;
+        capture_sync(c);
+    }
+}
+
+// Timer vectors, bound into nvic_table by name
+void timer1a_handler(void) {
+    capture_service(&capture_channels[0]);
+}
+
+void timer1b_handler(void) {
+    capture_service(&capture_channels[1]);
+}
+
+void timer2a_handler(void) {
+    capture_service(&capture_channels[2]);
+}
+
+void timer2b_handler(void) {
+    capture_service(&capture_channels[3]);
+}
+
+void wtimer1a_handler(void) {
+    capture_service(&capture_channels[4]);
+}
+
+void wtimer1b_handler(void) {
+    capture_service(&capture_channels[5]);
+}
+
+void wtimer2a_handler(void) {
+    capture_service(&capture_channels[6]);
+}
+
+void wtimer2b_handler(void) {
+    capture_service(&capture_channels[7]);
+}
+
+void wtimer4a_handler(void) {
+    capture_service(&capture_channels[8]);
+}
+
+void wtimer4b_handler(void) {
+    capture_service(&capture_channels[9]);
+}
@@ -0,0 +1,115 @@
+#ifndef __CAPTURE_H__
+#define __CAPTURE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frequency, period, pulse width and duty cycle of signals on timer
+ * capture pins, without an interrupt per edge.
+ *
+ * Pins are named by port (0-5 for A-F) and pin number, the same as
+ * GPIOPin(port, pin). Each pin feeds one half of a general purpose timer,
+ * and each timer half can measure one pin at a time. Timers 1 and 2 and
+ * wide timers 1, 2 and 4 are used; the others already belong to twheel,
+ * adc, kernel, evloop and pcprof, or share their uDMA channel with SSI or
+ * ADC1:
+ *
+ *     timer 1       PB4 or PF2, PB5 or PF3        24-bit timestamps
+ *     timer 2       PB0 or PF4, PB1
+ *     wide timer 1  PC6, PC7                      32-bit timestamps
+ *     wide timer 2  PD0, PD1
+ *     wide timer 4  PD4, PD5
+ *
+ * CAPTURE_EDGE_TIME runs the timer half as a free running counter that
+ * latches its value on both edges. uDMA moves each timestamp out of the
+ * timer into the caller's buffer, ping-ponging between two halves of
+ * 2 * window edges each, so the CPU sees one interrupt per window. That
+ * interrupt sums the intervals into the period and the time spent high.
+ * Edge polarity is not latched, only the time, so it is taken from the pin
+ * level when capture starts and alternates from there. The longest period
+ * is the timestamp range: about 0.2 s at 80 MHz on the 24-bit timers,
+ * 53 s on the 32-bit ones. Edges closer together than uDMA can service,
+ * around 1 MHz with other channels busy, are lost, and a gap that empties
+ * both halves restarts capture and is counted as an overrun.
+ *
+ * CAPTURE_EDGE_COUNT counts rising edges in the timer itself and
+ * interrupts every window edges; the period comes from the cycle count
+ * between those interrupts. It reaches a quarter of the core clock but
+ * gives no pulse width, and interrupt latency jitter is spread over the
+ * whole window.
+ *
+ * Results are averages over the latest window. With a log callback, edge
+ * time mode also passes on each window of raw timestamps straight from the
+ * uDMA buffer.
+ *
+ *     static uint32_t edges[CAPTURE_BUFFER_LEN(64)];
+ *
+ *     capture_config_t config = {CAPTURE_EDGE_TIME, 64, edges, NULL, NULL, NULL};
+ *     int ch = capture_open(1, 4, &config);
+ *     ...
+ *     capture_result_t result;
+ *     capture_get(ch, &result);
+ */
+
+// Periods per window in edge time mode, one uDMA transfer of 2 * window
+#define CAPTURE_WINDOW_MAX      512
+
+// Edges per window in edge count mode
+#define CAPTURE_COUNT_MAX       65535
+
+// Timestamps in the buffer for a window, both uDMA halves
+#define CAPTURE_BUFFER_LEN(window)  (4 * (window))
+
+typedef enum {
+    CAPTURE_EDGE_TIME = 0,      // timestamp both edges: period, pulse width, duty
+    CAPTURE_EDGE_COUNT,         // count rising edges: period only, to higher rates
+} capture_mode_t;
+
+typedef struct {
+    uint32_t windows;           // windows completed, unchanged while there is no signal
+    uint32_t periods;           // periods in the latest window
+    uint64_t period_ticks;      // their total length, in core clock cycles
+    uint64_t high_ticks;        // time high within them, 0 in edge count mode
+    float frequency_hz;
+    float period_us;            // average period
+    float pulse_us;             // average high time
+    float duty;                 // high fraction, 0 to 1
+    uint32_t overruns;          // restarts after uDMA fell behind the edges
+} capture_result_t;
+
+// Called from the timer interrupt with each new result
+typedef void (*capture_cb_t)(void *ctx, const capture_result_t *result);
+
+// Called from the timer interrupt with the 2 * window timestamps of a
+// window. They stay valid until the next window completes
+typedef void (*capture_log_cb_t)(void *ctx, const uint32_t *edges, uint32_t len);
+
+typedef struct {
+    capture_mode_t mode;
+    uint32_t window;            // periods per result, or edges in edge count mode
+    uint32_t *buffer;           // CAPTURE_BUFFER_LEN(window), edge time mode only
+    capture_cb_t callback;      // optional
+    capture_log_cb_t log;       // optional, edge time mode only
+    void *ctx;
+} capture_config_t;
+
+// Start measuring on a pin. Returns a channel number for the calls below,
+// or -1 if the pin has no usable timer, its timer half is already open, or
+// the configuration is invalid
+int capture_open(uint32_t port, uint32_t pin, const capture_config_t *config);
+
+// Stop measuring and free the timer half
+void capture_close(int ch);
+
+// Copy out the latest result. Returns -1 if the channel is not open
+int capture_get(int ch, capture_result_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
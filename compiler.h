@@ -2,12 +2,38 @@
 #ifndef __COMPILER_H__
 #define __COMPILER_H__
 
-// Function attributes
-#define __always_inline __attribute__((always_inline))
+// Function attributes. glibc's cdefs.h has its own __always_inline, which
+// matters for the host build
+#undef __always_inline
+#define __always_inline __inline__ __attribute__((__always_inline__))
 #define __naked         __attribute__((naked))
 #define __signal        __attribute__((signal))
+#define __alias(x)      __attribute__((alias(x)))
 
 // Function/data attributes
+#define __weak          __attribute__((weak))
 #define __section(x)    __attribute__((section(x)))
+#define __aligned(x)    __attribute__((aligned(x)))
+
+// Not zeroed or initialized at reset, for large buffers that are filled
+// before use. Keeps its contents across a warm reset
+#define __noinit        __section(".noinit")
+
+// Run from SRAM with no flash wait states. reset_handler copies .ramfunc
+// in with .data. long_call because flash and SRAM are too far apart for BL
+#define __ramfunc       __attribute__((section(".ramfunc"), noinline, long_call))
+
+// Called by reset_handler before main(), lowest priority first. 0-100 are
+// reserved by the toolchain
+#define __init(prio)    __attribute__((constructor(prio)))
+
+// Bit scan helpers. Cortex-M3/M4 have CLZ; CTZ becomes RBIT + CLZ
+// Result is undefined for x == 0
+#define __clz(x)        __builtin_clz(x)
+#define __ctz(x)        __builtin_ctz(x)
+
+// Stop the compiler from moving memory accesses across this point. Enough
+// to order ring buffer updates against interrupts on a single core
+#define __compiler_barrier() __asm__ __volatile__("" ::: "memory")
 
 #endif
@@ -0,0 +1,45 @@
+#ifndef __CPU_H__
+#define __CPU_H__
+
+#include <stdint.h>
+
+#ifdef HOST
+#include "host.h"
+
+// Native build: PRIMASK and the exception state live in the host model
+static inline uint32_t cpu_in_isr(void) {
+    return host_in_isr();
+}
+
+static inline uint32_t cpu_irq_save(void) {
+    return host_irq_save();
+}
+
+static inline void cpu_irq_restore(uint32_t primask) {
+    host_irq_restore(primask);
+}
+
+#else
+
+// Nonzero when running in an exception handler
+static inline uint32_t cpu_in_isr(void) {
+    uint32_t ipsr;
+    __asm__ __volatile__("mrs %0, ipsr" : "=r" (ipsr));
+    return ipsr & 0x1FF;
+}
+
+// Mask interrupts, returning the previous PRIMASK for cpu_irq_restore
+static inline uint32_t cpu_irq_save(void) {
+    uint32_t primask;
+    __asm__ __volatile__("mrs %0, primask\n\t"
+                         "cpsid i" : "=r" (primask) :: "memory");
+    return primask;
+}
+
+static inline void cpu_irq_restore(uint32_t primask) {
+    __asm__ __volatile__("msr primask, %0" :: "r" (primask) : "memory");
+}
+
+#endif
+
+#endif
@@ -0,0 +1,91 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_types.h>
+#include <inc/hw_ints.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "dma.h"
+
+// Channel control table shared by all drivers. Primary and alternate
+// structures for 32 channels; the controller requires 1024 byte alignment
+static uint8_t dma_control_table[1024] __aligned(1024);
+
+static bool dma_ready;
+static volatile uint32_t dma_errors;
+
+void dma_init(void) {
+    if(dma_ready) {
+        return;
+    }
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UDMA);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_uDMAEnable();
+    MAP_uDMAControlBaseSet(dma_control_table);
+    MAP_IntEnable(INT_UDMAERR);
+
+    dma_ready = true;
+}
+
+uint32_t dma_error_count(void) {
+    return dma_errors;
+}
+
+static bool dma_pingpong_stopped(const dma_pingpong_t *p) {
+    return MAP_uDMAChannelModeGet(p->channel | (p->next ? UDMA_ALT_SELECT : UDMA_PRI_SELECT)) ==
+           UDMA_MODE_STOP;
+}
+
+void dma_pingpong_start(dma_pingpong_t *p) {
+    p->next = 0;
+    dma_pingpong_restart(p);
+}
+
+bool dma_pingpong_service(dma_pingpong_t *p, dma_pingpong_fn_t complete, void *ctx) {
+    for(;;) {
+        // Halves complete in turn, both if the interrupt was held off. A
+        // re-armed half is no longer stopped, which ends the loop
+        while(dma_pingpong_stopped(p)) {
+            if(!complete(ctx, p->next)) {
+                return MAP_uDMAChannelIsEnabled(p->channel);
+            }
+            p->next ^= 1;
+        }
+
+        if(MAP_uDMAChannelIsEnabled(p->channel)) {
+            return true;
+        }
+
+        // The channel stopped on next. If that half finished while this
+        // was looking, go round again
+        if(!dma_pingpong_stopped(p)) {
+            return false;
+        }
+    }
+}
+
+void dma_pingpong_restart(dma_pingpong_t *p) {
+    if(p->next) {
+        MAP_uDMAChannelAttributeEnable(p->channel, UDMA_ATTR_ALTSELECT);
+    } else {
+        MAP_uDMAChannelAttributeDisable(p->channel, UDMA_ATTR_ALTSELECT);
+    }
+    MAP_uDMAChannelEnable(p->channel);
+}
+
+// Bound into nvic_table by name
+void udma_error_handler(void) {
+    if(MAP_uDMAErrorStatusGet()) {
+        MAP_uDMAErrorStatusClear();
+        dma_errors++;
+    }
+}
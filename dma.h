@@ -0,0 +1,44 @@
+#ifndef __DMA_H__
+#define __DMA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Enable the uDMA controller and install the shared channel control table.
+// Every driver that uses uDMA calls this, only the first call does anything
+void dma_init(void);
+
+// Number of uDMA bus errors seen since boot
+uint32_t dma_error_count(void);
+
+// A channel run ping-pong: the primary and alternate structures take turns
+// and next is the one that completes next (0 primary, 1 alternate)
+typedef struct {
+    uint32_t channel;
+    uint32_t next;
+} dma_pingpong_t;
+
+// Called for a half that has finished, to re-arm it or leave it stopped.
+// Returns false if the half had nothing armed, it is then not passed over
+typedef bool (*dma_pingpong_fn_t)(void *ctx, uint32_t half);
+
+// Run both halves from the primary, once they are armed
+void dma_pingpong_start(dma_pingpong_t *p);
+
+// Hand each half that has finished to complete() in turn, from next on.
+// Returns true while the channel is still running. Otherwise it stopped
+// on next, which the caller restarts or leaves stopped
+bool dma_pingpong_service(dma_pingpong_t *p, dma_pingpong_fn_t complete, void *ctx);
+
+// Carry on from next after the channel stopped
+void dma_pingpong_restart(dma_pingpong_t *p);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,591 @@
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include "compiler.h"
+#include "dsp.h"
+
+#define DSP_PI              3.14159265358979323846
+
+//
+// DSP extension helpers. Packed pairs hold the lower-addressed Q15 sample
+// in the low half, the same as a 32-bit load of two adjacent samples. The
+// C fallbacks compute exactly what the instructions do
+//
+
+// Two adjacent samples as one word. Cortex-M4 LDR/STR handle halfword
+// aligned addresses
+static __always_inline uint32_t dsp_read2(const q15_t *p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static __always_inline void dsp_write2(q15_t *p, uint32_t v) {
+    memcpy(p, &v, sizeof(v));
+}
+
+static __always_inline int32_t dsp_lo(uint32_t v) {
+    return (int16_t)v;
+}
+
+static __always_inline int32_t dsp_hi(uint32_t v) {
+    return (int16_t)(v >> 16);
+}
+
+static __always_inline uint32_t dsp_pack(int32_t lo, int32_t hi) {
+    return (uint16_t)lo | ((uint32_t)hi << 16);
+}
+
+static __always_inline q15_t dsp_ssat16(int32_t x) {
+#ifdef __ARM_FEATURE_DSP
+    __asm__("ssat %0, #16, %1" : "=r" (x) : "r" (x));
+    return x;
+#else
+    return (x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : x;
+#endif
+}
+
+static __always_inline q31_t dsp_ssat32(int64_t x) {
+    return (x > INT32_MAX) ? INT32_MAX : (x < INT32_MIN) ? INT32_MIN : (q31_t)x;
+}
+
+// Saturating add/subtract of both halves
+static __always_inline uint32_t dsp_qadd16(uint32_t a, uint32_t b) {
+#ifdef __ARM_FEATURE_DSP
+    uint32_t r;
+    __asm__("qadd16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+#else
+    return dsp_pack(dsp_ssat16(dsp_lo(a) + dsp_lo(b)), dsp_ssat16(dsp_hi(a) + dsp_hi(b)));
+#endif
+}
+
+static __always_inline uint32_t dsp_qsub16(uint32_t a, uint32_t b) {
+#ifdef __ARM_FEATURE_DSP
+    uint32_t r;
+    __asm__("qsub16 %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+#else
+    return dsp_pack(dsp_ssat16(dsp_lo(a) - dsp_lo(b)), dsp_ssat16(dsp_hi(a) - dsp_hi(b)));
+#endif
+}
+
+static __always_inline q31_t dsp_qadd(q31_t a, q31_t b) {
+#ifdef __ARM_FEATURE_DSP
+    q31_t r;
+    __asm__("qadd %0, %1, %2" : "=r" (r) : "r" (a), "r" (b));
+    return r;
+#else
+    return dsp_ssat32((int64_t)a + b);
+#endif
+}
+
+// acc + a.lo * b.lo + a.hi * b.hi
+static __always_inline int64_t dsp_smlald(uint32_t a, uint32_t b, int64_t acc) {
+#ifdef __ARM_FEATURE_DSP
+    __asm__("smlald %Q0, %R0, %1, %2" : "+r" (acc) : "r" (a), "r" (b));
+    return acc;
+#else
+    return acc + dsp_lo(a) * dsp_lo(b) + (int64_t)(dsp_hi(a) * dsp_hi(b));
+#endif
+}
+
+// acc + a.lo * b.hi + a.hi * b.lo
+static __always_inline int64_t dsp_smlaldx(uint32_t a, uint32_t b, int64_t acc) {
+#ifdef __ARM_FEATURE_DSP
+    __asm__("smlaldx %Q0, %R0, %1, %2" : "+r" (acc) : "r" (a), "r" (b));
+    return acc;
+#else
+    return acc + dsp_lo(a) * dsp_hi(b) + (int64_t)(dsp_hi(a) * dsp_lo(b));
+#endif
+}
+
+//
+// Vector operations
+//
+
+void dsp_add_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i + 1 < n; i += 2) {
+        dsp_write2(&out[i], dsp_qadd16(dsp_read2(&a[i]), dsp_read2(&b[i])));
+    }
+    if(i < n) {
+        out[i] = dsp_ssat16(a[i] + b[i]);
+    }
+}
+
+void dsp_sub_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i + 1 < n; i += 2) {
+        dsp_write2(&out[i], dsp_qsub16(dsp_read2(&a[i]), dsp_read2(&b[i])));
+    }
+    if(i < n) {
+        out[i] = dsp_ssat16(a[i] - b[i]);
+    }
+}
+
+void dsp_mul_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i, x, y;
+
+    // SMULBB/SMULTT on one load of each pair
+    for(i = 0; i + 1 < n; i += 2) {
+        x = dsp_read2(&a[i]);
+        y = dsp_read2(&b[i]);
+        dsp_write2(&out[i], dsp_pack(dsp_ssat16((dsp_lo(x) * dsp_lo(y)) >> 15),
+                                     dsp_ssat16((dsp_hi(x) * dsp_hi(y)) >> 15)));
+    }
+    if(i < n) {
+        out[i] = dsp_ssat16((a[i] * b[i]) >> 15);
+    }
+}
+
+void dsp_scale_q15(const q15_t *in, q15_t scale, uint32_t shift, q15_t *out, uint32_t n) {
+    uint32_t i, x;
+    uint32_t r = 15 - shift;
+
+    for(i = 0; i + 1 < n; i += 2) {
+        x = dsp_read2(&in[i]);
+        dsp_write2(&out[i], dsp_pack(dsp_ssat16((dsp_lo(x) * scale) >> r),
+                                     dsp_ssat16((dsp_hi(x) * scale) >> r)));
+    }
+    if(i < n) {
+        out[i] = dsp_ssat16((in[i] * scale) >> r);
+    }
+}
+
+int64_t dsp_dot_q15(const q15_t *a, const q15_t *b, uint32_t n) {
+    int64_t acc = 0;
+    uint32_t i;
+
+    for(i = 0; i + 1 < n; i += 2) {
+        acc = dsp_smlald(dsp_read2(&a[i]), dsp_read2(&b[i]), acc);
+    }
+    if(i < n) {
+        acc += a[i] * b[i];
+    }
+
+    return acc;
+}
+
+void dsp_add_q31(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = dsp_qadd(a[i], b[i]);
+    }
+}
+
+void dsp_mul_q31(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n) {
+    uint32_t i;
+
+    // SMULL; only -1 * -1 can overflow
+    for(i = 0; i < n; i++) {
+        out[i] = dsp_ssat32(((int64_t)a[i] * b[i]) >> 31);
+    }
+}
+
+void dsp_q15_to_f32(const q15_t *in, float *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = in[i] * (1.0f / 32768.0f);
+    }
+}
+
+void dsp_f32_to_q15(const float *in, q15_t *out, uint32_t n) {
+    uint32_t i;
+    float v;
+
+    for(i = 0; i < n; i++) {
+        v = in[i] * 32768.0f;
+        if(v >= 32767.0f) {
+            out[i] = INT16_MAX;
+        } else if(v <= -32768.0f) {
+            out[i] = INT16_MIN;
+        } else if(v != v) {
+            out[i] = 0;
+        } else {
+            out[i] = (int32_t)v;
+        }
+    }
+}
+
+//
+// FIR
+//
+
+void dsp_fir_q15_init(dsp_fir_q15_t *fir, const q15_t *coeffs, uint32_t taps, q15_t *state) {
+    fir->coeffs = coeffs;
+    fir->state  = state;
+    fir->taps   = taps;
+    memset(state, 0, (taps - 1) * sizeof(q15_t));
+}
+
+void dsp_fir_q15(dsp_fir_q15_t *fir, const q15_t *in, q15_t *out, uint32_t n) {
+    const q15_t *h = fir->coeffs;
+    q15_t *s = fir->state;
+    uint32_t last = fir->taps - 1;
+    uint32_t i, k, c;
+    int64_t acc0, acc1;
+
+    // History is s[0 .. last), new samples go after it. Sample x[i - k]
+    // is then s[i + last - k]
+    memcpy(&s[last], in, n * sizeof(q15_t));
+
+    // Two outputs per pass share every coefficient load. Coefficients run
+    // forward and samples backward, so each pair is an exchanged MAC
+    for(i = 0; i + 1 < n; i += 2) {
+        acc0 = acc1 = 0;
+        for(k = 0; k < last; k += 2) {
+            c = dsp_read2(&h[k]);
+            acc0 = dsp_smlaldx(c, dsp_read2(&s[i + last - k - 1]), acc0);
+            acc1 = dsp_smlaldx(c, dsp_read2(&s[i + last - k]), acc1);
+        }
+        if(k == last) {
+            acc0 += h[last] * s[i];
+            acc1 += h[last] * s[i + 1];
+        }
+        out[i]     = dsp_ssat16((int32_t)(acc0 >> 15));
+        out[i + 1] = dsp_ssat16((int32_t)(acc1 >> 15));
+    }
+
+    if(i < n) {
+        acc0 = 0;
+        for(k = 0; k < last; k += 2) {
+            acc0 = dsp_smlaldx(dsp_read2(&h[k]), dsp_read2(&s[i + last - k - 1]), acc0);
+        }
+        if(k == last) {
+            acc0 += h[last] * s[i];
+        }
+        out[i] = dsp_ssat16((int32_t)(acc0 >> 15));
+    }
+
+    memmove(s, &s[n], last * sizeof(q15_t));
+}
+
+void dsp_fir_f32_init(dsp_fir_f32_t *fir, const float *coeffs, uint32_t taps, float *state) {
+    fir->coeffs = coeffs;
+    fir->state  = state;
+    fir->taps   = taps;
+    memset(state, 0, (taps - 1) * sizeof(float));
+}
+
+void dsp_fir_f32(dsp_fir_f32_t *fir, const float *in, float *out, uint32_t n) {
+    const float *h = fir->coeffs;
+    float *s = fir->state;
+    uint32_t taps = fir->taps;
+    uint32_t last = taps - 1;
+    uint32_t i, k;
+    float acc0, acc1, acc2, acc3, c;
+    const float *x;
+
+    memcpy(&s[last], in, n * sizeof(float));
+
+    // Four outputs per pass share every coefficient load; each one still
+    // sums in tap order
+    for(i = 0; i + 3 < n; i += 4) {
+        acc0 = acc1 = acc2 = acc3 = 0.0f;
+        x = &s[i + last];
+        for(k = 0; k < taps; k++) {
+            c = h[k];
+            acc0 += c * x[0];
+            acc1 += c * x[1];
+            acc2 += c * x[2];
+            acc3 += c * x[3];
+            x--;
+        }
+        out[i]     = acc0;
+        out[i + 1] = acc1;
+        out[i + 2] = acc2;
+        out[i + 3] = acc3;
+    }
+
+    for(; i < n; i++) {
+        acc0 = 0.0f;
+        for(k = 0; k < taps; k++) {
+            acc0 += h[k] * s[i + last - k];
+        }
+        out[i] = acc0;
+    }
+
+    memmove(s, &s[n], last * sizeof(float));
+}
+
+//
+// Biquads
+//
+
+void dsp_biquad_f32_init(dsp_biquad_f32_t *bq, const float *coeffs, uint32_t stages, float *state) {
+    bq->coeffs = coeffs;
+    bq->state  = state;
+    bq->stages = stages;
+    memset(state, 0, 2 * stages * sizeof(float));
+}
+
+void dsp_biquad_f32(dsp_biquad_f32_t *bq, const float *in, float *out, uint32_t n) {
+    const float *src = in;
+    uint32_t st, i;
+
+    // Whole block through one stage at a time, so its coefficients and
+    // state stay in FPU registers
+    for(st = 0; st < bq->stages; st++) {
+        const float *c = &bq->coeffs[5 * st];
+        float b0 = c[0], b1 = c[1], b2 = c[2], a1 = c[3], a2 = c[4];
+        float s1 = bq->state[2 * st];
+        float s2 = bq->state[2 * st + 1];
+        float x, y;
+
+        for(i = 0; i < n; i++) {
+            x  = src[i];
+            y  = b0 * x + s1;
+            s1 = b1 * x - a1 * y + s2;
+            s2 = b2 * x - a2 * y;
+            out[i] = y;
+        }
+
+        bq->state[2 * st]     = s1;
+        bq->state[2 * st + 1] = s2;
+        src = out;
+    }
+}
+
+void dsp_biquad_q15_init(dsp_biquad_q15_t *bq, const q15_t *coeffs, uint32_t stages,
+                         uint32_t shift, q15_t *state) {
+    bq->coeffs = coeffs;
+    bq->state  = state;
+    bq->stages = stages;
+    bq->shift  = shift;
+    memset(state, 0, 4 * stages * sizeof(q15_t));
+}
+
+void dsp_biquad_q15(dsp_biquad_q15_t *bq, const q15_t *in, q15_t *out, uint32_t n) {
+    const q15_t *src = in;
+    uint32_t r = 15 - bq->shift;
+    uint32_t st, i;
+
+    for(st = 0; st < bq->stages; st++) {
+        const q15_t *c = &bq->coeffs[5 * st];
+        q15_t *state = &bq->state[4 * st];
+        int32_t b0 = c[0];
+        uint32_t b12 = dsp_read2(&c[1]);
+        uint32_t a12 = dsp_read2(&c[3]);
+
+        // Delay lines kept packed, newest in the low half
+        uint32_t x12 = dsp_read2(&state[0]);
+        uint32_t y12 = dsp_read2(&state[2]);
+        int32_t x0, y0;
+        int64_t acc;
+
+        for(i = 0; i < n; i++) {
+            x0  = src[i];
+            acc = (int64_t)(b0 * x0);
+            acc = dsp_smlald(b12, x12, acc);
+            acc -= dsp_smlald(a12, y12, 0);
+            y0  = dsp_ssat16((int32_t)(acc >> r));
+
+            x12 = (x12 << 16) | (uint16_t)x0;
+            y12 = (y12 << 16) | (uint16_t)y0;
+            out[i] = y0;
+        }
+
+        dsp_write2(&state[0], x12);
+        dsp_write2(&state[2], y12);
+        src = out;
+    }
+}
+
+//
+// Moving average
+//
+
+void dsp_mavg_q15_init(dsp_mavg_q15_t *avg, q15_t *buf, uint32_t len_log2) {
+    avg->buf      = buf;
+    avg->len_log2 = len_log2;
+    avg->pos      = 0;
+    avg->sum      = 0;
+    memset(buf, 0, (1 << len_log2) * sizeof(q15_t));
+}
+
+void dsp_mavg_q15(dsp_mavg_q15_t *avg, const q15_t *in, q15_t *out, uint32_t n) {
+    q15_t *buf = avg->buf;
+    uint32_t mask = (1 << avg->len_log2) - 1;
+    uint32_t shift = avg->len_log2;
+    uint32_t pos = avg->pos;
+    int32_t sum = avg->sum;
+    uint32_t i;
+    q15_t x;
+
+    // Running sum: add the newest sample, drop the oldest
+    for(i = 0; i < n; i++) {
+        x = in[i];
+        sum += x - buf[pos];
+        buf[pos] = x;
+        pos = (pos + 1) & mask;
+        out[i] = sum >> shift;
+    }
+
+    avg->pos = pos;
+    avg->sum = sum;
+}
+
+//
+// FFT
+//
+
+int dsp_rfft_f32_init(dsp_rfft_f32_t *fft, uint32_t n, float *twiddle) {
+    uint32_t m = n / 2;
+    uint32_t k;
+    double a;
+
+    if(n < 8 || (n & (n - 1))) {
+        return -1;
+    }
+
+    // W_m^k for the complex FFT, then W_n^k for the split, as (cos, sin)
+    for(k = 0; k < m; k++) {
+        a = 2 * DSP_PI * k / m;
+        twiddle[2 * k]     = cos(a);
+        twiddle[2 * k + 1] = sin(a);
+    }
+    for(k = 0; k <= m / 2; k++) {
+        a = 2 * DSP_PI * k / n;
+        twiddle[n + 2 * k]     = cos(a);
+        twiddle[n + 2 * k + 1] = sin(a);
+    }
+
+    fft->n = n;
+    fft->twiddle = twiddle;
+    return 0;
+}
+
+// In place complex FFT of m interleaved points. Each radix-4 stage stores
+// its middle two outputs swapped, which makes it exactly two radix-2
+// stages, so one radix-2 stage finishes odd powers of two and the result
+// is in plain bit-reversed order
+static void dsp_cfft_f32(float *x, uint32_t m, const float *tw) {
+    uint32_t span, q, stride, j, base, i, bit;
+    float w1r, w1i, w2r, w2i, w3r, w3i;
+    float t0r, t0i, t1r, t1i, t2r, t2i, t3r, t3i, ur, ui;
+    float *a, *b, *c, *d;
+
+    for(span = m, stride = 1; span >= 4; span >>= 2, stride <<= 2) {
+        q = span >> 2;
+
+        for(j = 0; j < q; j++) {
+            w1r = tw[2 * j * stride];
+            w1i = tw[2 * j * stride + 1];
+            w2r = tw[4 * j * stride];
+            w2i = tw[4 * j * stride + 1];
+            w3r = tw[6 * j * stride];
+            w3i = tw[6 * j * stride + 1];
+
+            for(base = j; base < m; base += span) {
+                a = &x[2 * base];
+                b = a + 2 * q;
+                c = b + 2 * q;
+                d = c + 2 * q;
+
+                t0r = a[0] + c[0];  t0i = a[1] + c[1];
+                t1r = a[0] - c[0];  t1i = a[1] - c[1];
+                t2r = b[0] + d[0];  t2i = b[1] + d[1];
+                t3r = b[0] - d[0];  t3i = b[1] - d[1];
+
+                // y0 = t0 + t2
+                a[0] = t0r + t2r;
+                a[1] = t0i + t2i;
+
+                // y2 = (t0 - t2) W^2j
+                ur = t0r - t2r;
+                ui = t0i - t2i;
+                b[0] = ur * w2r + ui * w2i;
+                b[1] = ui * w2r - ur * w2i;
+
+                // y1 = (t1 - i t3) W^j
+                ur = t1r + t3i;
+                ui = t1i - t3r;
+                c[0] = ur * w1r + ui * w1i;
+                c[1] = ui * w1r - ur * w1i;
+
+                // y3 = (t1 + i t3) W^3j
+                ur = t1r - t3i;
+                ui = t1i + t3r;
+                d[0] = ur * w3r + ui * w3i;
+                d[1] = ui * w3r - ur * w3i;
+            }
+        }
+    }
+
+    if(span == 2) {
+        for(base = 0; base < m; base += 2) {
+            a = &x[2 * base];
+            ur = a[0] - a[2];
+            ui = a[1] - a[3];
+            a[0] += a[2];
+            a[1] += a[3];
+            a[2] = ur;
+            a[3] = ui;
+        }
+    }
+
+    // Bit reversal, j counting in reverse
+    for(i = 0, j = 0; i < m; i++) {
+        if(i < j) {
+            ur = x[2 * i];
+            ui = x[2 * i + 1];
+            x[2 * i]     = x[2 * j];
+            x[2 * i + 1] = x[2 * j + 1];
+            x[2 * j]     = ur;
+            x[2 * j + 1] = ui;
+        }
+        for(bit = m >> 1; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j |= bit;
+    }
+}
+
+void dsp_rfft_f32(const dsp_rfft_f32_t *fft, float *buf) {
+    uint32_t n = fft->n;
+    uint32_t m = n / 2;
+    const float *w = fft->twiddle + n;
+    float zr, zi, cr, ci, er, ei, orr, oi, tr, ti, wr, ws;
+    float *zk, *zc;
+    uint32_t k;
+
+    // Even samples as the real part, odd as the imaginary
+    dsp_cfft_f32(buf, m, fft->twiddle);
+
+    zr = buf[0];
+    zi = buf[1];
+    buf[0] = zr + zi;
+    buf[1] = zr - zi;
+
+    // Split Z into the transforms of the even (E) and odd (O) samples and
+    // recombine, X[k] = E[k] + W_n^k O[k], filling k and m - k together
+    for(k = 1; k <= m / 2; k++) {
+        zk = &buf[2 * k];
+        zc = &buf[2 * (m - k)];
+        zr = zk[0];
+        zi = zk[1];
+        cr = zc[0];
+        ci = zc[1];
+
+        er  = 0.5f * (zr + cr);
+        ei  = 0.5f * (zi - ci);
+        orr = 0.5f * (zi + ci);
+        oi  = 0.5f * (cr - zr);
+
+        wr = w[2 * k];
+        ws = w[2 * k + 1];
+        tr = orr * wr + oi * ws;
+        ti = oi * wr - orr * ws;
+
+        zk[0] = er + tr;
+        zk[1] = ei + ti;
+        zc[0] = er - tr;
+        zc[1] = ti - ei;
+    }
+}
@@ -0,0 +1,184 @@
+#ifndef __DSP_H__
+#define __DSP_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Filtering and spectrum kernels.
+ *
+ * Fixed point kernels work on Q15 (int16_t, [-1, 1)) and Q31 samples and
+ * saturate instead of wrapping. On the Cortex-M4 they run on the DSP
+ * extension: two 16-bit multiply-accumulates per SMLALD/SMLALDX into a
+ * 64-bit accumulator, QADD16/QSUB16 for packed arithmetic and SSAT for the
+ * final narrowing. Built for anything without the DSP extension (the host,
+ * Cortex-M3) the same kernels fall back to plain C that computes exactly
+ * the same thing.
+ *
+ * Float kernels use the FPU and keep the summation order of the reference
+ * versions, so the two agree bit for bit. Both files must be built with
+ * -ffp-contract=off, as every build here does; GCC's default with
+ * -mfpu=fpv4-sp-d16 fuses multiply-adds into VFMA, which rounds once
+ * instead of twice.
+ *
+ * Every kernel has a *_ref twin in dsp_ref.c: a direct, unoptimized
+ * implementation over a whole signal that the host bench checks the fast
+ * paths against. The FFT is checked against a double precision DFT
+ * instead, within rounding.
+ *
+ * Filters are block based and keep their history in a caller supplied
+ * state buffer, so a signal can be fed in blocks of any size up to the
+ * one the state was sized for.
+ */
+
+typedef int16_t q15_t;
+typedef int32_t q31_t;
+
+//
+// Vector operations. in and out may be the same buffer
+//
+
+// out = sat(a + b), sat(a - b)
+void dsp_add_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+void dsp_sub_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+
+// out = sat((a * b) >> 15)
+void dsp_mul_q15(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+
+// out = sat((in * scale) >> (15 - shift)), gains up to 2^shift
+void dsp_scale_q15(const q15_t *in, q15_t scale, uint32_t shift, q15_t *out, uint32_t n);
+
+// Sum of a * b in Q30, exact
+int64_t dsp_dot_q15(const q15_t *a, const q15_t *b, uint32_t n);
+
+// out = sat(a + b), sat((a * b) >> 31)
+void dsp_add_q31(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n);
+void dsp_mul_q31(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n);
+
+// Conversions. Float to Q15 truncates toward zero and saturates
+void dsp_q15_to_f32(const q15_t *in, float *out, uint32_t n);
+void dsp_f32_to_q15(const float *in, q15_t *out, uint32_t n);
+
+//
+// FIR: y[n] = sum h[k] * x[n - k], k = 0 .. taps - 1
+//
+
+// State length for a filter fed at most block samples per call
+#define DSP_FIR_STATE_LEN(taps, block)  ((taps) + (block) - 1)
+
+typedef struct {
+    const q15_t *coeffs;
+    q15_t *state;
+    uint32_t taps;
+} dsp_fir_q15_t;
+
+typedef struct {
+    const float *coeffs;
+    float *state;
+    uint32_t taps;
+} dsp_fir_f32_t;
+
+// Clears the state. coeffs and state must outlive the filter
+void dsp_fir_q15_init(dsp_fir_q15_t *fir, const q15_t *coeffs, uint32_t taps, q15_t *state);
+void dsp_fir_f32_init(dsp_fir_f32_t *fir, const float *coeffs, uint32_t taps, float *state);
+
+// Output is sat(acc >> 15) with acc the exact Q30 sum
+void dsp_fir_q15(dsp_fir_q15_t *fir, const q15_t *in, q15_t *out, uint32_t n);
+void dsp_fir_f32(dsp_fir_f32_t *fir, const float *in, float *out, uint32_t n);
+
+//
+// Biquad cascade. Each stage is
+//
+//     H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+//
+// with coefficients stored {b0, b1, b2, a1, a2} per stage
+//
+
+typedef struct {
+    const float *coeffs;
+    float *state;               // 2 per stage, transposed direct form II
+    uint32_t stages;
+} dsp_biquad_f32_t;
+
+// Q15 stages run in direct form I with a 64-bit accumulator. Coefficients
+// are scaled down by 2^shift to fit Q15 and the sum is scaled back up
+typedef struct {
+    const q15_t *coeffs;
+    q15_t *state;               // 4 per stage: x[n-1], x[n-2], y[n-1], y[n-2]
+    uint32_t stages;
+    uint32_t shift;
+} dsp_biquad_q15_t;
+
+void dsp_biquad_f32_init(dsp_biquad_f32_t *bq, const float *coeffs, uint32_t stages, float *state);
+void dsp_biquad_q15_init(dsp_biquad_q15_t *bq, const q15_t *coeffs, uint32_t stages,
+                         uint32_t shift, q15_t *state);
+
+void dsp_biquad_f32(dsp_biquad_f32_t *bq, const float *in, float *out, uint32_t n);
+void dsp_biquad_q15(dsp_biquad_q15_t *bq, const q15_t *in, q15_t *out, uint32_t n);
+
+//
+// Moving average over the last 2^len_log2 samples, history starting at 0.
+// Output is the window sum shifted right, so it rounds toward -inf
+//
+
+typedef struct {
+    q15_t *buf;                 // 2^len_log2 samples
+    uint32_t len_log2;
+    uint32_t pos;
+    int32_t sum;
+} dsp_mavg_q15_t;
+
+void dsp_mavg_q15_init(dsp_mavg_q15_t *avg, q15_t *buf, uint32_t len_log2);
+void dsp_mavg_q15(dsp_mavg_q15_t *avg, const q15_t *in, q15_t *out, uint32_t n);
+
+//
+// Real FFT of n points, n a power of two from 8 up. Runs as a complex FFT
+// of n/2 points (radix-4 stages, plus one radix-2 stage when needed) and
+// a split pass. In place; the n outputs are packed as
+//
+//     X[0].re, X[n/2].re, X[1].re, X[1].im, ... X[n/2-1].re, X[n/2-1].im
+//
+// Forward transform, unscaled
+//
+
+#define DSP_RFFT_TWIDDLE_LEN(n) ((n) + (n) / 2 + 2)
+
+typedef struct {
+    uint32_t n;
+    const float *twiddle;
+} dsp_rfft_f32_t;
+
+// Fills twiddle (DSP_RFFT_TWIDDLE_LEN(n) floats). Returns 0 on success, -1
+// for an unsupported length
+int dsp_rfft_f32_init(dsp_rfft_f32_t *fft, uint32_t n, float *twiddle);
+void dsp_rfft_f32(const dsp_rfft_f32_t *fft, float *buf);
+
+//
+// Reference versions (dsp_ref.c). Whole signals with zero initial state
+//
+
+void dsp_add_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+void dsp_sub_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+void dsp_mul_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n);
+void dsp_scale_q15_ref(const q15_t *in, q15_t scale, uint32_t shift, q15_t *out, uint32_t n);
+int64_t dsp_dot_q15_ref(const q15_t *a, const q15_t *b, uint32_t n);
+void dsp_add_q31_ref(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n);
+void dsp_mul_q31_ref(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n);
+void dsp_fir_q15_ref(const q15_t *coeffs, uint32_t taps, const q15_t *in, q15_t *out, uint32_t n);
+void dsp_fir_f32_ref(const float *coeffs, uint32_t taps, const float *in, float *out, uint32_t n);
+void dsp_biquad_f32_ref(const float *coeffs, uint32_t stages, const float *in, float *out, uint32_t n);
+void dsp_biquad_q15_ref(const q15_t *coeffs, uint32_t stages, uint32_t shift,
+                        const q15_t *in, q15_t *out, uint32_t n);
+void dsp_mavg_q15_ref(uint32_t len_log2, const q15_t *in, q15_t *out, uint32_t n);
+
+// Same packed layout as dsp_rfft_f32, computed as a direct DFT in double
+void dsp_rfft_f32_ref(uint32_t n, const float *in, float *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
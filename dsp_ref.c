@@ -0,0 +1,197 @@
+#include <stdint.h>
+#include <math.h>
+
+#include "dsp.h"
+
+//
+// Straightforward versions of the dsp.c kernels, one output at a time, for
+// the benches to check the fast paths against. Not meant to be fast
+//
+
+#define DSP_PI              3.14159265358979323846
+
+static q15_t sat15(int64_t x) {
+    return (x > INT16_MAX) ? INT16_MAX : (x < INT16_MIN) ? INT16_MIN : (q15_t)x;
+}
+
+static q31_t sat31(int64_t x) {
+    return (x > INT32_MAX) ? INT32_MAX : (x < INT32_MIN) ? INT32_MIN : (q31_t)x;
+}
+
+void dsp_add_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat15(a[i] + b[i]);
+    }
+}
+
+void dsp_sub_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat15(a[i] - b[i]);
+    }
+}
+
+void dsp_mul_q15_ref(const q15_t *a, const q15_t *b, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat15(((int32_t)a[i] * b[i]) >> 15);
+    }
+}
+
+void dsp_scale_q15_ref(const q15_t *in, q15_t scale, uint32_t shift, q15_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat15(((int32_t)in[i] * scale) >> (15 - shift));
+    }
+}
+
+int64_t dsp_dot_q15_ref(const q15_t *a, const q15_t *b, uint32_t n) {
+    int64_t acc = 0;
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        acc += (int32_t)a[i] * b[i];
+    }
+
+    return acc;
+}
+
+void dsp_add_q31_ref(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat31((int64_t)a[i] + b[i]);
+    }
+}
+
+void dsp_mul_q31_ref(const q31_t *a, const q31_t *b, q31_t *out, uint32_t n) {
+    uint32_t i;
+
+    for(i = 0; i < n; i++) {
+        out[i] = sat31(((int64_t)a[i] * b[i]) >> 31);
+    }
+}
+
+void dsp_fir_q15_ref(const q15_t *coeffs, uint32_t taps, const q15_t *in, q15_t *out, uint32_t n) {
+    uint32_t i, k;
+    int64_t acc;
+
+    for(i = 0; i < n; i++) {
+        acc = 0;
+        for(k = 0; k < taps && k <= i; k++) {
+            acc += (int32_t)coeffs[k] * in[i - k];
+        }
+        out[i] = sat15(acc >> 15);
+    }
+}
+
+void dsp_fir_f32_ref(const float *coeffs, uint32_t taps, const float *in, float *out, uint32_t n) {
+    uint32_t i, k;
+    float acc;
+
+    // Samples before the start are zero but still summed, in tap order,
+    // so signed zeros come out the same as the fast path
+    for(i = 0; i < n; i++) {
+        acc = 0.0f;
+        for(k = 0; k < taps; k++) {
+            acc += coeffs[k] * (k <= i ? in[i - k] : 0.0f);
+        }
+        out[i] = acc;
+    }
+}
+
+void dsp_biquad_f32_ref(const float *coeffs, uint32_t stages, const float *in, float *out, uint32_t n) {
+    uint32_t i, st;
+    float x, y, s[2 * stages];
+    const float *c;
+
+    for(st = 0; st < 2 * stages; st++) {
+        s[st] = 0.0f;
+    }
+
+    for(i = 0; i < n; i++) {
+        x = in[i];
+        for(st = 0; st < stages; st++) {
+            c = &coeffs[5 * st];
+            y = c[0] * x + s[2 * st];
+            s[2 * st]     = c[1] * x - c[3] * y + s[2 * st + 1];
+            s[2 * st + 1] = c[2] * x - c[4] * y;
+            x = y;
+        }
+        out[i] = x;
+    }
+}
+
+void dsp_biquad_q15_ref(const q15_t *coeffs, uint32_t stages, uint32_t shift,
+                        const q15_t *in, q15_t *out, uint32_t n) {
+    uint32_t i, st;
+    int32_t x, y, d[4 * stages];
+    const q15_t *c;
+    int64_t acc;
+
+    for(st = 0; st < 4 * stages; st++) {
+        d[st] = 0;
+    }
+
+    for(i = 0; i < n; i++) {
+        x = in[i];
+        for(st = 0; st < stages; st++) {
+            int32_t *h = &d[4 * st];
+
+            c = &coeffs[5 * st];
+            acc = (int64_t)c[0] * x + (int64_t)c[1] * h[0] + (int64_t)c[2] * h[1]
+                - (int64_t)c[3] * h[2] - (int64_t)c[4] * h[3];
+            y = sat15(acc >> (15 - shift));
+
+            h[1] = h[0];
+            h[0] = x;
+            h[3] = h[2];
+            h[2] = y;
+            x = y;
+        }
+        out[i] = x;
+    }
+}
+
+void dsp_mavg_q15_ref(uint32_t len_log2, const q15_t *in, q15_t *out, uint32_t n) {
+    uint32_t len = 1 << len_log2;
+    uint32_t i, k;
+    int32_t sum;
+
+    for(i = 0; i < n; i++) {
+        sum = 0;
+        for(k = 0; k < len && k <= i; k++) {
+            sum += in[i - k];
+        }
+        out[i] = sum >> len_log2;
+    }
+}
+
+void dsp_rfft_f32_ref(uint32_t n, const float *in, float *out) {
+    uint32_t k, t;
+    double re, im, a;
+
+    for(k = 0; k <= n / 2; k++) {
+        re = im = 0.0;
+        for(t = 0; t < n; t++) {
+            // Reduce k * t first so the angle stays exact
+            a = 2 * DSP_PI * ((k * t) % n) / n;
+            re += in[t] * cos(a);
+            im -= in[t] * sin(a);
+        }
+
+        if(k == 0) {
+            out[0] = re;
+        } else if(k == n / 2) {
+            out[1] = re;
+        } else {
+            out[2 * k]     = re;
+            out[2 * k + 1] = im;
+        }
+    }
+}
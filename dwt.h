@@ -0,0 +1,76 @@
+#ifndef __DWT_H__
+#define __DWT_H__
+
+#include <stdint.h>
+#include <inc/hw_types.h>
+
+// Cortex-M4 data watchpoint and trace unit registers
+#define DWT_DEMCR           0xE000EDFC
+#define DWT_DEMCR_TRCENA    0x01000000
+#define DWT_CTRL            0xE0001000
+#define DWT_CTRL_CYCCNTENA  0x00000001
+#define DWT_CYCCNT          0xE0001004
+
+#ifdef HOST
+// Native build: nanoseconds stand in for cycles
+#define DWT_CYCLES_MASK     0xFFFFFFFF
+
+static inline void dwt_init(void) {
+}
+
+static inline void dwt_reset(void) {
+}
+
+static inline uint32_t dwt_cycles(void) {
+    return (uint32_t)host_ns();
+}
+
+#elif defined(QEMU)
+#include <inc/hw_nvic.h>
+
+// QEMU does not model the DWT. SysTick stands in, free running down from
+// its full 24-bit reload at the core clock, so the count is only 24 bits
+// wide: mask differences with DWT_CYCLES_MASK. Leaves SysTick unusable for
+// anything else
+#define DWT_CYCLES_MASK     0x00FFFFFF
+
+static inline void dwt_init(void) {
+    if(!(HWREG(NVIC_ST_CTRL) & NVIC_ST_CTRL_ENABLE)) {
+        HWREG(NVIC_ST_RELOAD)  = DWT_CYCLES_MASK;
+        HWREG(NVIC_ST_CURRENT) = 0;
+        HWREG(NVIC_ST_CTRL)    = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_ENABLE;
+    }
+}
+
+static inline void dwt_reset(void) {
+    HWREG(NVIC_ST_CURRENT) = 0;
+}
+
+static inline uint32_t dwt_cycles(void) {
+    return DWT_CYCLES_MASK - HWREG(NVIC_ST_CURRENT);
+}
+
+#else
+
+// Width of the count, for differences across a wrap
+#define DWT_CYCLES_MASK     0xFFFFFFFF
+
+// Start the free running cycle counter. Safe to call more than once
+static inline void dwt_init(void) {
+    HWREG(DWT_DEMCR) |= DWT_DEMCR_TRCENA;
+    HWREG(DWT_CTRL)  |= DWT_CTRL_CYCCNTENA;
+}
+
+// Restart the count from zero. Only a power-on reset clears it
+static inline void dwt_reset(void) {
+    HWREG(DWT_CYCCNT) = 0;
+}
+
+// Core clock cycles, wraps every 2^32 cycles (~53s at 80MHz)
+static inline uint32_t dwt_cycles(void) {
+    return HWREG(DWT_CYCCNT);
+}
+
+#endif
+
+#endif
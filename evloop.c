@@ -0,0 +1,240 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_timer.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "timebase.h"
+#include "evloop.h"
+
+// One shot wakeup timer, full 32-bit width
+#define EVLOOP_TIMER_BASE   TIMER5_BASE
+#define EVLOOP_TIMER_PERIPH SYSCTL_PERIPH_TIMER5
+#define EVLOOP_TIMER_INT    INT_TIMER5A
+
+// Longest single sleep. SysTick wakes the core every 0.2s at 80MHz anyway,
+// this just keeps the cycle count well inside 32 bits
+#define EVLOOP_MAX_SLEEP_NS 1000000000ULL
+
+// Ready queue, appended to from interrupts
+static evloop_event_t *evloop_head;
+static evloop_event_t *evloop_tail;
+
+// Active timers sorted by deadline. Only touched from the loop
+static evloop_timer_t *evloop_timers;
+
+static volatile bool evloop_running;
+
+void evloop_init(void) {
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(EVLOOP_TIMER_PERIPH);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_TimerConfigure(EVLOOP_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+    MAP_TimerIntEnable(EVLOOP_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntEnable(EVLOOP_TIMER_INT);
+
+    timebase_init();
+}
+
+void evloop_event_init(evloop_event_t *event, evloop_fn_t fn, void *ctx) {
+    event->fn      = fn;
+    event->ctx     = ctx;
+    event->next    = NULL;
+    event->pending = false;
+}
+
+void evloop_post(evloop_event_t *event) {
+    uint32_t primask = cpu_irq_save();
+
+    if(!event->pending) {
+        event->pending = true;
+        event->next = NULL;
+        if(evloop_tail) {
+            evloop_tail->next = event;
+        } else {
+            evloop_head = event;
+        }
+        evloop_tail = event;
+    }
+
+    cpu_irq_restore(primask);
+}
+
+void evloop_post_cb(void *event) {
+    evloop_post((evloop_event_t *)event);
+}
+
+static evloop_event_t *evloop_pop(void) {
+    evloop_event_t *event;
+    uint32_t primask = cpu_irq_save();
+
+    event = evloop_head;
+    if(event) {
+        evloop_head = event->next;
+        if(!evloop_head) {
+            evloop_tail = NULL;
+        }
+        // Cleared before the handler runs so it can be reposted from it
+        event->pending = false;
+    }
+
+    cpu_irq_restore(primask);
+    return event;
+}
+
+static void evloop_timer_unlink(evloop_timer_t *timer) {
+    evloop_timer_t **p;
+
+    for(p = &evloop_timers; *p; p = &(*p)->next) {
+        if(*p == timer) {
+            *p = timer->next;
+            break;
+        }
+    }
+    timer->active = false;
+}
+
+static void evloop_timer_insert(evloop_timer_t *timer) {
+    evloop_timer_t **p = &evloop_timers;
+
+    // Equal deadlines keep start order
+    while(*p && (*p)->deadline <= timer->deadline) {
+        p = &(*p)->next;
+    }
+    timer->next = *p;
+    *p = timer;
+    timer->active = true;
+}
+
+void evloop_timer_init(evloop_timer_t *timer, evloop_fn_t fn, void *ctx) {
+    evloop_event_init(&timer->event, fn, ctx);
+    timer->deadline = 0;
+    timer->period   = 0;
+    timer->active   = false;
+    timer->next     = NULL;
+}
+
+void evloop_timer_start(evloop_timer_t *timer, uint32_t delay_us, uint32_t period_us) {
+    if(timer->active) {
+        evloop_timer_unlink(timer);
+    }
+
+    timer->deadline = timebase_ns() + delay_us * 1000ULL;
+    timer->period   = period_us * 1000ULL;
+    evloop_timer_insert(timer);
+}
+
+void evloop_timer_stop(evloop_timer_t *timer) {
+    if(timer->active) {
+        evloop_timer_unlink(timer);
+    }
+}
+
+// Move due timers onto the ready queue, returning ns until the next one
+// or EVLOOP_MAX_SLEEP_NS if there is none
+static uint64_t evloop_timers_expire(void) {
+    uint64_t now = timebase_ns();
+    evloop_timer_t *timer;
+
+    while((timer = evloop_timers) && timer->deadline <= now) {
+        evloop_timers = timer->next;
+        timer->active = false;
+
+        if(timer->period) {
+            // Stay on the original grid; skip periods missed entirely
+            timer->deadline += timer->period;
+            if(timer->deadline <= now) {
+                timer->deadline = now + timer->period - (now - timer->deadline) % timer->period;
+            }
+            evloop_timer_insert(timer);
+        }
+
+        evloop_post(&timer->event);
+    }
+
+    if(!evloop_timers) {
+        return EVLOOP_MAX_SLEEP_NS;
+    }
+
+    timer = evloop_timers;
+    return timer->deadline - now < EVLOOP_MAX_SLEEP_NS ? timer->deadline - now : EVLOOP_MAX_SLEEP_NS;
+}
+
+uint32_t evloop_poll(void) {
+    evloop_event_t *event, *last;
+    uint32_t n = 0;
+
+    evloop_timers_expire();
+
+    // Only what is queued now; events posted by these handlers wait for
+    // the next pass so timers are still checked in between
+    last = evloop_tail;
+    while(last && (event = evloop_pop())) {
+        event->fn(event->ctx);
+        n++;
+        if(event == last) {
+            break;
+        }
+    }
+
+    return n;
+}
+
+// Sleep until an interrupt or until sleep_ns has passed
+static void evloop_sleep(uint64_t sleep_ns) {
+    uint32_t cycles = (uint32_t)(sleep_ns * timebase_hz() / 1000000000ULL);
+    uint32_t primask;
+
+    if(cycles == 0) {
+        return;
+    }
+
+    MAP_TimerDisable(EVLOOP_TIMER_BASE, TIMER_A);
+    MAP_TimerLoadSet(EVLOOP_TIMER_BASE, TIMER_A, cycles);
+    MAP_TimerEnable(EVLOOP_TIMER_BASE, TIMER_A);
+
+    // WFI still wakes on an interrupt that is masked by PRIMASK, so
+    // checking the queue with interrupts off closes the window between
+    // the check and the sleep. The interrupt runs once they are unmasked
+    primask = cpu_irq_save();
+    if(!evloop_head) {
+        __asm__ __volatile__("wfi");
+    }
+    cpu_irq_restore(primask);
+}
+
+void evloop_run(void) {
+    evloop_running = true;
+
+    while(evloop_running) {
+        uint64_t sleep_ns;
+
+        evloop_poll();
+
+        sleep_ns = evloop_timers_expire();
+        if(evloop_running && !evloop_head) {
+            evloop_sleep(sleep_ns);
+        }
+    }
+}
+
+void evloop_stop(void) {
+    evloop_running = false;
+}
+
+// Bound into nvic_table by name. Only here to wake the core
+void timer5a_handler(void) {
+    HWREG(EVLOOP_TIMER_BASE + TIMER_O_ICR) = TIMER_TIMA_TIMEOUT;
+}
@@ -0,0 +1,80 @@
+#ifndef __EVLOOP_H__
+#define __EVLOOP_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Run-to-completion event loop. Handlers are queued as events and run one
+ * at a time from evloop_run(). Timers are events with a deadline; when
+ * nothing is ready the loop arms timer 5A for the earliest deadline and
+ * sleeps in WFI, so there is no fixed tick.
+ *
+ * Events and timers are owned by the caller, usually as statics. Posting
+ * an event is safe from interrupts; timers may only be started and
+ * stopped from handlers running on the loop.
+ *
+ *     static evloop_timer_t blink;
+ *
+ *     evloop_init();
+ *     evloop_timer_init(&blink, toggle_led, NULL);
+ *     evloop_timer_start(&blink, 100000, 100000);
+ *     evloop_run();
+ */
+
+typedef void (*evloop_fn_t)(void *ctx);
+
+typedef struct evloop_event {
+    evloop_fn_t fn;
+    void *ctx;
+    struct evloop_event *next;
+    volatile bool pending;
+} evloop_event_t;
+
+typedef struct evloop_timer {
+    evloop_event_t event;
+    uint64_t deadline;          // timebase_ns() at which to fire
+    uint64_t period;            // ns, 0 for one shot
+    bool active;
+    struct evloop_timer *next;
+} evloop_timer_t;
+
+void evloop_init(void);
+
+void evloop_event_init(evloop_event_t *event, evloop_fn_t fn, void *ctx);
+
+// Queue an event. Posting one that is already queued does nothing
+void evloop_post(evloop_event_t *event);
+
+// evloop_post with the gpio_pin_int_cb_t signature, so an event can be
+// given straight to GPIOPin::attach_callback as the callback context
+void evloop_post_cb(void *event);
+
+void evloop_timer_init(evloop_timer_t *timer, evloop_fn_t fn, void *ctx);
+
+// Fire after delay_us, then every period_us if that is nonzero. Restarts
+// the timer if it is already running
+void evloop_timer_start(evloop_timer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+void evloop_timer_stop(evloop_timer_t *timer);
+
+// Run ready events and due timers, sleeping when there are none. Only
+// returns after evloop_stop()
+void evloop_run(void);
+
+// Make evloop_run() return once the events already queued have run
+void evloop_stop(void);
+
+// Handle everything that is ready now without sleeping. Returns the
+// number of handlers run
+uint32_t evloop_poll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,5 +1,5 @@
 // Placeholder
 
 // Put cleanup functions to run after main() exists here
-// Add __section(".fini") to tell linker to locate functions
-// In the finalizer section
+// Add __attribute__((destructor)) to have reset_handler call them
+// through the .fini_array table
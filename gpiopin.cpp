@@ -3,6 +3,7 @@
 #include <inc/hw_types.h>
 #include <inc/hw_memmap.h>
 #include <inc/hw_ints.h>
+#include <inc/hw_gpio.h>
 #include <driverlib/rom.h>
 #include <driverlib/rom_map.h>
 #include <driverlib/gpio.h>
@@ -12,6 +13,8 @@
 
 #include "gpiopin.h"
 #include "compiler.h"
+#include "dwt.h"
+#include "profile.h"
 
 // Need to associate GPIO port base with SysCtl registers:
 typedef struct {
@@ -21,7 +24,7 @@ typedef struct {
 } gpio_port_info_t;
 
 // List of all the GPIO ports in order
-static const gpio_port_info_t ports[] = {
+static constexpr gpio_port_info_t ports[] = {
     {GPIO_PORTA_BASE, SYSCTL_PERIPH_GPIOA, INT_GPIOA},
     {GPIO_PORTB_BASE, SYSCTL_PERIPH_GPIOB, INT_GPIOB},
     {GPIO_PORTC_BASE, SYSCTL_PERIPH_GPIOC, INT_GPIOC},
@@ -33,19 +36,99 @@ static const gpio_port_info_t ports[] = {
 #define NUM_GPIO_PORTS sizeof(ports) / sizeof(*ports)
 #define NUM_PINS_PER_PORT 8
 
+// StaticGPIOPin resolves port bases at compile time; keep both tables in sync
+static_assert(NUM_GPIO_PORTS == GPIO_NUM_PORTS, "gpio_port_base() out of date");
+static_assert(ports[0].base == gpio_port_base(0), "gpio_port_base() out of date");
+static_assert(ports[1].base == gpio_port_base(1), "gpio_port_base() out of date");
+static_assert(ports[2].base == gpio_port_base(2), "gpio_port_base() out of date");
+static_assert(ports[3].base == gpio_port_base(3), "gpio_port_base() out of date");
+static_assert(ports[4].base == gpio_port_base(4), "gpio_port_base() out of date");
+static_assert(ports[5].base == gpio_port_base(5), "gpio_port_base() out of date");
+
+int gpio_port_lookup(uint32_t port, uint32_t *base, uint32_t *periph) {
+    if(port >= NUM_GPIO_PORTS) {
+        return -1;
+    }
+
+    *base = ports[port].base;
+    *periph = ports[port].sysctl_reg;
+    return 0;
+}
+
+// Pad registers a transaction can stage, in write order
+enum {
+    PAD_DR2R = 0,
+    PAD_DR4R,
+    PAD_DR8R,
+    PAD_SLR,
+    PAD_ODR,
+    PAD_PUR,
+    PAD_PDR,
+    PAD_DEN,
+    PAD_AMSEL,
+    PAD_AFSEL,
+    PAD_DIR,
+    PAD_IS,
+    PAD_IBE,
+    PAD_IEV,
+    PAD_TOTAL
+};
+
+static_assert(PAD_TOTAL == GPIO_NUM_PAD_REGS, "GPIO_NUM_PAD_REGS out of date");
+
+static const uint32_t pad_offsets[PAD_TOTAL] = {
+    GPIO_O_DR2R, GPIO_O_DR4R, GPIO_O_DR8R, GPIO_O_SLR,
+    GPIO_O_ODR,  GPIO_O_PUR,  GPIO_O_PDR,  GPIO_O_DEN,
+    GPIO_O_AMSEL, GPIO_O_AFSEL, GPIO_O_DIR,
+    GPIO_O_IS,   GPIO_O_IBE,  GPIO_O_IEV,
+};
+
+// driverlib encodings, decoded bit by bit the same way GPIOPadConfigSet does
+static const uint8_t drive_bits[GPIO_PIN_DRIVE_TOTAL] = {
+    GPIO_STRENGTH_2MA, GPIO_STRENGTH_4MA, GPIO_STRENGTH_8MA, GPIO_STRENGTH_8MA_SC,
+};
+
+static const uint8_t mode_bits[GPIO_PIN_MODE_TOTAL] = {
+    GPIO_PIN_TYPE_STD, GPIO_PIN_TYPE_STD_WPU, GPIO_PIN_TYPE_STD_WPD,
+    GPIO_PIN_TYPE_OD,  GPIO_PIN_TYPE_OD_WPU,  GPIO_PIN_TYPE_OD_WPD,
+    GPIO_PIN_TYPE_ANALOG,
+};
+
+static const uint8_t int_type_bits[GPIO_PIN_INT_TOTAL] = {
+    0, GPIO_LOW_LEVEL, GPIO_HIGH_LEVEL, GPIO_RISING_EDGE, GPIO_FALLING_EDGE, GPIO_BOTH_EDGES,
+};
+
+// Ports whose clock commit() has turned on
+static uint32_t gpio_port_enabled;
+
 // Pin interrupt callbacks
-static gpio_pin_int_cb_t gpio_pin_callbacks[NUM_GPIO_PORTS][NUM_PINS_PER_PORT];
+typedef struct {
+    gpio_pin_int_cb_t fn;
+    void *ctx;
+} gpio_pin_callback_t;
+
+static gpio_pin_callback_t gpio_pin_callbacks[NUM_GPIO_PORTS][NUM_PINS_PER_PORT];
+
+// Pins that record into the capture queue instead of running a callback
+static uint8_t gpio_capture_mask[NUM_GPIO_PORTS];
+
+// Capture queue. head is only written by the GPIO handlers, tail only by
+// gpio_capture_drain()
+static_assert((GPIO_CAPTURE_QUEUE_LEN & (GPIO_CAPTURE_QUEUE_LEN - 1)) == 0,
+              "GPIO_CAPTURE_QUEUE_LEN must be a power of two");
+static gpio_edge_event_t gpio_capture_queue[GPIO_CAPTURE_QUEUE_LEN];
+static volatile uint32_t gpio_capture_head;
+static volatile uint32_t gpio_capture_tail;
+static volatile uint32_t gpio_capture_drops;
+
+#if GPIO_INT_LATENCY
+static gpio_int_latency_t gpio_latency = {0, 0, UINT32_MAX, 0};
+#endif
 
 
 // Private function prototypes
-static void attach_exception_handlers(void);
-static void gpio_port_a_exception_handler(void);
-static void gpio_port_b_exception_handler(void);
-static void gpio_port_c_exception_handler(void);
-static void gpio_port_d_exception_handler(void);
-static void gpio_port_e_exception_handler(void);
-static void gpio_port_f_exception_handler(void);
-static void gpio_master_exception_handler(uint32_t port_num);
+static __always_inline void gpio_master_exception_handler(uint32_t port_num);
+static void gpio_legacy_callback(void *ctx);
 
 
 GPIOPin::GPIOPin(uint32_t _port, uint32_t _pin) {
@@ -64,15 +147,249 @@ GPIOPin::GPIOPin(uint32_t _port, uint32_t _pin) {
     config.dir   = GPIO_PIN_DIR_IN;
     config.mode  = GPIO_PIN_MODE_STD;
     config.drive = GPIO_PIN_DRIVE_2MA;
+    config.int_type = GPIO_PIN_INT_NONE;
 
-    // Enable peripheral
-    MAP_SysCtlPeripheralEnable(ports[_port].sysctl_reg);
+    // Port default is input
+    gpio_pin_init(_port, pin_mask, GPIO_PIN_DIR_IN);
+}
 
-    // Delay at least 5 cycles to avoid bus fault
-    SysCtlDelay(2);
+GPIOBus::GPIOBus(uint32_t _port, uint32_t _pin_mask) {
+    uint32_t pins[NUM_PINS_PER_PORT];
+    uint32_t i, v, n = 0;
 
-    // Port default is input
-    MAP_GPIOPinTypeGPIOInput(port_base, pin_mask);
+    // Check parameters
+    ASSERT(_port < NUM_GPIO_PORTS);
+    ASSERT(_pin_mask != 0);
+    ASSERT(_pin_mask < (1 << NUM_PINS_PER_PORT));
+
+    port_num  = _port;
+    pin_mask  = _pin_mask;
+    data_addr = gpio_data_addr(ports[_port].base, _pin_mask);
+
+    // Logical bit i is driven by the i-th lowest pin in the mask
+    for(i = 0; i < NUM_PINS_PER_PORT; i++) {
+        if(_pin_mask & (1 << i)) {
+            pins[n++] = i;
+        }
+    }
+    width = n;
+    shift = pins[0];
+
+    // A contiguous run of pins is just a shift
+    contiguous = ((_pin_mask >> shift) & ((_pin_mask >> shift) + 1)) == 0;
+
+    // Build nibble tables for everything else
+    for(v = 0; v < 16; v++) {
+        scatter_lo[v] = scatter_hi[v] = 0;
+        gather_lo[v] = gather_hi[v] = 0;
+
+        for(i = 0; i < 4; i++) {
+            if(v & (1 << i)) {
+                if(i < n) {
+                    scatter_lo[v] |= 1 << pins[i];
+                }
+                if(i + 4 < n) {
+                    scatter_hi[v] |= 1 << pins[i + 4];
+                }
+            }
+        }
+
+        for(i = 0; i < n; i++) {
+            if(pins[i] < 4 && (v & (1 << pins[i]))) {
+                gather_lo[v] |= 1 << i;
+            }
+            if(pins[i] >= 4 && (v & (1 << (pins[i] - 4)))) {
+                gather_hi[v] |= 1 << i;
+            }
+        }
+    }
+
+    // Bus default is input
+    gpio_pin_init(_port, _pin_mask, GPIO_PIN_DIR_IN);
+}
+
+void GPIOBus::operator=(uint32_t x)
+{
+    write(x);
+}
+
+void GPIOBus::set_direction(gpio_pin_dir_t dir) {
+    gpio_pin_init(port_num, pin_mask, dir);
+}
+
+uint32_t GPIOBus::get_width(void) {
+    return width;
+}
+
+void gpio_pin_init(uint32_t port, uint32_t pin_mask, gpio_pin_dir_t dir) {
+    GPIOTransaction txn;
+
+    // Same as GPIOPinTypeGPIOInput/Output: standard 2mA digital pad
+    txn.set_direction(port, pin_mask, dir);
+    txn.set_mode(port, pin_mask, GPIO_PIN_MODE_STD);
+    txn.set_drive_strength(port, pin_mask, GPIO_PIN_DRIVE_2MA);
+    txn.commit();
+}
+
+GPIOTransaction::GPIOTransaction(void) {
+    uint32_t i, j;
+
+    for(i = 0; i < NUM_GPIO_PORTS; i++) {
+        for(j = 0; j < PAD_TOTAL; j++) {
+            set_bits[i][j] = 0;
+            clr_bits[i][j] = 0;
+        }
+        int_disable[i] = 0;
+    }
+    port_mask = 0;
+}
+
+void GPIOTransaction::stage(uint32_t port, uint32_t reg, uint32_t pin_mask, uint32_t on) {
+    if(on) {
+        set_bits[port][reg] |= pin_mask;
+        clr_bits[port][reg] &= ~pin_mask;
+    } else {
+        clr_bits[port][reg] |= pin_mask;
+        set_bits[port][reg] &= ~pin_mask;
+    }
+    port_mask |= 1 << port;
+}
+
+void GPIOTransaction::configure(uint32_t port, uint32_t pin_mask, const gpio_pin_cfg_t *cfg) {
+    set_direction(port, pin_mask, cfg->dir);
+    set_mode(port, pin_mask, cfg->mode);
+    set_drive_strength(port, pin_mask, cfg->drive);
+    set_int_type(port, pin_mask, cfg->int_type);
+}
+
+void GPIOTransaction::set_direction(uint32_t port, uint32_t pin_mask, gpio_pin_dir_t dir) {
+    // Check parameters
+    ASSERT(port < NUM_GPIO_PORTS);
+    ASSERT(dir < GPIO_PIN_DIR_TOTAL);
+
+    // Plain GPIO, so the alternate function is always off
+    stage(port, PAD_DIR, pin_mask, dir == GPIO_PIN_DIR_OUT);
+    stage(port, PAD_AFSEL, pin_mask, 0);
+}
+
+void GPIOTransaction::set_mode(uint32_t port, uint32_t pin_mask, gpio_pin_mode_t mode) {
+    // Check parameters
+    ASSERT(port < NUM_GPIO_PORTS);
+    ASSERT(mode < GPIO_PIN_MODE_TOTAL);
+
+    uint32_t m = mode_bits[mode];
+
+    stage(port, PAD_ODR,   pin_mask, m & 1);
+    stage(port, PAD_PUR,   pin_mask, m & 2);
+    stage(port, PAD_PDR,   pin_mask, m & 4);
+    stage(port, PAD_DEN,   pin_mask, m & 8);
+    stage(port, PAD_AMSEL, pin_mask, m == GPIO_PIN_TYPE_ANALOG);
+}
+
+void GPIOTransaction::set_drive_strength(uint32_t port, uint32_t pin_mask, gpio_pin_drive_t drive) {
+    // Check parameters
+    ASSERT(port < NUM_GPIO_PORTS);
+    ASSERT(drive < GPIO_PIN_DRIVE_TOTAL);
+
+    uint32_t d = drive_bits[drive];
+
+    stage(port, PAD_DR2R, pin_mask, d & 1);
+    stage(port, PAD_DR4R, pin_mask, d & 2);
+    stage(port, PAD_DR8R, pin_mask, d & 4);
+    stage(port, PAD_SLR,  pin_mask, d & 8);
+}
+
+void GPIOTransaction::set_int_type(uint32_t port, uint32_t pin_mask, gpio_pin_int_type_t int_type) {
+    // Check parameters
+    ASSERT(port < NUM_GPIO_PORTS);
+    ASSERT(int_type < GPIO_PIN_INT_TOTAL);
+
+    // NONE masks the pin and leaves its trigger alone
+    if(int_type == GPIO_PIN_INT_NONE) {
+        int_disable[port] |= pin_mask;
+        port_mask |= 1 << port;
+        return;
+    }
+
+    uint32_t t = int_type_bits[int_type];
+
+    stage(port, PAD_IBE, pin_mask, t & 1);
+    stage(port, PAD_IS,  pin_mask, t & 2);
+    stage(port, PAD_IEV, pin_mask, t & 4);
+    int_disable[port] &= ~pin_mask;
+}
+
+uint32_t GPIOTransaction::commit(void) {
+    uint32_t port, reg, base, value, im, trig;
+    uint32_t writes = 0;
+    uint8_t live[PAD_TOTAL];
+    uint8_t staged;
+
+    for(port = 0; port < NUM_GPIO_PORTS; port++) {
+        if(!(port_mask & (1 << port))) {
+            continue;
+        }
+
+        base = ports[port].base;
+
+        // First use of the port: enable it
+        if(!(gpio_port_enabled & (1 << port))) {
+            MAP_SysCtlPeripheralEnable(ports[port].sysctl_reg);
+
+            // Delay at least 5 cycles to avoid bus fault
+            SysCtlDelay(2);
+
+            gpio_port_enabled |= 1 << port;
+        }
+
+        // Start from the registers as they are now, since driverlib calls
+        // elsewhere (GPIOPinTypeUART and friends) change them behind our
+        // back. Registers with nothing staged are not read at all
+        for(reg = 0; reg < PAD_TOTAL; reg++) {
+            staged = set_bits[port][reg] | clr_bits[port][reg];
+            live[reg] = staged ? HWREG(base + pad_offsets[reg]) : 0;
+        }
+
+        // Pins whose trigger changes are masked while it does, so the
+        // intermediate register states cannot raise a spurious interrupt
+        trig = 0;
+        for(reg = PAD_IS; reg <= PAD_IEV; reg++) {
+            value = (live[reg] & ~clr_bits[port][reg]) | set_bits[port][reg];
+            trig |= value ^ live[reg];
+        }
+
+        im = HWREG(base + GPIO_O_IM);
+        if(im & (trig | int_disable[port])) {
+            HWREG(base + GPIO_O_IM) = im & ~(trig | int_disable[port]);
+            writes++;
+        }
+
+        // Only touch registers that actually change, and in them only the
+        // staged bits
+        for(reg = 0; reg < PAD_TOTAL; reg++) {
+            value = (live[reg] & ~clr_bits[port][reg]) | set_bits[port][reg];
+            if(value != live[reg]) {
+                HWREG(base + pad_offsets[reg]) = value;
+                writes++;
+            }
+
+            set_bits[port][reg] = 0;
+            clr_bits[port][reg] = 0;
+        }
+
+        // Drop edges latched under the old trigger, then unmask
+        if(im & trig & ~int_disable[port]) {
+            HWREG(base + GPIO_O_ICR) = trig;
+            HWREG(base + GPIO_O_IM)  = im & ~int_disable[port];
+            writes += 2;
+        }
+
+        int_disable[port] = 0;
+    }
+
+    port_mask = 0;
+
+    return writes;
 }
 
 void GPIOPin::operator=(uint32_t x)
@@ -81,65 +398,23 @@ void GPIOPin::operator=(uint32_t x)
 }
 
 void GPIOPin::configure(gpio_pin_cfg_t *cfg) {
-    uint32_t d = 0;
-    uint32_t m = 0;
+    GPIOTransaction txn;
 
     // Check parameters
     ASSERT(cfg->dir < GPIO_PIN_DIR_TOTAL);
     ASSERT(cfg->mode < GPIO_PIN_MODE_TOTAL);
     ASSERT(cfg->drive < GPIO_PIN_DRIVE_TOTAL);
 
-    // Save settings
+    // Save settings. The interrupt type follows attach/detach_callback
     config.dir   = cfg->dir;
     config.mode  = cfg->mode;
     config.drive = cfg->drive;
 
-    switch(cfg->drive) {
-        case GPIO_PIN_DRIVE_2MA:
-            d = GPIO_STRENGTH_2MA;
-            break;
-        case GPIO_PIN_DRIVE_4MA:
-            d = GPIO_STRENGTH_4MA;
-            break;
-        case GPIO_PIN_DRIVE_8MA:
-            d = GPIO_STRENGTH_8MA;
-            break;
-        case GPIO_PIN_DRIVE_8MA_SC:
-            d = GPIO_STRENGTH_8MA_SC;
-            break;
-        default:
-            break;
-    }
-
-    switch(cfg->mode) {
-        case GPIO_PIN_MODE_STD:
-            m = GPIO_PIN_TYPE_STD;
-            break;
-        case GPIO_PIN_MODE_STD_WPU:
-            m = GPIO_PIN_TYPE_STD_WPU;
-            break;
-        case GPIO_PIN_MODE_STD_WPD:
-            m = GPIO_PIN_TYPE_STD_WPD;
-            break;
-        case GPIO_PIN_MODE_OD:
-            m = GPIO_PIN_TYPE_OD;
-            break;
-        case GPIO_PIN_MODE_OD_WPU:
-            m = GPIO_PIN_TYPE_OD_WPU;
-            break;
-        case GPIO_PIN_MODE_OD_WPD:
-            m = GPIO_PIN_TYPE_OD_WPD;
-            break;
-        case GPIO_PIN_MODE_ANALOG:
-            m = GPIO_PIN_TYPE_ANALOG;
-            break;
-        default:
-            break;
-    }
-
     // Apply settings
-    set_direction(config.dir);
-    MAP_GPIOPadConfigSet(port_base, pin_mask, d, m);
+    txn.set_direction(port_num, pin_mask, config.dir);
+    txn.set_mode(port_num, pin_mask, config.mode);
+    txn.set_drive_strength(port_num, pin_mask, config.drive);
+    txn.commit();
 }
 
 void GPIOPin::set_direction(gpio_pin_dir_t dir) {
@@ -177,6 +452,8 @@ void GPIOPin::set_drive_strength(gpio_pin_drive_t drive) {
 }
 
 void GPIOPin::write(uint32_t x) {
+    PROFILE_SCOPE(gpio_pin_write);
+
     MAP_GPIOPinWrite(port_base, pin_mask, (x != 0) ? pin_mask : 0);
 }
 
@@ -188,105 +465,228 @@ uint32_t GPIOPin::read(void) {
     return (MAP_GPIOPinRead(port_base, pin_mask) != 0);
 }
 
-void GPIOPin::attach_callback(gpio_pin_int_type_t event, void(*callback)(void)) {
+void GPIOPin::attach_callback(gpio_pin_int_type_t event, gpio_pin_int_cb_t callback, void *ctx) {
+    // Check parameters
+    ASSERT(event < GPIO_PIN_INT_TOTAL);
+
+    if(event == GPIO_PIN_INT_NONE) {
+        return;
+    }
+
+    gpio_capture_mask[port_num] &= ~pin_mask;
+    gpio_pin_callbacks[port_num][pin_num].fn  = callback;
+    gpio_pin_callbacks[port_num][pin_num].ctx = ctx;
+
+    enable_interrupt(event);
+}
+
+void GPIOPin::attach_capture(gpio_pin_int_type_t event) {
     // Check parameters
     ASSERT(event < GPIO_PIN_INT_TOTAL);
 
-    uint32_t int_type = 0;
-
-    switch(event) {
-        case GPIO_PIN_INT_LOW:
-            int_type = GPIO_FALLING_EDGE;
-            break;
-        case GPIO_PIN_INT_HIGH:
-            int_type = GPIO_RISING_EDGE;
-            break;
-        case GPIO_PIN_INT_RISING:
-            int_type = GPIO_BOTH_EDGES;
-            break;
-        case GPIO_PIN_INT_FALLING:
-            int_type = GPIO_LOW_LEVEL;
-            break;
-        case GPIO_PIN_INT_BOTH:
-            int_type = GPIO_HIGH_LEVEL;
-            break;
-        default:
-            // type NONE or invalid
-            return;
+    if(event == GPIO_PIN_INT_NONE) {
+        return;
     }
 
-    gpio_pin_callbacks[port_num][pin_num] = callback;
+    gpio_pin_callbacks[port_num][pin_num].fn  = 0;
+    gpio_pin_callbacks[port_num][pin_num].ctx = 0;
+    gpio_capture_mask[port_num] |= pin_mask;
+
+    // Timestamps come from the cycle counter
+    dwt_init();
+
+    enable_interrupt(event);
+}
+
+void GPIOPin::enable_interrupt(gpio_pin_int_type_t event) {
+    GPIOTransaction txn;
+
+#if GPIO_INT_LATENCY
+    dwt_init();
+#endif
 
     // Apply settings
+    config.int_type = event;
+    txn.set_int_type(port_num, pin_mask, event);
+    txn.commit();
     MAP_GPIOPinIntClear(port_base, pin_mask);
     MAP_GPIOPinIntEnable(port_base, pin_mask);
-    MAP_GPIOIntTypeSet(port_base, pin_mask, int_type);
     MAP_IntEnable(ports[port_num].int_num);
     IntMasterEnable();
 }
 
-void GPIOPin::detach_callback(void) {
-    uint32_t i;
+void GPIOPin::attach_callback(gpio_pin_int_type_t event, void(*callback)(void)) {
+    // Plain callbacks ride along as the context of an adapter
+    attach_callback(event, gpio_legacy_callback, (void *)callback);
+}
 
+void GPIOPin::detach_callback(void) {
     // Erase callback
-    for(i=0; i < NUM_GPIO_PORTS; i++) {
-        if(ports[i].base == port_base) {
-            gpio_pin_callbacks[i][pin_num] = 0;
-        }
-    }
+    gpio_pin_callbacks[port_num][pin_num].fn  = 0;
+    gpio_pin_callbacks[port_num][pin_num].ctx = 0;
+    gpio_capture_mask[port_num] &= ~pin_mask;
 
     // Apply settings
+    config.int_type = GPIO_PIN_INT_NONE;
     MAP_GPIOPinIntDisable(port_base, pin_mask);
-    MAP_GPIOIntTypeSet(port_base, pin_mask, GPIO_PIN_INT_NONE);
 }
 
-#pragma GCC diagnostic ignored "-Wunused-function"
-__section(".init")
-static void attach_exception_handlers(void) {
-    IntRegister(INT_GPIOA, gpio_port_a_exception_handler);
-    IntRegister(INT_GPIOB, gpio_port_b_exception_handler);
-    IntRegister(INT_GPIOC, gpio_port_c_exception_handler);
-    IntRegister(INT_GPIOD, gpio_port_d_exception_handler);
-    IntRegister(INT_GPIOE, gpio_port_e_exception_handler);
-    IntRegister(INT_GPIOF, gpio_port_f_exception_handler);
-}
+// Port handlers are bound into nvic_table by name (see startup.c), and the
+// master handler is inlined into each so the port number folds away
+#if GPIO_INT_RAMFUNC
+#define GPIO_PORT_HANDLER __ramfunc
+#else
+#define GPIO_PORT_HANDLER
+#endif
 
-static void gpio_port_a_exception_handler(void) {
+extern "C" {
+
+GPIO_PORT_HANDLER void gpio_port_a_handler(void) {
     gpio_master_exception_handler(0);
 }
 
-static void gpio_port_b_exception_handler(void) {
+GPIO_PORT_HANDLER void gpio_port_b_handler(void) {
     gpio_master_exception_handler(1);
 }
 
-static void gpio_port_c_exception_handler(void) {
+GPIO_PORT_HANDLER void gpio_port_c_handler(void) {
     gpio_master_exception_handler(2);
 }
 
-static void gpio_port_d_exception_handler(void) {
+GPIO_PORT_HANDLER void gpio_port_d_handler(void) {
     gpio_master_exception_handler(3);
 }
 
-static void gpio_port_e_exception_handler(void) {
+GPIO_PORT_HANDLER void gpio_port_e_handler(void) {
     gpio_master_exception_handler(4);
 }
 
-static void gpio_port_f_exception_handler(void) {
+GPIO_PORT_HANDLER void gpio_port_f_handler(void) {
     gpio_master_exception_handler(5);
 }
 
-static void gpio_master_exception_handler(uint32_t port_num) {
-    uint32_t i;
-    uint32_t isr = GPIOPinIntStatus(ports[port_num].base, true);
+}
+
+#if GPIO_INT_REGISTER
+// Runtime registration. Note IntRegister moves the vector table into RAM
+__init(110)
+static void attach_exception_handlers(void) {
+    IntRegister(INT_GPIOA, gpio_port_a_handler);
+    IntRegister(INT_GPIOB, gpio_port_b_handler);
+    IntRegister(INT_GPIOC, gpio_port_c_handler);
+    IntRegister(INT_GPIOD, gpio_port_d_handler);
+    IntRegister(INT_GPIOE, gpio_port_e_handler);
+    IntRegister(INT_GPIOF, gpio_port_f_handler);
+}
+#endif
+
+static __always_inline void gpio_master_exception_handler(uint32_t port_num) {
+    PROFILE_SCOPE(gpio_int_dispatch);
+
+#if GPIO_INT_LATENCY
+    uint32_t entry = dwt_cycles();
+    uint32_t first = 1;
+#endif
+    uint32_t base = ports[port_num].base;
+    gpio_pin_callback_t *cb = gpio_pin_callbacks[port_num];
+    uint32_t pin;
+
+    // Masked status, cleared up front so edges during callbacks re-pend
+    uint32_t isr = HWREG(base + GPIO_O_MIS);
+    HWREG(base + GPIO_O_ICR) = isr;
+
+    // Capture pins are only timestamped, their consumer runs later
+    uint32_t capture = isr & gpio_capture_mask[port_num];
+    if(capture) {
+        uint32_t head = gpio_capture_head;
+
+        if(head - gpio_capture_tail >= GPIO_CAPTURE_QUEUE_LEN) {
+            gpio_capture_drops++;
+        } else {
+            gpio_edge_event_t *ev = &gpio_capture_queue[head & (GPIO_CAPTURE_QUEUE_LEN - 1)];
+            ev->timestamp = dwt_cycles();
+            ev->port      = port_num;
+            ev->pins      = capture;
+            ev->level     = HWREG(gpio_data_addr(base, capture));
+
+            // Publish the event only once it is fully written
+            __compiler_barrier();
+            gpio_capture_head = head + 1;
+        }
 
-    MAP_GPIOPinIntClear(ports[port_num].base, isr);
+        isr &= ~capture;
+    }
 
-    // Execute callbacks
-    for(i=0; i<NUM_GPIO_PORTS; i++) {
-        if(isr & (1 << i)) {
-            if(gpio_pin_callbacks[port_num][i]) {
-                gpio_pin_callbacks[port_num][i]();
+    // Visit only the pins that fired, lowest first
+    while(isr) {
+        pin = __ctz(isr);
+        isr &= isr - 1;
+
+        if(cb[pin].fn) {
+#if GPIO_INT_LATENCY
+            if(first) {
+                uint32_t cycles = dwt_cycles() - entry;
+                gpio_latency.count++;
+                gpio_latency.last = cycles;
+                if(cycles < gpio_latency.min) {
+                    gpio_latency.min = cycles;
+                }
+                if(cycles > gpio_latency.max) {
+                    gpio_latency.max = cycles;
+                }
+                first = 0;
             }
+#endif
+            cb[pin].fn(cb[pin].ctx);
         }
     }
 }
+
+uint32_t gpio_capture_drain(gpio_edge_event_t *events, uint32_t max) {
+    uint32_t tail = gpio_capture_tail;
+    uint32_t n = gpio_capture_head - tail;
+    uint32_t i;
+
+    if(n > max) {
+        n = max;
+    }
+
+    for(i = 0; i < n; i++) {
+        events[i] = gpio_capture_queue[(tail + i) & (GPIO_CAPTURE_QUEUE_LEN - 1)];
+    }
+
+    // Hand the slots back only after they have been copied out
+    __compiler_barrier();
+    gpio_capture_tail = tail + n;
+
+    return n;
+}
+
+uint32_t gpio_capture_pending(void) {
+    return gpio_capture_head - gpio_capture_tail;
+}
+
+uint32_t gpio_capture_dropped(void) {
+    return gpio_capture_drops;
+}
+
+static void gpio_legacy_callback(void *ctx) {
+    ((void(*)(void))ctx)();
+}
+
+void gpio_int_latency_get(gpio_int_latency_t *stats) {
+#if GPIO_INT_LATENCY
+    *stats = gpio_latency;
+#else
+    stats->count = stats->last = stats->min = stats->max = 0;
+#endif
+}
+
+void gpio_int_latency_reset(void) {
+#if GPIO_INT_LATENCY
+    gpio_latency.count = 0;
+    gpio_latency.last  = 0;
+    gpio_latency.min   = UINT32_MAX;
+    gpio_latency.max   = 0;
+#endif
+}
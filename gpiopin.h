@@ -1,4 +1,16 @@
+#ifndef __GPIOPIN_H__
+#define __GPIOPIN_H__
+
 #include <stdint.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_gpio.h>
+
+#include "compiler.h"
+
+#define GPIO_NUM_PORTS     6
+#define GPIO_PINS_PER_PORT 8
+#define GPIO_NUM_PAD_REGS  14
 
 typedef enum {
     GPIO_PIN_DIR_IN = 0,
@@ -42,7 +54,60 @@ typedef struct {
     gpio_pin_int_type_t int_type;
 } gpio_pin_cfg_t;
 
-typedef void (*gpio_pin_int_cb_t)(void);
+// Pin interrupt callback, ctx is the pointer given to attach_callback
+typedef void (*gpio_pin_int_cb_t)(void *ctx);
+
+// Cycles from GPIO interrupt handler entry to the first callback
+typedef struct {
+    uint32_t count;
+    uint32_t last;
+    uint32_t min;
+    uint32_t max;
+} gpio_int_latency_t;
+
+// Set to 0 to drop the DWT reads from the interrupt path
+#ifndef GPIO_INT_LATENCY
+#define GPIO_INT_LATENCY 1
+#endif
+
+// Set to 1 to also register the port handlers at runtime with IntRegister,
+// which copies the vector table into RAM. Off by default since the handlers
+// are already bound into nvic_table at link time
+#ifndef GPIO_INT_REGISTER
+#define GPIO_INT_REGISTER 0
+#endif
+
+// Set to 1 to run the port handlers from SRAM (see __ramfunc). Each one has
+// the dispatch inlined, so this costs RAM for every port
+#ifndef GPIO_INT_RAMFUNC
+#define GPIO_INT_RAMFUNC 0
+#endif
+
+// Edge recorded by a pin in capture mode
+typedef struct {
+    uint32_t timestamp;     // DWT cycle count when the handler ran
+    uint8_t  port;          // port number
+    uint8_t  pins;          // capture pins that fired
+    uint8_t  level;         // level of those pins when sampled
+    uint8_t  reserved;
+} gpio_edge_event_t;
+
+// Capture queue length, must be a power of two
+#ifndef GPIO_CAPTURE_QUEUE_LEN
+#define GPIO_CAPTURE_QUEUE_LEN 64
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Register base and SysCtl peripheral of a port (0-5 for A-F), from the
+// same table GPIOPin uses. For C drivers that drive pins through other
+// peripherals. Returns -1 if there is no such port, otherwise 0
+int gpio_port_lookup(uint32_t port, uint32_t *base, uint32_t *periph);
+
+#ifdef __cplusplus
+}
 
 class GPIOPin {
   private:
@@ -50,6 +115,9 @@ class GPIOPin {
     uint32_t port_base, pin_mask, port_num, pin_num;
     gpio_pin_cfg_t config;
 
+    // Private methods
+    void enable_interrupt(gpio_pin_int_type_t event);
+
   public:
     // Public variables
 
@@ -65,6 +133,194 @@ class GPIOPin {
     void write(uint32_t x);
     void toggle(void);
     uint32_t read(void);
+    void attach_callback(gpio_pin_int_type_t event, gpio_pin_int_cb_t callback, void *ctx);
     void attach_callback(gpio_pin_int_type_t event, void(*callback)(void));
+    void attach_capture(gpio_pin_int_type_t event);
     void detach_callback(void);
 };
+
+/*
+ * Edge capture queue. Pins attached with attach_capture() only have their
+ * edges timestamped into a lock-free single producer/single consumer ring
+ * from the GPIO interrupt; gpio_capture_drain() empties it outside of
+ * interrupt context. All GPIO port interrupts must share one priority
+ * level (the default) so only one of them can be producing at a time.
+ */
+uint32_t gpio_capture_drain(gpio_edge_event_t *events, uint32_t max);
+uint32_t gpio_capture_pending(void);
+uint32_t gpio_capture_dropped(void);
+
+/*
+ * Batched pin configuration. Changes for any number of pins are staged per
+ * port, then commit() applies them in one pass per port. Each register
+ * with staged bits is read back at commit time and only those bits are
+ * changed, so settings made through driverlib since are kept, and
+ * registers whose value would not change are never written. Not safe to
+ * commit from an interrupt.
+ *
+ *     GPIOTransaction txn;
+ *     txn.set_direction(1, 0xFF, GPIO_PIN_DIR_OUT);
+ *     txn.set_drive_strength(1, 0xFF, GPIO_PIN_DRIVE_8MA);
+ *     txn.set_mode(5, 0x11, GPIO_PIN_MODE_STD_WPU);
+ *     txn.commit();
+ */
+class GPIOTransaction {
+  private:
+    // Private variables
+    uint8_t set_bits[GPIO_NUM_PORTS][GPIO_NUM_PAD_REGS];
+    uint8_t clr_bits[GPIO_NUM_PORTS][GPIO_NUM_PAD_REGS];
+    uint8_t int_disable[GPIO_NUM_PORTS];
+    uint32_t port_mask;
+
+    // Private methods
+    void stage(uint32_t port, uint32_t reg, uint32_t pin_mask, uint32_t on);
+
+  public:
+    // Constructors
+    GPIOTransaction(void);
+
+    // Public methods
+    void configure(uint32_t port, uint32_t pin_mask, const gpio_pin_cfg_t *cfg);
+    void set_direction(uint32_t port, uint32_t pin_mask, gpio_pin_dir_t dir);
+    void set_mode(uint32_t port, uint32_t pin_mask, gpio_pin_mode_t mode);
+    void set_drive_strength(uint32_t port, uint32_t pin_mask, gpio_pin_drive_t drive);
+    void set_int_type(uint32_t port, uint32_t pin_mask, gpio_pin_int_type_t int_type);
+
+    // Returns the number of register writes issued
+    uint32_t commit(void);
+};
+
+/*
+ * Group of pins on one port, read and written in a single access through
+ * the masked GPIODATA address. Logical bit i of a value maps to the i-th
+ * lowest pin in the mask, so non-contiguous pins are scattered/gathered
+ * through small per-bus nibble tables.
+ *
+ *     GPIOBus lcd_data = GPIOBus(1, 0xFF);    // PB0-PB7
+ *     lcd_data.set_direction(GPIO_PIN_DIR_OUT);
+ *     lcd_data = 0x3C;
+ */
+class GPIOBus {
+  private:
+    // Private variables
+    uint32_t port_num, pin_mask, data_addr;
+    uint8_t shift, width, contiguous;
+    uint8_t scatter_lo[16], scatter_hi[16];
+    uint8_t gather_lo[16], gather_hi[16];
+
+  public:
+    // Constructors
+    GPIOBus(uint32_t _port, uint32_t _pin_mask);
+
+    // Public methods
+    void operator=(uint32_t x);
+    void set_direction(gpio_pin_dir_t dir);
+    uint32_t get_width(void);
+
+    // Logical value, bit 0 = lowest pin in the mask
+    __always_inline void write(uint32_t x) {
+        HWREG(data_addr) = scatter(x);
+    }
+
+    __always_inline uint32_t read(void) {
+        return gather(HWREG(data_addr));
+    }
+
+    // Raw port value, bit n = pin n. Bits outside the mask are ignored
+    __always_inline void write_raw(uint32_t x) {
+        HWREG(data_addr) = x;
+    }
+
+    __always_inline uint32_t read_raw(void) {
+        return HWREG(data_addr);
+    }
+
+    __always_inline uint32_t scatter(uint32_t x) {
+        if(contiguous) {
+            return x << shift;
+        }
+        return scatter_lo[x & 0xF] | scatter_hi[(x >> 4) & 0xF];
+    }
+
+    __always_inline uint32_t gather(uint32_t x) {
+        if(contiguous) {
+            return (x & pin_mask) >> shift;
+        }
+        return gather_lo[x & 0xF] | gather_hi[(x >> 4) & 0xF];
+    }
+};
+
+// Interrupt latency statistics (only collected with GPIO_INT_LATENCY)
+void gpio_int_latency_get(gpio_int_latency_t *stats);
+void gpio_int_latency_reset(void);
+
+// Enable a port and set the direction of pins on it (pin_mask may hold
+// several pins). Cold path shared by the runtime and compile-time pin types
+void gpio_pin_init(uint32_t port, uint32_t pin_mask, gpio_pin_dir_t dir);
+
+// Port number to register base. Must stay in sync with ports[] in gpiopin.cpp
+constexpr uint32_t gpio_port_base(uint32_t port) {
+    return (port == 0) ? GPIO_PORTA_BASE :
+           (port == 1) ? GPIO_PORTB_BASE :
+           (port == 2) ? GPIO_PORTC_BASE :
+           (port == 3) ? GPIO_PORTD_BASE :
+           (port == 4) ? GPIO_PORTE_BASE :
+           (port == 5) ? GPIO_PORTF_BASE : 0;
+}
+
+// GPIODATA is aliased across 256 words: address bits [9:2] mask which pins
+// a load or store touches, so no read-modify-write is needed.
+constexpr uint32_t gpio_data_addr(uint32_t base, uint32_t pin_mask) {
+    return base + GPIO_O_DATA + (pin_mask << 2);
+}
+
+/*
+ * Compile-time pin. Everything is resolved from the template parameters, so
+ * it takes no RAM and write/read compile down to a single store/load on the
+ * masked GPIODATA address. Use GPIOPin when the pin is only known at runtime.
+ *
+ *     typedef StaticGPIOPin<5, 2> BlueLED;
+ *     BlueLED::init(GPIO_PIN_DIR_OUT);
+ *     BlueLED::write(1);
+ */
+template <uint32_t PORT, uint32_t PIN>
+class StaticGPIOPin {
+    static_assert(PORT < GPIO_NUM_PORTS, "invalid GPIO port");
+    static_assert(PIN < GPIO_PINS_PER_PORT, "invalid GPIO pin");
+
+  public:
+    static constexpr uint32_t port_num  = PORT;
+    static constexpr uint32_t pin_num   = PIN;
+    static constexpr uint32_t port_base = gpio_port_base(PORT);
+    static constexpr uint32_t pin_mask  = 1 << PIN;
+    static constexpr uint32_t data_addr = gpio_data_addr(port_base, pin_mask);
+
+    static void init(gpio_pin_dir_t dir = GPIO_PIN_DIR_IN) {
+        gpio_pin_init(PORT, pin_mask, dir);
+    }
+
+    __always_inline static void write(uint32_t x) {
+        HWREG(data_addr) = (x != 0) ? pin_mask : 0;
+    }
+
+    __always_inline static void set(void) {
+        HWREG(data_addr) = pin_mask;
+    }
+
+    __always_inline static void clear(void) {
+        HWREG(data_addr) = 0;
+    }
+
+    __always_inline static void toggle(void) {
+        // Masked address keeps this from disturbing other pins on the port
+        HWREG(data_addr) ^= pin_mask;
+    }
+
+    __always_inline static uint32_t read(void) {
+        return (HWREG(data_addr) != 0);
+    }
+};
+
+#endif
+
+#endif
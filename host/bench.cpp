@@ -0,0 +1,1052 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <inc/hw_memmap.h>
+#include <inc/hw_ssi.h>
+#include <driverlib/ssi.h>
+
+#include "host.h"
+#include "gpiopin.h"
+#include "uart.h"
+#include "spi.h"
+#include "adc.h"
+#include "log.h"
+#include "pool.h"
+#include "dsp.h"
+#include "twheel.h"
+
+/*
+ * Driver benchmarks and functional checks against the host model. Each
+ * benchmark prints one line:
+ *
+ *     BENCH <name> <iterations> <ns per iteration>
+ *
+ * and every failed check prints a FAIL line. The exit status is the number
+ * of failures, so this can gate CI directly.
+ */
+
+static uint32_t failures;
+
+#define CHECK(cond)                                                     \
+    do {                                                                \
+        if(!(cond)) {                                                   \
+            printf("FAIL %s:%d: %s\n", __FILE__, __LINE__, #cond);      \
+            failures++;                                                 \
+        }                                                               \
+    } while(0)
+
+static void report(const char *name, uint32_t iterations, uint64_t start) {
+    uint64_t ns = host_ns() - start;
+    printf("BENCH %-24s %10u %10.1f\n", name, iterations, (double)ns / iterations);
+}
+
+static void count_cb(void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
+// Edge in, handler, dispatch, callback: one interrupt per iteration
+static void bench_gpio_dispatch(void) {
+    const uint32_t n = 200000;
+    uint32_t count = 0;
+    uint32_t i;
+    uint64_t start;
+
+    GPIOPin pin = GPIOPin(0, 2);
+    pin.attach_callback(GPIO_PIN_INT_BOTH, count_cb, &count);
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        host_gpio_input(0, 1 << 2, (i & 1) ? 0 : 1 << 2);
+    }
+    report("gpio_dispatch", n, start);
+
+    CHECK(count == n);
+
+    // Opposite edge only
+    pin.attach_callback(GPIO_PIN_INT_RISING, count_cb, &count);
+    count = 0;
+    for(i = 0; i < 100; i++) {
+        host_gpio_input(0, 1 << 2, (i & 1) ? 0 : 1 << 2);
+    }
+    CHECK(count == 50);
+
+    pin.detach_callback();
+    host_gpio_input(0, 1 << 2, 1 << 2);
+    CHECK(count == 50);
+}
+
+// All eight pins of a port firing in the same interrupt
+static void bench_gpio_dispatch_port(void) {
+    const uint32_t n = 50000;
+    uint32_t counts[8] = {0};
+    uint32_t i;
+    uint64_t start;
+
+    GPIOPin pins[8] = {
+        GPIOPin(2, 0), GPIOPin(2, 1), GPIOPin(2, 2), GPIOPin(2, 3),
+        GPIOPin(2, 4), GPIOPin(2, 5), GPIOPin(2, 6), GPIOPin(2, 7),
+    };
+    for(i = 0; i < 8; i++) {
+        pins[i].attach_callback(GPIO_PIN_INT_BOTH, count_cb, &counts[i]);
+    }
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        host_gpio_input(2, 0xFF, (i & 1) ? 0x00 : 0xFF);
+    }
+    report("gpio_dispatch_8pin", n, start);
+
+    for(i = 0; i < 8; i++) {
+        CHECK(counts[i] == n);
+        pins[i].detach_callback();
+    }
+}
+
+static void bench_gpio_capture(void) {
+    gpio_edge_event_t events[GPIO_CAPTURE_QUEUE_LEN];
+    uint32_t i, n;
+
+    GPIOPin pin = GPIOPin(3, 0);
+    pin.attach_capture(GPIO_PIN_INT_RISING);
+
+    for(i = 0; i < 20; i++) {
+        host_gpio_input(3, 1, (i & 1) ? 0 : 1);
+    }
+
+    n = gpio_capture_drain(events, GPIO_CAPTURE_QUEUE_LEN);
+    CHECK(n == 10);
+    for(i = 0; i < n; i++) {
+        CHECK(events[i].port == 3 && events[i].pins == 1 && events[i].level == 1);
+    }
+    CHECK(gpio_capture_pending() == 0);
+    CHECK(gpio_capture_dropped() == 0);
+
+    pin.detach_callback();
+}
+
+// Every pin on every port, then the same configuration again
+static void bench_gpio_commit(void) {
+    const uint32_t n = 100000;
+    uint32_t i, port, writes;
+    uint64_t start;
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        GPIOTransaction txn;
+        for(port = 0; port < GPIO_NUM_PORTS; port++) {
+            txn.set_direction(port, 0xF0, (i & 1) ? GPIO_PIN_DIR_OUT : GPIO_PIN_DIR_IN);
+            txn.set_mode(port, 0xF0, (i & 1) ? GPIO_PIN_MODE_STD_WPU : GPIO_PIN_MODE_STD);
+            txn.set_drive_strength(port, 0xF0, (i & 1) ? GPIO_PIN_DRIVE_8MA : GPIO_PIN_DRIVE_2MA);
+        }
+        writes = txn.commit();
+        CHECK(writes > 0);
+    }
+    report("gpio_commit_change", n, start);
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        GPIOTransaction txn;
+        for(port = 0; port < GPIO_NUM_PORTS; port++) {
+            txn.set_direction(port, 0xF0, GPIO_PIN_DIR_OUT);
+            txn.set_mode(port, 0xF0, GPIO_PIN_MODE_STD_WPU);
+            txn.set_drive_strength(port, 0xF0, GPIO_PIN_DRIVE_8MA);
+        }
+        writes = txn.commit();
+        CHECK(writes == 0);
+    }
+    report("gpio_commit_nochange", n, start);
+
+    // Back to inputs for the tests that follow
+    for(port = 0; port < GPIO_NUM_PORTS; port++) {
+        gpio_pin_init(port, 0xF0, GPIO_PIN_DIR_IN);
+    }
+}
+
+static void bench_gpio_static(void) {
+    typedef StaticGPIOPin<5, 2> Pin;
+    const uint32_t n = 1000001;
+    uint32_t i, x;
+    uint64_t start, loads, stores;
+
+    Pin::init(GPIO_PIN_DIR_OUT);
+    Pin::clear();
+    CHECK(Pin::read() == 0);
+
+    // The masked data address lets write, set and clear store straight to
+    // the pin without loading the port first. Only toggle loads, once
+    for(i = 0; i < 8; i++) {
+        x = !Pin::read();
+        loads = host_reg_reads();
+        stores = host_reg_writes();
+        Pin::write(x);
+        CHECK(host_reg_reads() - loads == 0);
+        CHECK(host_reg_writes() - stores == 1);
+
+        loads = host_reg_reads();
+        stores = host_reg_writes();
+        if(i & 1) {
+            Pin::set();
+        } else {
+            Pin::clear();
+        }
+        CHECK(host_reg_reads() - loads == 0);
+        CHECK(host_reg_writes() - stores == 1);
+
+        loads = host_reg_reads();
+        stores = host_reg_writes();
+        Pin::toggle();
+        CHECK(host_reg_reads() - loads == 1);
+        CHECK(host_reg_writes() - stores == 1);
+    }
+    Pin::clear();
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        Pin::toggle();
+    }
+    report("gpio_static_toggle", n, start);
+
+    CHECK(host_gpio_level(5) & (1 << 2));
+    CHECK(Pin::read() == 1);
+
+    Pin::init(GPIO_PIN_DIR_IN);
+}
+
+static void bench_gpio_bus(void) {
+    const uint32_t n = 1000000;
+    uint32_t i, sum = 0;
+    uint64_t start;
+
+    // Scattered pins, so the nibble tables are used
+    GPIOBus bus = GPIOBus(1, 0xA5);
+    bus.set_direction(GPIO_PIN_DIR_OUT);
+    CHECK(bus.get_width() == 4);
+
+    for(i = 0; i < 16; i++) {
+        bus.write(i);
+        CHECK(bus.read() == i);
+    }
+    bus.write(0xF);
+    CHECK(host_gpio_level(1) == 0xA5);
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        bus.write(i);
+        sum += bus.read();
+    }
+    report("gpio_bus_write_read", n, start);
+    CHECK(sum != 0);
+
+    bus.set_direction(GPIO_PIN_DIR_IN);
+}
+
+static void bench_uart(void) {
+    static char out[256], back[256];
+    const uint32_t n = 20000;
+    uart_stats_t stats;
+    uint64_t start, sent, total = 0;
+    uint32_t i, len, got;
+
+    // UART1 is not clocked yet, nothing may reach it
+    CHECK(uart_write("x", 1) == -1);
+    CHECK(uart_read(back, sizeof(back)) == -1);
+
+    // A pin set up before uart_init and another one after it: the second
+    // commit on port B must leave the UART pins driverlib configured alone
+    GPIOPin before = GPIOPin(1, 2);
+    uart_init(115200);
+    GPIOPin after = GPIOPin(1, 3);
+    CHECK((HWREG(GPIO_PORTB_BASE + GPIO_O_DEN) & 0x03) == 0x03);
+    CHECK((HWREG(GPIO_PORTB_BASE + GPIO_O_AFSEL) & 0x03) == 0x03);
+    (void)before;
+    (void)after;
+
+    for(i = 0; i < sizeof(out); i++) {
+        out[i] = (char)i;
+    }
+
+    // Short writes go through the FIFO, long ones by uDMA
+    for(len = 1; len <= sizeof(out); len *= 2) {
+        CHECK(uart_write(out, len) == (int)len);
+        got = host_uart_tx_take(back, sizeof(back));
+        CHECK(got == len);
+        CHECK(memcmp(out, back, len) == 0);
+    }
+
+    sent = host_uart_tx_count();
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        len = 1 + (i % sizeof(out));
+        uart_write(out, len);
+        total += len;
+        got = host_uart_tx_take(back, sizeof(back));
+        CHECK(got == len && memcmp(out, back, len) == 0);
+    }
+    report("uart_write", n, start);
+
+    uart_flush();
+    uart_stats_get(&stats);
+    CHECK(stats.tx_dropped == 0);
+    CHECK(stats.tx_dma > 0);
+    CHECK(host_uart_tx_count() - sent == total);
+
+    // RX: the interrupt moves the FIFO into the ring
+    CHECK(host_uart_rx("hello", 5) == 5);
+    CHECK(uart_read(back, sizeof(back)) == 5);
+    CHECK(memcmp(back, "hello", 5) == 0);
+    CHECK(uart_read(back, sizeof(back)) == 0);
+}
+
+// Transfers in the order they completed, with the level of the two chip
+// selects on port A as each callback ran
+static uint32_t spi_order[8];
+static uint8_t spi_cs_level[8];
+static uint32_t spi_done;
+
+static void spi_done_cb(void *ctx) {
+    spi_cs_level[spi_done] = host_gpio_level(0) & ((1 << 3) | (1 << 6));
+    spi_order[spi_done++] = (uint32_t)(uintptr_t)ctx;
+}
+
+static void bench_spi(void) {
+    static uint8_t tx8[1500], rx8[16];
+    static uint16_t tx16[2500], rx16[2500], sent[2500];
+    const uint8_t cs_a = 1 << 3, cs_b = 1 << 6;
+    const uint32_t n = 20000;
+    uint32_t i, runs, primask;
+    uint64_t start;
+
+    GPIOPin a = GPIOPin(0, 3);
+    GPIOPin b = GPIOPin(0, 6);
+    a.set_direction(GPIO_PIN_DIR_OUT);
+    b.set_direction(GPIO_PIN_DIR_OUT);
+    a.write(1);
+    b.write(1);
+
+    for(i = 0; i < sizeof(tx8); i++) {
+        tx8[i] = (uint8_t)(i * 7);
+    }
+    for(i = 0; i < 2500; i++) {
+        tx16[i] = (uint16_t)(i * 40503);
+    }
+
+    spi_xfer_t cmd  = {NULL, &a, 1000000, 8, 0, SPI_XFER_CS_HOLD, tx8, NULL, 4, spi_done_cb, (void *)1};
+    spi_xfer_t data = {NULL, &a, 1000000, 8, 0, SPI_XFER_CS_HOLD, NULL, rx8, 8, spi_done_cb, (void *)2};
+    spi_xfer_t hold = {NULL, &b, 4000000, 16, 3, SPI_XFER_CS_HOLD, tx16, rx16, 4, spi_done_cb, (void *)3};
+    spi_xfer_t release = {NULL, &b, 4000000, 16, 3, 0, NULL, NULL, 0, spi_done_cb, (void *)4};
+    spi_xfer_t mark = {NULL, NULL, 1000000, 8, 0, 0, NULL, NULL, 0, spi_done_cb, (void *)5};
+
+    // The bus is not set up yet, and a transfer needs sane settings
+    CHECK(spi_submit(0, &cmd) == -1);
+    spi_init(0);
+    cmd.word_bits = 3;
+    CHECK(spi_submit(0, &cmd) == -1);
+    cmd.word_bits = 8;
+
+    // Queued back to back before any can finish. A held select carries
+    // over into a transfer using it next, is released before one on the
+    // other select starts, and a zero length marker on the same select
+    // releases it in queue order
+    host_ssi_take(0, sent, 2500);
+    primask = host_irq_save();
+    CHECK(spi_submit(0, &cmd) == 0);
+    CHECK(spi_submit(0, &data) == 0);
+    CHECK(spi_submit(0, &hold) == 0);
+    CHECK(spi_submit(0, &release) == 0);
+    CHECK(spi_submit(0, &mark) == 0);
+    CHECK(spi_submit(0, &mark) == -1);
+    CHECK(!spi_idle(0));
+    host_irq_restore(primask);
+
+    CHECK(spi_idle(0));
+    CHECK(spi_done == 5);
+    for(i = 0; i < spi_done; i++) {
+        CHECK(spi_order[i] == i + 1);
+    }
+    CHECK(spi_cs_level[0] == cs_b);
+    CHECK(spi_cs_level[1] == cs_a);
+    CHECK(spi_cs_level[2] == cs_a);
+    CHECK(spi_cs_level[3] == (cs_a | cs_b));
+    CHECK(spi_cs_level[4] == (cs_a | cs_b));
+    CHECK(!cmd.busy && !data.busy && !hold.busy && !release.busy && !mark.busy);
+
+    // What went out: the command, fill words for the read, then the 16-bit
+    // words echoed back into rx16
+    CHECK(host_ssi_take(0, sent, 2500) == 16);
+    for(i = 0; i < 4; i++) {
+        CHECK(sent[i] == tx8[i]);
+        CHECK(sent[12 + i] == tx16[i] && rx16[i] == tx16[i]);
+    }
+    for(i = 0; i < 8; i++) {
+        CHECK(sent[4 + i] == (SPI_TX_FILL & 0xFF) && rx8[i] == (SPI_TX_FILL & 0xFF));
+    }
+
+    // A marker on an idle bus finishes as it is queued
+    CHECK(spi_submit(0, &mark) == 0);
+    CHECK(!mark.busy && spi_done == 6 && spi_order[5] == 5);
+
+    // Longer than one uDMA transfer goes in pieces of SPI_DMA_MAX words
+    spi_xfer_t big = {NULL, &a, 4000000, 16, 0, 0, tx16, rx16, 2500, NULL, NULL};
+    memset(rx16, 0, sizeof(rx16));
+    runs = host_ssi_dma_runs(0);
+    CHECK(spi_submit(0, &big) == 0);
+    CHECK(!big.busy);
+    CHECK(host_ssi_dma_runs(0) - runs == 3);
+    CHECK(memcmp(rx16, tx16, sizeof(rx16)) == 0);
+    CHECK(host_ssi_take(0, sent, 2500) == 2500 && memcmp(sent, tx16, sizeof(sent)) == 0);
+
+    // Transmit only: what piles up in the RX FIFO is dropped once the
+    // shifter is done, and the end of transmission interrupt goes quiet
+    spi_xfer_t out = {NULL, &a, 1000000, 8, 0, 0, tx8, NULL, sizeof(tx8), NULL, NULL};
+    runs = host_ssi_dma_runs(0);
+    CHECK(spi_submit(0, &out) == 0);
+    CHECK(!out.busy);
+    CHECK(host_ssi_dma_runs(0) - runs == 2);
+    CHECK(!(HWREG(SSI0_BASE + SSI_O_SR) & SSI_SR_RNE));
+    CHECK(!(HWREG(SSI0_BASE + SSI_O_RIS) & SSI_RXOR));
+    CHECK(!(HWREG(SSI0_BASE + SSI_O_IM) & SSI_TXFF));
+    CHECK(host_gpio_level(0) & cs_a);
+    host_ssi_take(0, sent, 2500);
+
+    spi_xfer_t x = {NULL, &a, 1000000, 8, 0, 0, tx8, rx8, 16, NULL, NULL};
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        spi_submit(0, &x);
+    }
+    report("spi_xfer_16", n, start);
+
+    CHECK(spi_idle(0) && !x.busy);
+    CHECK(memcmp(rx8, tx8, 16) == 0);
+}
+
+// Stands in for timebase.c under adc.c, one frame period per trigger
+static uint64_t adc_ns;
+
+extern "C" uint64_t timebase_ns(void) {
+    return adc_ns;
+}
+
+// Blocks in the order the callback got them. With ctx set the callback
+// hands each one straight back
+static uint16_t adc_blocks[4][64];
+static uint16_t *adc_got[16];
+static uint32_t adc_ngot;
+static uint16_t adc_base;
+
+static void adc_block_cb(void *ctx, uint16_t *block, uint32_t len) {
+    (void)len;
+    if(ctx) {
+        adc_stream_release(0, block);
+    } else {
+        adc_got[adc_ngot++ & 15] = block;
+    }
+}
+
+// Timer 3 expiring at 100 kHz, each expiry one frame of two conversions
+static void adc_frames(uint32_t n) {
+    while(n--) {
+        adc_ns += 10000;
+        host_timer_expire(3);
+    }
+}
+
+// Conversions count up from adc_base, the first one taken, so a block
+// holds consecutive samples starting first after it
+static bool adc_holds(const uint16_t *block, uint32_t first) {
+    uint32_t i;
+
+    for(i = 0; i < 64; i++) {
+        if(((block[i] - adc_base) & 0xFFF) != ((first + i) & 0xFFF)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void bench_adc(void) {
+    static const uint8_t channels[] = {0, 1};
+    const uint32_t n = 200000;
+    adc_stream_stats_t stats;
+    uint32_t primask;
+    uint64_t start;
+
+    adc_stream_config_t config = {channels, 2, &adc_blocks[0][0], 64, 4, adc_block_cb, NULL};
+
+    // The rate comes first, and the blocks must fit the frame
+    CHECK(adc_stream_config(0, &config) == -1);
+    CHECK(adc_stream_init(100000) == 100000);
+    config.nblocks = 2;
+    CHECK(adc_stream_config(0, &config) == -1);
+    config.nblocks = 4;
+    config.block_len = 63;
+    CHECK(adc_stream_config(0, &config) == -1);
+    config.block_len = 64;
+    CHECK(adc_stream_config(0, &config) == 0);
+    adc_stream_start();
+
+    // Blocks 0 and 1 start armed, 2 and 3 replace them as they fill
+    adc_frames(32);
+    CHECK(adc_ngot == 1 && adc_got[0] == adc_blocks[0]);
+    adc_base = adc_blocks[0][0];
+    adc_frames(32);
+    CHECK(adc_ngot == 2 && adc_got[1] == adc_blocks[1]);
+    CHECK(adc_holds(adc_blocks[0], 0) && adc_holds(adc_blocks[1], 64));
+
+    // Nothing free: 2 and 3 are filled again in place and dropped, and
+    // the blocks the caller holds are left alone
+    adc_frames(64);
+    adc_stream_stats_get(0, &stats);
+    CHECK(adc_ngot == 2 && stats.dropped == 2 && stats.blocks == 2);
+    CHECK(adc_holds(adc_blocks[0], 0) && adc_holds(adc_blocks[1], 64));
+
+    // A released block is armed next, after the one filling now
+    adc_stream_release(0, adc_blocks[1]);
+    adc_frames(32);
+    CHECK(adc_ngot == 3 && adc_got[2] == adc_blocks[2]);
+    CHECK(adc_holds(adc_blocks[2], 256));
+    adc_frames(32);
+    adc_stream_stats_get(0, &stats);
+    CHECK(adc_ngot == 3 && stats.dropped == 3);
+
+    // Of two free blocks the lowest goes first: 0 refills block 1's half,
+    // 2 block 3's, and with nothing left 0 is dropped once full
+    adc_stream_release(0, adc_blocks[2]);
+    adc_stream_release(0, adc_blocks[0]);
+    adc_frames(96);
+    CHECK(adc_ngot == 5 && adc_got[3] == adc_blocks[1] && adc_got[4] == adc_blocks[3]);
+    CHECK(adc_holds(adc_blocks[1], 384) && adc_holds(adc_blocks[3], 448));
+    CHECK(adc_holds(adc_blocks[0], 512));
+
+    adc_stream_stats_get(0, &stats);
+    CHECK(stats.blocks == 5 && stats.dropped == 4 && stats.overflows == 0);
+    CHECK(stats.samples == 5 * 64);
+    CHECK(stats.rate_hz == 100000 && stats.measured_hz == 100000);
+
+    // Held off past both halves the channel stops and the sequencer FIFO
+    // overflows. The interrupt counts it and restarts the channel
+    adc_stream_release(0, adc_blocks[1]);
+    adc_stream_release(0, adc_blocks[3]);
+    primask = host_irq_save();
+    adc_frames(96);
+    host_irq_restore(primask);
+    adc_stream_stats_get(0, &stats);
+    CHECK(stats.overflows == 1 && adc_ngot == 7);
+    adc_stream_release(0, adc_got[5]);
+    adc_stream_release(0, adc_got[6]);
+    adc_frames(64);
+    adc_stream_stats_get(0, &stats);
+    CHECK(stats.overflows == 1 && adc_ngot == 9);
+
+    // Released from the callback nothing is dropped
+    adc_stream_stop();
+    config.ctx = (void *)1;
+    CHECK(adc_stream_config(0, &config) == 0);
+    adc_stream_start();
+
+    start = host_ns();
+    adc_frames(n);
+    report("adc_frame", n, start);
+
+    adc_stream_stats_get(0, &stats);
+    CHECK(stats.blocks == n / 32 && stats.dropped == 0 && stats.overflows == 0);
+    adc_stream_stop();
+}
+
+// Stands in for syscalls.c under log_flush. Takes up to log_budget bytes
+// in all, or fails with -1 if that is negative
+static char log_out[1024];
+static uint32_t log_out_len;
+static int32_t log_budget;
+
+extern "C" int _write(int file, char *ptr, int len) {
+    (void)file;
+
+    if(log_budget < 0) {
+        return -1;
+    }
+    if(len > log_budget) {
+        len = log_budget;
+    }
+    memcpy(&log_out[log_out_len], ptr, len);
+    log_out_len += len;
+    log_budget -= len;
+    return len;
+}
+
+static void bench_log(void) {
+    uint32_t frame[3];
+    uint32_t head;
+
+    // Two records of three words
+    log_record(0x10, 1, 5, 0, 0, 0);
+    log_record(0x20, 1, 6, 0, 0, 0);
+    head = log_head;
+
+    // Nothing taken: the records stay queued
+    log_budget = -1;
+    CHECK(log_flush() == 0);
+    CHECK(log_tail == head - 6 && log_dropped == 0);
+
+    // The header and part of a record go out: the frame is lost and both
+    // records are counted dropped
+    log_out_len = 0;
+    log_budget = 12 + 8;
+    CHECK(log_flush() == 0);
+    CHECK(log_tail == head && log_dropped == 2);
+
+    // A whole frame reports the loss
+    log_record(0x30, 0, 0, 0, 0, 0);
+    log_out_len = 0;
+    log_budget = sizeof(log_out);
+    CHECK(log_flush() == 2);
+    CHECK(log_out_len == 12 + 8);
+    memcpy(frame, log_out, sizeof(frame));
+    CHECK(frame[0] == LOG_FRAME_MAGIC && frame[1] == 2 && frame[2] == 2);
+    CHECK(log_flush() == 0);
+}
+
+static void bench_pool(void) {
+    const uint32_t n = 1000000;
+    void *p[8];
+    uint32_t i, j;
+    uint64_t start;
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < 8; j++) {
+            p[j] = pool_alloc(8 + j * 12);
+        }
+        for(j = 0; j < 8; j++) {
+            pool_free(p[j]);
+        }
+    }
+    report("pool_alloc_free", n * 8, start);
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        for(j = 0; j < 8; j++) {
+            p[j] = malloc(8 + j * 12);
+        }
+        for(j = 0; j < 8; j++) {
+            free(p[j]);
+        }
+    }
+    report("malloc_free", n * 8, start);
+
+    CHECK(pool_failures() == 0);
+    CHECK(pool_heap_allocs() == 0);
+}
+
+// Deterministic test signal, full scale so saturation gets exercised
+static uint32_t dsp_seed = 12345;
+
+static int32_t dsp_rand(void) {
+    dsp_seed = dsp_seed * 1664525 + 1013904223;
+    return (int32_t)dsp_seed;
+}
+
+// Block sizes the filters get fed in, so state carries across every
+// split of the signal
+static const uint32_t dsp_blocks[] = {1, 7, 64, 2, 33, 3, 64, 16, 5};
+
+#define DSP_LEN             1024
+#define DSP_BLOCK_MAX       64
+
+static void bench_dsp_vector(void) {
+    static q15_t a[DSP_LEN], b[DSP_LEN], out[DSP_LEN], ref[DSP_LEN];
+    static q31_t a31[DSP_LEN], b31[DSP_LEN], out31[DSP_LEN], ref31[DSP_LEN];
+    static float f[DSP_LEN];
+    const uint32_t reps = 2000;
+    uint32_t i, r, len;
+    int64_t dot = 0;
+    uint64_t start;
+
+    for(i = 0; i < DSP_LEN; i++) {
+        a[i] = dsp_rand() >> 16;
+        b[i] = dsp_rand() >> 16;
+        a31[i] = dsp_rand();
+        b31[i] = dsp_rand();
+    }
+    a[0] = b[0] = INT16_MIN;
+    a31[0] = b31[0] = INT32_MIN;
+
+    // Odd lengths take the single sample tails
+    for(len = DSP_LEN - 1; len <= DSP_LEN; len++) {
+        dsp_add_q15(a, b, out, len);
+        dsp_add_q15_ref(a, b, ref, len);
+        CHECK(memcmp(out, ref, len * sizeof(q15_t)) == 0);
+
+        dsp_sub_q15(a, b, out, len);
+        dsp_sub_q15_ref(a, b, ref, len);
+        CHECK(memcmp(out, ref, len * sizeof(q15_t)) == 0);
+
+        dsp_mul_q15(a, b, out, len);
+        dsp_mul_q15_ref(a, b, ref, len);
+        CHECK(memcmp(out, ref, len * sizeof(q15_t)) == 0);
+
+        dsp_scale_q15(a, 20000, 2, out, len);
+        dsp_scale_q15_ref(a, 20000, 2, ref, len);
+        CHECK(memcmp(out, ref, len * sizeof(q15_t)) == 0);
+
+        CHECK(dsp_dot_q15(a, b, len) == dsp_dot_q15_ref(a, b, len));
+
+        dsp_add_q31(a31, b31, out31, len);
+        dsp_add_q31_ref(a31, b31, ref31, len);
+        CHECK(memcmp(out31, ref31, len * sizeof(q31_t)) == 0);
+
+        dsp_mul_q31(a31, b31, out31, len);
+        dsp_mul_q31_ref(a31, b31, ref31, len);
+        CHECK(memcmp(out31, ref31, len * sizeof(q31_t)) == 0);
+    }
+
+    // Round trip through float is exact for Q15, and out of range saturates
+    dsp_q15_to_f32(a, f, DSP_LEN);
+    dsp_f32_to_q15(f, out, DSP_LEN);
+    CHECK(memcmp(out, a, sizeof(a)) == 0);
+    f[0] = 1.5f;
+    f[1] = -2.0f;
+    f[2] = -0.99999f;
+    dsp_f32_to_q15(f, out, 3);
+    CHECK(out[0] == INT16_MAX && out[1] == INT16_MIN && out[2] == -32767);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dsp_add_q15(a, b, out, DSP_LEN);
+    }
+    report("dsp_add_q15", reps * DSP_LEN, start);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dsp_mul_q15(a, b, out, DSP_LEN);
+    }
+    report("dsp_mul_q15", reps * DSP_LEN, start);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dot += dsp_dot_q15(a, out, DSP_LEN);
+    }
+    report("dsp_dot_q15", reps * DSP_LEN, start);
+    CHECK(dot != 0);
+}
+
+static void bench_dsp_filters(void) {
+    static q15_t x[DSP_LEN], y[DSP_LEN], ref[DSP_LEN];
+    static float xf[DSP_LEN], yf[DSP_LEN], reff[DSP_LEN];
+    static q15_t h[32], state[DSP_FIR_STATE_LEN(32, DSP_BLOCK_MAX)];
+    static float hf[32], statef[DSP_FIR_STATE_LEN(32, DSP_BLOCK_MAX)];
+    static q15_t avg_buf[16];
+
+    // Two Butterworth lowpass sections, the Q15 set scaled by 2^-1
+    static const float bqf[10] = {
+        0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f,
+        0.2929f, 0.5858f, 0.2929f, -0.0000f, 0.1716f,
+    };
+    static const q15_t bq15[10] = {
+        1106, 2211, 1106, -18727, 6763,
+        4799, 9598, 4799,      0, 2811,
+    };
+    float bq_state[4];
+    q15_t bq_state15[8];
+
+    const uint32_t reps = 200;
+    uint32_t i, r, taps, pos, blk;
+    uint64_t start;
+    dsp_fir_q15_t fir;
+    dsp_fir_f32_t firf;
+    dsp_biquad_f32_t bq;
+    dsp_biquad_q15_t bq15s;
+    dsp_mavg_q15_t avg;
+
+    for(i = 0; i < DSP_LEN; i++) {
+        x[i] = dsp_rand() >> 16;
+        xf[i] = x[i] * (1.0f / 32768.0f);
+    }
+    for(i = 0; i < 32; i++) {
+        h[i] = dsp_rand() >> 20;
+        hf[i] = h[i] * (1.0f / 32768.0f);
+    }
+    h[3] = INT16_MIN;
+
+    // Odd and even tap counts, fed in uneven blocks
+    for(taps = 31; taps <= 32; taps++) {
+        dsp_fir_q15_init(&fir, h, taps, state);
+        dsp_fir_f32_init(&firf, hf, taps, statef);
+        for(pos = 0, blk = 0; pos < DSP_LEN; pos += r, blk++) {
+            r = dsp_blocks[blk % (sizeof(dsp_blocks) / sizeof(*dsp_blocks))];
+            r = (r < DSP_LEN - pos) ? r : DSP_LEN - pos;
+            dsp_fir_q15(&fir, &x[pos], &y[pos], r);
+            dsp_fir_f32(&firf, &xf[pos], &yf[pos], r);
+        }
+        dsp_fir_q15_ref(h, taps, x, ref, DSP_LEN);
+        dsp_fir_f32_ref(hf, taps, xf, reff, DSP_LEN);
+        CHECK(memcmp(y, ref, sizeof(y)) == 0);
+        CHECK(memcmp(yf, reff, sizeof(yf)) == 0);
+    }
+
+    dsp_biquad_f32_init(&bq, bqf, 2, bq_state);
+    dsp_biquad_q15_init(&bq15s, bq15, 2, 1, bq_state15);
+    dsp_mavg_q15_init(&avg, avg_buf, 4);
+    for(pos = 0, blk = 0; pos < DSP_LEN; pos += r, blk++) {
+        r = dsp_blocks[blk % (sizeof(dsp_blocks) / sizeof(*dsp_blocks))];
+        r = (r < DSP_LEN - pos) ? r : DSP_LEN - pos;
+        dsp_biquad_f32(&bq, &xf[pos], &yf[pos], r);
+        dsp_biquad_q15(&bq15s, &x[pos], &y[pos], r);
+    }
+    dsp_biquad_f32_ref(bqf, 2, xf, reff, DSP_LEN);
+    CHECK(memcmp(yf, reff, sizeof(yf)) == 0);
+    dsp_biquad_q15_ref(bq15, 2, 1, x, ref, DSP_LEN);
+    CHECK(memcmp(y, ref, sizeof(y)) == 0);
+
+    // In place
+    memcpy(y, x, sizeof(y));
+    for(pos = 0, blk = 0; pos < DSP_LEN; pos += r, blk++) {
+        r = dsp_blocks[blk % (sizeof(dsp_blocks) / sizeof(*dsp_blocks))];
+        r = (r < DSP_LEN - pos) ? r : DSP_LEN - pos;
+        dsp_mavg_q15(&avg, &y[pos], &y[pos], r);
+    }
+    dsp_mavg_q15_ref(4, x, ref, DSP_LEN);
+    CHECK(memcmp(y, ref, sizeof(y)) == 0);
+
+    // Per sample cost, one 64 sample block at a time
+    dsp_fir_q15_init(&fir, h, 32, state);
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        for(pos = 0; pos < DSP_LEN; pos += DSP_BLOCK_MAX) {
+            dsp_fir_q15(&fir, &x[pos], &y[pos], DSP_BLOCK_MAX);
+        }
+    }
+    report("dsp_fir_q15_32tap", reps * DSP_LEN, start);
+
+    dsp_fir_f32_init(&firf, hf, 32, statef);
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        for(pos = 0; pos < DSP_LEN; pos += DSP_BLOCK_MAX) {
+            dsp_fir_f32(&firf, &xf[pos], &yf[pos], DSP_BLOCK_MAX);
+        }
+    }
+    report("dsp_fir_f32_32tap", reps * DSP_LEN, start);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dsp_biquad_q15(&bq15s, x, y, DSP_LEN);
+    }
+    report("dsp_biquad_q15_2stage", reps * DSP_LEN, start);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dsp_biquad_f32(&bq, xf, yf, DSP_LEN);
+    }
+    report("dsp_biquad_f32_2stage", reps * DSP_LEN, start);
+
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        dsp_mavg_q15(&avg, x, y, DSP_LEN);
+    }
+    report("dsp_mavg_q15_16", reps * DSP_LEN, start);
+}
+
+static void bench_dsp_fft(void) {
+    static float in[1024], buf[1024], ref[1024];
+    static float twiddle[DSP_RFFT_TWIDDLE_LEN(1024)];
+    const uint32_t reps = 200;
+    dsp_rfft_f32_t fft;
+    uint32_t n, i, r;
+    float err, peak;
+    uint64_t start;
+
+    CHECK(dsp_rfft_f32_init(&fft, 4, twiddle) == -1);
+    CHECK(dsp_rfft_f32_init(&fft, 48, twiddle) == -1);
+
+    for(i = 0; i < 1024; i++) {
+        in[i] = (dsp_rand() >> 16) * (1.0f / 32768.0f);
+    }
+
+    // n / 2 covers both even and odd powers of two
+    for(n = 8; n <= 1024; n <<= 1) {
+        CHECK(dsp_rfft_f32_init(&fft, n, twiddle) == 0);
+        memcpy(buf, in, n * sizeof(float));
+        dsp_rfft_f32(&fft, buf);
+        dsp_rfft_f32_ref(n, in, ref);
+
+        err = peak = 0.0f;
+        for(i = 0; i < n; i++) {
+            err = fmaxf(err, fabsf(buf[i] - ref[i]));
+            peak = fmaxf(peak, fabsf(ref[i]));
+        }
+        CHECK(err <= peak * 1e-5f);
+    }
+
+    CHECK(dsp_rfft_f32_init(&fft, 256, twiddle) == 0);
+    start = host_ns();
+    for(r = 0; r < reps; r++) {
+        memcpy(buf, in, 256 * sizeof(float));
+        dsp_rfft_f32(&fft, buf);
+    }
+    report("dsp_rfft_f32_256", reps, start);
+}
+
+#define TW_TIMERS           4096
+
+static twheel_timer_t tw_timers[TW_TIMERS];
+
+// Tick each timer's callback ran on, 0 if it has not
+static uint32_t tw_fired[TW_TIMERS];
+static uint32_t tw_notified;
+
+static void tw_record(void *ctx) {
+    tw_fired[(twheel_timer_t *)ctx - tw_timers] = twheel_ticks();
+}
+
+static void tw_count(void *ctx) {
+    (*(uint32_t *)ctx)++;
+}
+
+static void tw_notify(void *ctx) {
+    tw_notified++;
+}
+
+// Timers spread over every level fire on exactly their tick, and
+// cancelled ones not at all
+static void bench_twheel_accuracy(void) {
+    static uint32_t due[TW_TIMERS];
+    uint32_t i, start, late = 0, early = 0, stray = 0;
+
+    twheel_init();
+    start = twheel_ticks();
+
+    for(i = 0; i < TW_TIMERS; i++) {
+        // Mostly short, some into each higher level
+        uint32_t d = (uint32_t)dsp_rand() >> (32 - 4 - 6 * (i % 4));
+
+        twheel_timer_init(&tw_timers[i], tw_record, &tw_timers[i], TWHEEL_ISR);
+        twheel_start(&tw_timers[i], d * TWHEEL_TICK_US, 0);
+        due[i] = start + d + 1;
+        tw_fired[i] = 0;
+    }
+    for(i = 0; i < TW_TIMERS; i += 3) {
+        twheel_stop(&tw_timers[i]);
+    }
+
+    // The tick stops with the last timer
+    while(host_timer_expire(0));
+
+    for(i = 0; i < TW_TIMERS; i++) {
+        if(i % 3 == 0) {
+            stray += tw_fired[i] != 0;
+        } else if(tw_fired[i] > due[i]) {
+            late++;
+        } else if(tw_fired[i] < due[i]) {
+            early++;
+        }
+    }
+    CHECK(late == 0);
+    CHECK(early == 0);
+    CHECK(stray == 0);
+}
+
+static void bench_twheel_modes(void) {
+    twheel_timer_t periodic, restart, deferred;
+    uint32_t n_periodic = 0, n_deferred = 0, n_restart = 0, i;
+
+    // Periodic on its own grid
+    twheel_timer_init(&periodic, tw_count, &n_periodic, TWHEEL_ISR);
+    twheel_start(&periodic, 7 * TWHEEL_TICK_US, 7 * TWHEEL_TICK_US);
+    for(i = 0; i < 7 * 100 + 1; i++) {
+        host_timer_expire(0);
+    }
+    CHECK(n_periodic == 100);
+    CHECK(twheel_active(&periodic));
+    twheel_stop(&periodic);
+    CHECK(!twheel_active(&periodic));
+
+    // Sub-tick delays round up, restarting replaces the old expiry
+    twheel_timer_init(&restart, tw_count, &n_restart, TWHEEL_ISR);
+    twheel_start(&restart, 1, 0);
+    twheel_start(&restart, 5 * TWHEEL_TICK_US, 0);
+    for(i = 0; i < 5; i++) {
+        host_timer_expire(0);
+    }
+    CHECK(n_restart == 0);
+    host_timer_expire(0);
+    CHECK(n_restart == 1);
+    CHECK(!host_timer_expire(0));
+
+    // Deferred callbacks wait for twheel_poll, repeats coalesce
+    twheel_set_notify(tw_notify, NULL);
+    twheel_timer_init(&deferred, tw_count, &n_deferred, TWHEEL_DEFERRED);
+    twheel_start(&deferred, TWHEEL_TICK_US, TWHEEL_TICK_US);
+    for(i = 0; i < 10; i++) {
+        host_timer_expire(0);
+    }
+    CHECK(n_deferred == 0);
+    CHECK(tw_notified == 1);
+    CHECK(twheel_poll() == 1);
+    CHECK(n_deferred == 1);
+
+    // Stopping drops a callback that is already queued
+    host_timer_expire(0);
+    twheel_stop(&deferred);
+    CHECK(twheel_poll() == 0);
+    CHECK(n_deferred == 1);
+    twheel_set_notify(NULL, NULL);
+
+    // The tick that finds the wheel empty stops the timer
+    CHECK(host_timer_expire(0));
+    CHECK(!host_timer_expire(0));
+}
+
+static void bench_twheel_cost(void) {
+    const uint32_t n = 200000;
+    uint32_t i, count = 0, ticks = 0;
+    uint64_t start;
+
+    // Background load across all levels
+    for(i = 0; i < TW_TIMERS; i++) {
+        twheel_timer_init(&tw_timers[i], tw_count, &count, TWHEEL_ISR);
+        twheel_start(&tw_timers[i], (1 + i * 61) * TWHEEL_TICK_US, 0);
+    }
+
+    start = host_ns();
+    for(i = 0; i < n; i++) {
+        twheel_timer_t *t = &tw_timers[i & (TW_TIMERS - 1)];
+        twheel_start(t, (1 + (i & 0xFFFF)) * TWHEEL_TICK_US, 0);
+        twheel_stop(t);
+    }
+    report("twheel_start_stop", n, start);
+
+    for(i = 0; i < TW_TIMERS; i++) {
+        twheel_start(&tw_timers[i], (1 + i * 61) * TWHEEL_TICK_US, 0);
+    }
+    start = host_ns();
+    while(host_timer_expire(0)) {
+        ticks++;
+    }
+    report("twheel_tick_4k_timers", ticks, start);
+    CHECK(count == TW_TIMERS);
+}
+
+int main(void) {
+    bench_gpio_dispatch();
+    bench_gpio_dispatch_port();
+    bench_gpio_capture();
+    bench_gpio_commit();
+    bench_gpio_static();
+    bench_gpio_bus();
+    bench_uart();
+    bench_spi();
+    bench_adc();
+    bench_log();
+    bench_pool();
+    bench_dsp_vector();
+    bench_dsp_filters();
+    bench_dsp_fft();
+    bench_twheel_accuracy();
+    bench_twheel_modes();
+    bench_twheel_cost();
+
+    printf("%u failures\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,31 @@
+#ifndef __DRIVERLIB_ADC_H__
+#define __DRIVERLIB_ADC_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ADC_TRIGGER_TIMER   0x00000005
+
+#define ADC_CTL_END         0x00000020
+#define ADC_CTL_IE          0x00000040
+#define ADC_CTL_CH0         0x00000000
+
+void ADCSequenceConfigure(uint32_t base, uint32_t seq, uint32_t trigger, uint32_t priority);
+void ADCSequenceStepConfigure(uint32_t base, uint32_t seq, uint32_t step, uint32_t config);
+void ADCSequenceEnable(uint32_t base, uint32_t seq);
+void ADCSequenceDisable(uint32_t base, uint32_t seq);
+void ADCSequenceDMAEnable(uint32_t base, uint32_t seq);
+void ADCSequenceDMADisable(uint32_t base, uint32_t seq);
+int32_t ADCSequenceOverflow(uint32_t base, uint32_t seq);
+void ADCSequenceOverflowClear(uint32_t base, uint32_t seq);
+void ADCIntClear(uint32_t base, uint32_t seq);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
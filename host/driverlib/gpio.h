@@ -0,0 +1,52 @@
+#ifndef __DRIVERLIB_GPIO_H__
+#define __DRIVERLIB_GPIO_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define GPIO_PIN_0          0x00000001
+#define GPIO_PIN_1          0x00000002
+#define GPIO_PIN_2          0x00000004
+#define GPIO_PIN_3          0x00000008
+#define GPIO_PIN_4          0x00000010
+#define GPIO_PIN_5          0x00000020
+#define GPIO_PIN_6          0x00000040
+#define GPIO_PIN_7          0x00000080
+
+#define GPIO_FALLING_EDGE   0x00000000
+#define GPIO_RISING_EDGE    0x00000004
+#define GPIO_BOTH_EDGES     0x00000001
+#define GPIO_LOW_LEVEL      0x00000002
+#define GPIO_HIGH_LEVEL     0x00000006
+
+#define GPIO_STRENGTH_2MA   0x00000001
+#define GPIO_STRENGTH_4MA   0x00000002
+#define GPIO_STRENGTH_8MA   0x00000066
+#define GPIO_STRENGTH_8MA_SC 0x0000006E
+
+#define GPIO_PIN_TYPE_STD       0x00000008
+#define GPIO_PIN_TYPE_STD_WPU   0x0000000A
+#define GPIO_PIN_TYPE_STD_WPD   0x0000000C
+#define GPIO_PIN_TYPE_OD        0x00000009
+#define GPIO_PIN_TYPE_OD_WPU    0x0000000B
+#define GPIO_PIN_TYPE_OD_WPD    0x0000000D
+#define GPIO_PIN_TYPE_ANALOG    0x00000000
+
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t val);
+int32_t GPIOPinRead(uint32_t port, uint8_t pins);
+void GPIOPinIntEnable(uint32_t port, uint8_t pins);
+void GPIOPinIntDisable(uint32_t port, uint8_t pins);
+void GPIOPinIntClear(uint32_t port, uint8_t pins);
+void GPIOPinConfigure(uint32_t config);
+void GPIOPinTypeUART(uint32_t port, uint8_t pins);
+void GPIOPinTypeSSI(uint32_t port, uint8_t pins);
+void GPIOPinTypeADC(uint32_t port, uint8_t pins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
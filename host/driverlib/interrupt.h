@@ -0,0 +1,23 @@
+#ifndef __DRIVERLIB_INTERRUPT_H__
+#define __DRIVERLIB_INTERRUPT_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+bool IntMasterEnable(void);
+bool IntMasterDisable(void);
+void IntRegister(uint32_t interrupt, void (*handler)(void));
+void IntEnable(uint32_t interrupt);
+void IntDisable(uint32_t interrupt);
+void IntPendSet(uint32_t interrupt);
+void IntPrioritySet(uint32_t interrupt, uint8_t priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
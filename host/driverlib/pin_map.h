@@ -0,0 +1,16 @@
+#ifndef __DRIVERLIB_PIN_MAP_H__
+#define __DRIVERLIB_PIN_MAP_H__
+
+#define GPIO_PB0_U1RX       0x00010001
+#define GPIO_PB1_U1TX       0x00010401
+#define GPIO_PA2_SSI0CLK    0x00000802
+#define GPIO_PA4_SSI0RX     0x00001002
+#define GPIO_PA5_SSI0TX     0x00001402
+#define GPIO_PD0_SSI1CLK    0x00030002
+#define GPIO_PD2_SSI1RX     0x00030802
+#define GPIO_PD3_SSI1TX     0x00030C02
+#define GPIO_PB4_SSI2CLK    0x00011002
+#define GPIO_PB6_SSI2RX     0x00011802
+#define GPIO_PB7_SSI2TX     0x00011C02
+
+#endif
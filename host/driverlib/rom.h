@@ -0,0 +1,6 @@
+#ifndef __DRIVERLIB_ROM_H__
+#define __DRIVERLIB_ROM_H__
+
+// No ROM on the host; rom_map.h points every MAP_ call at the host model
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef __DRIVERLIB_ROM_MAP_H__
+#define __DRIVERLIB_ROM_MAP_H__
+
+// Every MAP_ call goes straight to the host model in host.c
+
+#define MAP_SysCtlPeripheralEnable          SysCtlPeripheralEnable
+#define MAP_SysCtlClockGet                  SysCtlClockGet
+#define MAP_IntMasterEnable                 IntMasterEnable
+#define MAP_IntMasterDisable                IntMasterDisable
+#define MAP_IntEnable                       IntEnable
+#define MAP_IntDisable                      IntDisable
+#define MAP_IntPendSet                      IntPendSet
+#define MAP_IntPrioritySet                  IntPrioritySet
+#define MAP_GPIOPinWrite                    GPIOPinWrite
+#define MAP_GPIOPinRead                     GPIOPinRead
+#define MAP_GPIOPinIntEnable                GPIOPinIntEnable
+#define MAP_GPIOPinIntDisable               GPIOPinIntDisable
+#define MAP_GPIOPinIntClear                 GPIOPinIntClear
+#define MAP_GPIOPinConfigure                GPIOPinConfigure
+#define MAP_GPIOPinTypeUART                 GPIOPinTypeUART
+#define MAP_GPIOPinTypeSSI                  GPIOPinTypeSSI
+#define MAP_GPIOPinTypeADC                  GPIOPinTypeADC
+#define MAP_ADCSequenceConfigure            ADCSequenceConfigure
+#define MAP_ADCSequenceStepConfigure        ADCSequenceStepConfigure
+#define MAP_ADCSequenceEnable               ADCSequenceEnable
+#define MAP_ADCSequenceDisable              ADCSequenceDisable
+#define MAP_ADCSequenceDMAEnable            ADCSequenceDMAEnable
+#define MAP_ADCSequenceDMADisable           ADCSequenceDMADisable
+#define MAP_ADCSequenceOverflow             ADCSequenceOverflow
+#define MAP_ADCSequenceOverflowClear        ADCSequenceOverflowClear
+#define MAP_ADCIntClear                     ADCIntClear
+#define MAP_UARTConfigSetExpClk             UARTConfigSetExpClk
+#define MAP_UARTFIFOLevelSet                UARTFIFOLevelSet
+#define MAP_UARTEnable                      UARTEnable
+#define MAP_UARTDMAEnable                   UARTDMAEnable
+#define MAP_UARTIntEnable                   UARTIntEnable
+#define MAP_UARTIntStatus                   UARTIntStatus
+#define MAP_UARTIntClear                    UARTIntClear
+#define MAP_UARTCharPut                     UARTCharPut
+#define MAP_UARTCharGetNonBlocking          UARTCharGetNonBlocking
+#define MAP_SSIConfigSetExpClk              SSIConfigSetExpClk
+#define MAP_SSIEnable                       SSIEnable
+#define MAP_SSIDisable                      SSIDisable
+#define MAP_SSIIntEnable                    SSIIntEnable
+#define MAP_SSIIntDisable                   SSIIntDisable
+#define MAP_SSIIntStatus                    SSIIntStatus
+#define MAP_SSIIntClear                     SSIIntClear
+#define MAP_TimerConfigure                  TimerConfigure
+#define MAP_TimerLoadSet                    TimerLoadSet
+#define MAP_TimerEnable                     TimerEnable
+#define MAP_TimerDisable                    TimerDisable
+#define MAP_TimerControlTrigger             TimerControlTrigger
+#define MAP_TimerIntEnable                  TimerIntEnable
+#define MAP_TimerIntDisable                 TimerIntDisable
+#define MAP_TimerIntClear                   TimerIntClear
+#define MAP_uDMAEnable                      uDMAEnable
+#define MAP_uDMAControlBaseSet              uDMAControlBaseSet
+#define MAP_uDMAChannelAssign               uDMAChannelAssign
+#define MAP_uDMAErrorStatusGet              uDMAErrorStatusGet
+#define MAP_uDMAErrorStatusClear            uDMAErrorStatusClear
+#define MAP_uDMAChannelAttributeEnable      uDMAChannelAttributeEnable
+#define MAP_uDMAChannelAttributeDisable     uDMAChannelAttributeDisable
+#define MAP_uDMAChannelControlSet           uDMAChannelControlSet
+#define MAP_uDMAChannelTransferSet          uDMAChannelTransferSet
+#define MAP_uDMAChannelEnable               uDMAChannelEnable
+#define MAP_uDMAChannelDisable              uDMAChannelDisable
+#define MAP_uDMAChannelIsEnabled            uDMAChannelIsEnabled
+#define MAP_uDMAChannelModeGet              uDMAChannelModeGet
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef __DRIVERLIB_SSI_H__
+#define __DRIVERLIB_SSI_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SSI_TXFF            0x00000008
+#define SSI_RXFF            0x00000004
+#define SSI_RXTO            0x00000002
+#define SSI_RXOR            0x00000001
+
+#define SSI_FRF_MOTO_MODE_0 0x00000000
+#define SSI_FRF_MOTO_MODE_1 0x00000002
+#define SSI_FRF_MOTO_MODE_2 0x00000001
+#define SSI_FRF_MOTO_MODE_3 0x00000003
+
+#define SSI_MODE_MASTER     0x00000000
+
+void SSIConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t protocol, uint32_t mode,
+                        uint32_t bit_rate, uint32_t width);
+void SSIEnable(uint32_t base);
+void SSIDisable(uint32_t base);
+void SSIIntEnable(uint32_t base, uint32_t flags);
+void SSIIntDisable(uint32_t base, uint32_t flags);
+uint32_t SSIIntStatus(uint32_t base, bool masked);
+void SSIIntClear(uint32_t base, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef __DRIVERLIB_SYSCTL_H__
+#define __DRIVERLIB_SYSCTL_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYSCTL_PERIPH_GPIOA 0xF0000800
+#define SYSCTL_PERIPH_GPIOB 0xF0000801
+#define SYSCTL_PERIPH_GPIOC 0xF0000802
+#define SYSCTL_PERIPH_GPIOD 0xF0000803
+#define SYSCTL_PERIPH_GPIOE 0xF0000804
+#define SYSCTL_PERIPH_GPIOF 0xF0000805
+#define SYSCTL_PERIPH_TIMER0 0xF0000400
+#define SYSCTL_PERIPH_TIMER1 0xF0000401
+#define SYSCTL_PERIPH_TIMER2 0xF0000402
+#define SYSCTL_PERIPH_TIMER3 0xF0000403
+#define SYSCTL_PERIPH_TIMER4 0xF0000404
+#define SYSCTL_PERIPH_TIMER5 0xF0000405
+#define SYSCTL_PERIPH_UDMA  0xF0000C00
+#define SYSCTL_PERIPH_UART0 0xF0001800
+#define SYSCTL_PERIPH_UART1 0xF0001801
+#define SYSCTL_PERIPH_SSI0  0xF0001C00
+#define SYSCTL_PERIPH_SSI1  0xF0001C01
+#define SYSCTL_PERIPH_SSI2  0xF0001C02
+#define SYSCTL_PERIPH_ADC0  0xF0003800
+#define SYSCTL_PERIPH_ADC1  0xF0003801
+
+void SysCtlPeripheralEnable(uint32_t peripheral);
+uint32_t SysCtlClockGet(void);
+void SysCtlDelay(uint32_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef __DRIVERLIB_TIMER_H__
+#define __DRIVERLIB_TIMER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_CFG_ONE_SHOT      0x00000021
+#define TIMER_CFG_PERIODIC      0x00000022
+
+#define TIMER_TIMA_TIMEOUT      0x00000001
+
+#define TIMER_A                 0x000000FF
+#define TIMER_B                 0x0000FF00
+#define TIMER_BOTH              0x0000FFFF
+
+void TimerConfigure(uint32_t base, uint32_t config);
+void TimerLoadSet(uint32_t base, uint32_t timer, uint32_t value);
+void TimerEnable(uint32_t base, uint32_t timer);
+void TimerDisable(uint32_t base, uint32_t timer);
+void TimerControlTrigger(uint32_t base, uint32_t timer, bool enable);
+void TimerIntEnable(uint32_t base, uint32_t flags);
+void TimerIntDisable(uint32_t base, uint32_t flags);
+void TimerIntClear(uint32_t base, uint32_t flags);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
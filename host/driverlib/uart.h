@@ -0,0 +1,39 @@
+#ifndef __DRIVERLIB_UART_H__
+#define __DRIVERLIB_UART_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UART_INT_RX         0x00000010
+#define UART_INT_TX         0x00000020
+#define UART_INT_RT         0x00000040
+
+#define UART_CONFIG_WLEN_8  0x00000060
+#define UART_CONFIG_STOP_ONE 0x00000000
+#define UART_CONFIG_PAR_NONE 0x00000000
+
+#define UART_FIFO_TX2_8     0x00000001
+#define UART_FIFO_RX4_8     0x00000010
+
+#define UART_DMA_RX         0x00000001
+#define UART_DMA_TX         0x00000002
+
+void UARTConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t baud, uint32_t config);
+void UARTFIFOLevelSet(uint32_t base, uint32_t tx_level, uint32_t rx_level);
+void UARTEnable(uint32_t base);
+void UARTDMAEnable(uint32_t base, uint32_t flags);
+void UARTIntEnable(uint32_t base, uint32_t flags);
+uint32_t UARTIntStatus(uint32_t base, bool masked);
+void UARTIntClear(uint32_t base, uint32_t flags);
+void UARTCharPut(uint32_t base, unsigned char data);
+int32_t UARTCharGetNonBlocking(uint32_t base);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+#ifndef __DRIVERLIB_UDMA_H__
+#define __DRIVERLIB_UDMA_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define UDMA_CHANNEL_ADC0       14
+#define UDMA_CHANNEL_UART1TX    23
+#define UDMA_SEC_CHANNEL_ADC10  24
+
+#define UDMA_CH10_SSI0RX        0x0000000A
+#define UDMA_CH11_SSI0TX        0x0000000B
+#define UDMA_CH12_SSI2RX        0x0002000C
+#define UDMA_CH13_SSI2TX        0x0002000D
+#define UDMA_CH24_SSI1RX        0x00000018
+#define UDMA_CH25_SSI1TX        0x00000019
+#define UDMA_CH24_ADC1_0        0x00010018
+
+#define UDMA_PRI_SELECT     0x00000000
+#define UDMA_ALT_SELECT     0x00000020
+
+#define UDMA_MODE_STOP      0x00000000
+#define UDMA_MODE_BASIC     0x00000001
+#define UDMA_MODE_PINGPONG  0x00000003
+
+#define UDMA_ATTR_USEBURST      0x00000001
+#define UDMA_ATTR_ALTSELECT     0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY 0x00000004
+#define UDMA_ATTR_REQMASK       0x00000008
+
+#define UDMA_SIZE_8         0x00000000
+#define UDMA_SIZE_16        0x11000000
+#define UDMA_SRC_INC_8      0x00000000
+#define UDMA_SRC_INC_16     0x04000000
+#define UDMA_SRC_INC_NONE   0x0C000000
+#define UDMA_DST_INC_8      0x00000000
+#define UDMA_DST_INC_16     0x40000000
+#define UDMA_DST_INC_NONE   0xC0000000
+#define UDMA_ARB_1          0x00000000
+#define UDMA_ARB_2          0x00004000
+#define UDMA_ARB_4          0x00008000
+#define UDMA_ARB_8          0x0000C000
+
+void uDMAEnable(void);
+void uDMAControlBaseSet(void *control_table);
+void uDMAChannelAssign(uint32_t mapping);
+uint32_t uDMAErrorStatusGet(void);
+void uDMAErrorStatusClear(void);
+void uDMAChannelAttributeEnable(uint32_t channel, uint32_t attr);
+void uDMAChannelAttributeDisable(uint32_t channel, uint32_t attr);
+void uDMAChannelControlSet(uint32_t channel, uint32_t control);
+void uDMAChannelTransferSet(uint32_t channel, uint32_t mode, void *src, void *dst, uint32_t count);
+void uDMAChannelEnable(uint32_t channel);
+void uDMAChannelDisable(uint32_t channel);
+bool uDMAChannelIsEnabled(uint32_t channel);
+uint32_t uDMAChannelModeGet(uint32_t channel);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
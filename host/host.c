@@ -0,0 +1,1437 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <time.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_gpio.h>
+#include <inc/hw_uart.h>
+#include <inc/hw_ssi.h>
+#include <inc/hw_timer.h>
+#include <inc/hw_adc.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/uart.h>
+#include <driverlib/ssi.h>
+#include <driverlib/timer.h>
+#include <driverlib/adc.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "host.h"
+
+// HWREG slots. Enough that a handler run between taking a pointer and
+// using it cannot wrap around onto it
+#define HOST_SLOTS          64
+
+// Unwritten slots older than this many accesses are assumed to be reads
+#define HOST_SLOT_WINDOW    4
+
+#define HOST_NUM_PORTS      6
+#define HOST_REG_WORDS      (0x1000 / 4)
+
+#define HOST_UART_FIFO      16
+#define HOST_UART_CAPTURE   65536
+
+// Marks a DR read, so a slot that still holds it was not written
+#define HOST_UART_DR_READ   0xDEAD0000
+
+#define HOST_NUM_SSI        3
+#define HOST_SSI_FIFO       8
+#define HOST_SSI_CAPTURE    4096
+
+#define HOST_NUM_ADC        2
+#define HOST_ADC_FIFO       8
+
+#define HOST_DMA_CHANNELS   32
+
+#define HOST_NUM_TIMERS     6
+
+typedef struct {
+    uint32_t addr;
+    uint32_t read;              // value the register read as
+    volatile uint32_t value;    // what the driver left behind
+} host_slot_t;
+
+typedef struct {
+    uint32_t regs[HOST_REG_WORDS];
+    uint8_t out;                // GPIODATA as written
+    uint8_t in;                 // external level of the pins
+    uint8_t level;              // level seen by the edge detector
+} host_gpio_t;
+
+typedef struct {
+    uint32_t regs[HOST_REG_WORDS];
+    char rx[HOST_UART_FIFO];
+    uint32_t rx_head, rx_tail;
+    char tx[HOST_UART_FIFO];
+    uint32_t tx_len;
+    bool dma_done;
+} host_uart_t;
+
+typedef struct {
+    uint32_t regs[HOST_REG_WORDS];
+    uint16_t rx[HOST_SSI_FIFO];
+    uint32_t rx_head, rx_tail;
+    uint16_t sent[HOST_SSI_CAPTURE];
+    uint64_t sent_head, sent_tail;
+    uint32_t dma_runs;
+    bool dma_done;
+} host_ssi_t;
+
+typedef struct {
+    uint32_t regs[HOST_REG_WORDS];
+} host_timer_t;
+
+typedef struct {
+    uint32_t regs[HOST_REG_WORDS];
+    uint16_t fifo[HOST_ADC_FIFO];
+    uint32_t fifo_head, fifo_tail;
+    uint32_t steps;             // conversions per trigger
+    uint32_t sample;            // next conversion result
+    bool dma_done;
+} host_adc_t;
+
+typedef struct {
+    uint8_t *src;
+    uint8_t *dst;
+    uint32_t control;
+    uint32_t mode;
+    uint32_t count;
+} host_dma_ctl_t;
+
+typedef struct {
+    host_dma_ctl_t ctl[2];      // primary and alternate structures
+    bool alt;                   // the alternate one is in use
+    bool enabled;
+} host_dma_t;
+
+static host_slot_t host_slots[HOST_SLOTS];
+static uint64_t host_slot_pending;
+static uint32_t host_slot_next;
+static uint64_t host_reg_stores;
+static uint64_t host_reg_loads;
+static uint64_t host_reg_count;
+
+static host_gpio_t host_gpio[HOST_NUM_PORTS];
+static host_uart_t host_uart1;
+static uint32_t host_uart_dmactl;
+static host_ssi_t host_ssi[HOST_NUM_SSI];
+static host_adc_t host_adc[HOST_NUM_ADC];
+static host_dma_t host_dma[HOST_DMA_CHANNELS];
+static host_timer_t host_timer[HOST_NUM_TIMERS];
+
+static char host_capture[HOST_UART_CAPTURE];
+static uint64_t host_capture_head, host_capture_tail;
+
+static uint32_t host_primask;
+static uint32_t host_active;
+static bool host_delivering;
+
+#define HOST_IRQ_WORDS      ((NUM_INTERRUPTS + 31) / 32)
+
+static uint32_t host_irq_enabled[HOST_IRQ_WORDS];
+static uint32_t host_irq_pending[HOST_IRQ_WORDS];
+static void (*host_irq_handler[NUM_INTERRUPTS])(void);
+
+static const uint32_t host_gpio_base[HOST_NUM_PORTS] = {
+    GPIO_PORTA_BASE, GPIO_PORTB_BASE, GPIO_PORTC_BASE,
+    GPIO_PORTD_BASE, GPIO_PORTE_BASE, GPIO_PORTF_BASE,
+};
+
+static const uint32_t host_gpio_int[HOST_NUM_PORTS] = {
+    INT_GPIOA, INT_GPIOB, INT_GPIOC, INT_GPIOD, INT_GPIOE, INT_GPIOF,
+};
+
+static const uint32_t host_ssi_base[HOST_NUM_SSI] = {
+    SSI0_BASE, SSI1_BASE, SSI2_BASE,
+};
+
+static const uint32_t host_ssi_int[HOST_NUM_SSI] = {
+    INT_SSI0, INT_SSI1, INT_SSI2,
+};
+
+// uDMA channels each SSI requests on, receive then transmit
+static const uint8_t host_ssi_dma[HOST_NUM_SSI][2] = {
+    {10, 11}, {24, 25}, {12, 13},
+};
+
+static const uint32_t host_adc_base[HOST_NUM_ADC] = {
+    ADC0_BASE, ADC1_BASE,
+};
+
+static const uint32_t host_adc_int[HOST_NUM_ADC] = {
+    INT_ADC0SS0, INT_ADC1SS0,
+};
+
+// uDMA channel of sequencer 0, ADC1 on its secondary mapping
+static const uint8_t host_adc_dma[HOST_NUM_ADC] = {
+    14, 24,
+};
+
+static const uint32_t host_timer_base[HOST_NUM_TIMERS] = {
+    TIMER0_BASE, TIMER1_BASE, TIMER2_BASE, TIMER3_BASE, TIMER4_BASE, TIMER5_BASE,
+};
+
+static const uint32_t host_timer_int[HOST_NUM_TIMERS] = {
+    INT_TIMER0A, INT_TIMER1A, INT_TIMER2A, INT_TIMER3A, INT_TIMER4A, INT_TIMER5A,
+};
+
+// The same handlers nvic_table binds, when they are linked in
+extern void gpio_port_a_handler(void) __weak;
+extern void gpio_port_b_handler(void) __weak;
+extern void gpio_port_c_handler(void) __weak;
+extern void gpio_port_d_handler(void) __weak;
+extern void gpio_port_e_handler(void) __weak;
+extern void gpio_port_f_handler(void) __weak;
+extern void uart1_handler(void) __weak;
+extern void ssi0_handler(void) __weak;
+extern void ssi1_handler(void) __weak;
+extern void ssi2_handler(void) __weak;
+extern void adc0_seq0_handler(void) __weak;
+extern void adc1_seq0_handler(void) __weak;
+extern void timer0a_handler(void) __weak;
+extern void timer1a_handler(void) __weak;
+extern void timer2a_handler(void) __weak;
+extern void timer3a_handler(void) __weak;
+extern void timer4a_handler(void) __weak;
+extern void timer5a_handler(void) __weak;
+extern void udma_error_handler(void) __weak;
+
+static void (*host_default_handler(uint32_t irq))(void) {
+    switch(irq) {
+        case INT_GPIOA:   return gpio_port_a_handler;
+        case INT_GPIOB:   return gpio_port_b_handler;
+        case INT_GPIOC:   return gpio_port_c_handler;
+        case INT_GPIOD:   return gpio_port_d_handler;
+        case INT_GPIOE:   return gpio_port_e_handler;
+        case INT_GPIOF:   return gpio_port_f_handler;
+        case INT_UART1:   return uart1_handler;
+        case INT_SSI0:    return ssi0_handler;
+        case INT_SSI1:    return ssi1_handler;
+        case INT_SSI2:    return ssi2_handler;
+        case INT_ADC0SS0: return adc0_seq0_handler;
+        case INT_ADC1SS0: return adc1_seq0_handler;
+        case INT_TIMER0A: return timer0a_handler;
+        case INT_TIMER1A: return timer1a_handler;
+        case INT_TIMER2A: return timer2a_handler;
+        case INT_TIMER3A: return timer3a_handler;
+        case INT_TIMER4A: return timer4a_handler;
+        case INT_TIMER5A: return timer5a_handler;
+        case INT_UDMAERR: return udma_error_handler;
+        default:          return 0;
+    }
+}
+
+//
+// GPIO
+//
+
+static host_gpio_t *host_gpio_port(uint32_t addr) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_PORTS; i++) {
+        if((addr & ~0xFFF) == host_gpio_base[i]) {
+            return &host_gpio[i];
+        }
+    }
+    return 0;
+}
+
+static uint8_t host_gpio_pins(host_gpio_t *gpio) {
+    uint8_t dir = gpio->regs[GPIO_O_DIR / 4];
+    return (gpio->out & dir) | (gpio->in & ~dir);
+}
+
+// Latch interrupts for the current pin levels, the way the pad edge and
+// level detectors would
+static void host_gpio_update(host_gpio_t *gpio) {
+    uint8_t old  = gpio->level;
+    uint8_t now  = host_gpio_pins(gpio);
+    uint8_t is   = gpio->regs[GPIO_O_IS / 4];
+    uint8_t ibe  = gpio->regs[GPIO_O_IBE / 4];
+    uint8_t iev  = gpio->regs[GPIO_O_IEV / 4];
+    uint8_t rise = now & ~old;
+    uint8_t fall = old & ~now;
+    uint8_t edge;
+
+    edge = (ibe & (rise | fall)) | (~ibe & iev & rise) | (~ibe & ~iev & fall);
+
+    gpio->regs[GPIO_O_RIS / 4] |= (edge & ~is) | (is & ~(now ^ iev));
+    gpio->level = now;
+}
+
+static uint32_t host_gpio_read(host_gpio_t *gpio, uint32_t off) {
+    if(off < GPIO_O_DIR) {
+        return host_gpio_pins(gpio) & (off >> 2);
+    }
+
+    switch(off) {
+        case GPIO_O_MIS: return gpio->regs[GPIO_O_RIS / 4] & gpio->regs[GPIO_O_IM / 4];
+        case GPIO_O_ICR: return 0;
+        default:         return gpio->regs[off / 4];
+    }
+}
+
+static void host_gpio_write(host_gpio_t *gpio, uint32_t off, uint32_t value) {
+    if(off < GPIO_O_DIR) {
+        uint8_t mask = off >> 2;
+        gpio->out = (gpio->out & ~mask) | (value & mask);
+    } else if(off == GPIO_O_ICR) {
+        gpio->regs[GPIO_O_RIS / 4] &= ~value;
+    } else if(off != GPIO_O_RIS && off != GPIO_O_MIS) {
+        gpio->regs[off / 4] = value & 0xFF;
+    }
+
+    host_gpio_update(gpio);
+}
+
+//
+// UART1
+//
+
+static uint32_t host_uart_rx_count(void) {
+    return host_uart1.rx_head - host_uart1.rx_tail;
+}
+
+static void host_capture_put(const char *data, uint32_t len) {
+    while(len--) {
+        host_capture[host_capture_head++ & (HOST_UART_CAPTURE - 1)] = *data++;
+    }
+
+    // Keep only the most recent bytes
+    if(host_capture_head - host_capture_tail > HOST_UART_CAPTURE) {
+        host_capture_tail = host_capture_head - HOST_UART_CAPTURE;
+    }
+}
+
+// Shift the TX FIFO out. Happens at every sync point, so the FIFO is
+// always empty by the time the next interrupt can run
+static void host_uart_drain(void) {
+    if(host_uart1.tx_len) {
+        host_capture_put(host_uart1.tx, host_uart1.tx_len);
+        host_uart1.tx_len = 0;
+        host_uart1.regs[UART_O_RIS / 4] |= UART_INT_TX;
+    }
+
+    // Receive timeout fires as soon as anything is left in the RX FIFO
+    if(host_uart_rx_count() >= HOST_UART_FIFO / 2) {
+        host_uart1.regs[UART_O_RIS / 4] |= UART_INT_RX;
+    }
+    if(host_uart_rx_count()) {
+        host_uart1.regs[UART_O_RIS / 4] |= UART_INT_RT;
+    }
+}
+
+static void host_uart_tx_put(char c) {
+    if(host_uart1.tx_len == HOST_UART_FIFO) {
+        host_uart_drain();
+    }
+    host_uart1.tx[host_uart1.tx_len++] = c;
+}
+
+static int32_t host_uart_rx_get(void) {
+    if(host_uart_rx_count() == 0) {
+        return -1;
+    }
+    return (uint8_t)host_uart1.rx[host_uart1.rx_tail++ & (HOST_UART_FIFO - 1)];
+}
+
+static uint32_t host_uart_read(uint32_t off) {
+    uint32_t fr = 0;
+
+    switch(off) {
+        case UART_O_DR:
+            if(host_uart_rx_count() == 0) {
+                return HOST_UART_DR_READ;
+            }
+            return HOST_UART_DR_READ | (uint8_t)host_uart1.rx[host_uart1.rx_tail & (HOST_UART_FIFO - 1)];
+
+        case UART_O_FR:
+            fr |= host_uart_rx_count() ? 0 : UART_FR_RXFE;
+            fr |= host_uart_rx_count() == HOST_UART_FIFO ? UART_FR_RXFF : 0;
+            fr |= host_uart1.tx_len ? 0 : UART_FR_TXFE;
+            fr |= host_uart1.tx_len == HOST_UART_FIFO ? UART_FR_TXFF : 0;
+            return fr;
+
+        case UART_O_MIS:
+            return host_uart1.regs[UART_O_RIS / 4] & host_uart1.regs[UART_O_IM / 4];
+
+        case UART_O_ICR:
+            return 0;
+
+        default:
+            return host_uart1.regs[off / 4];
+    }
+}
+
+static void host_uart_write(uint32_t off, uint32_t value) {
+    switch(off) {
+        case UART_O_DR:
+            host_uart_tx_put((char)value);
+            break;
+
+        case UART_O_ICR:
+            host_uart1.regs[UART_O_RIS / 4] &= ~value;
+            break;
+
+        case UART_O_FR:
+        case UART_O_RIS:
+        case UART_O_MIS:
+            break;
+
+        default:
+            host_uart1.regs[off / 4] = value;
+            break;
+    }
+}
+
+//
+// uDMA. Channels move words between memory and a peripheral register
+// when the peripheral asks, in the unit size and increments of their
+// control word
+//
+
+// Structure the next unit moves through, NULL if the channel is off. A
+// channel that comes to a stopped structure turns itself off
+static host_dma_ctl_t *host_dma_active(host_dma_t *dma) {
+    host_dma_ctl_t *ctl = &dma->ctl[dma->alt];
+
+    if(dma->enabled && (ctl->mode == UDMA_MODE_STOP || !ctl->count)) {
+        dma->enabled = false;
+    }
+    return dma->enabled ? ctl : 0;
+}
+
+// Count off one unit. Returns true if that ended the transfer: ping-pong
+// goes on to the other structure, anything else turns the channel off
+static bool host_dma_done(host_dma_t *dma, host_dma_ctl_t *ctl) {
+    uint32_t mode = ctl->mode;
+
+    if(--ctl->count) {
+        return false;
+    }
+
+    ctl->mode = UDMA_MODE_STOP;
+    if(mode == UDMA_MODE_PINGPONG) {
+        dma->alt ^= 1;
+        if(dma->ctl[dma->alt].mode == UDMA_MODE_STOP) {
+            dma->enabled = false;
+        }
+    } else {
+        dma->enabled = false;
+    }
+    return true;
+}
+
+static uint32_t host_dma_get(host_dma_ctl_t *ctl) {
+    uint32_t word = 0;
+    uint32_t inc = (ctl->control >> 26) & 3;
+
+    memcpy(&word, ctl->src, 1 << ((ctl->control >> 24) & 3));
+    if(inc != 3) {
+        ctl->src += 1 << inc;
+    }
+    return word;
+}
+
+static void host_dma_put(host_dma_ctl_t *ctl, uint32_t word) {
+    uint32_t inc = (ctl->control >> 30) & 3;
+
+    memcpy(ctl->dst, &word, 1 << ((ctl->control >> 28) & 3));
+    if(inc != 3) {
+        ctl->dst += 1 << inc;
+    }
+}
+
+//
+// SSI0-2 as masters. MISO is tied to MOSI, every word sent comes straight
+// back in, and a whole uDMA transfer goes out at once
+//
+
+static host_ssi_t *host_ssi_get(uint32_t addr) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_SSI; i++) {
+        if((addr & ~0xFFF) == host_ssi_base[i]) {
+            return &host_ssi[i];
+        }
+    }
+    return 0;
+}
+
+static uint32_t host_ssi_rx_count(host_ssi_t *ssi) {
+    return ssi->rx_head - ssi->rx_tail;
+}
+
+// Shift one word out and the echo in. The receive side goes to uDMA if it
+// is asking for it, otherwise to the FIFO, which drops it when full
+static void host_ssi_shift(host_ssi_t *ssi, host_dma_t *rx, uint32_t word) {
+    host_dma_ctl_t *ctl = 0;
+
+    word &= (2u << (ssi->regs[SSI_O_CR0 / 4] & SSI_CR0_DSS_M)) - 1;
+
+    ssi->sent[ssi->sent_head++ & (HOST_SSI_CAPTURE - 1)] = word;
+    if(ssi->sent_head - ssi->sent_tail > HOST_SSI_CAPTURE) {
+        ssi->sent_tail = ssi->sent_head - HOST_SSI_CAPTURE;
+    }
+
+    if(rx && (ssi->regs[SSI_O_DMACTL / 4] & SSI_DMACTL_RXDMAE)) {
+        ctl = host_dma_active(rx);
+    }
+
+    if(ctl) {
+        host_dma_put(ctl, word);
+        host_dma_done(rx, ctl);
+    } else if(host_ssi_rx_count(ssi) == HOST_SSI_FIFO) {
+        ssi->regs[SSI_O_RIS / 4] |= SSI_RXOR;
+    } else {
+        ssi->rx[ssi->rx_head++ & (HOST_SSI_FIFO - 1)] = word;
+    }
+}
+
+// Run the TX channel dry once the SSI is enabled and requesting it. Either
+// channel finishing interrupts on the SSI vector
+static void host_ssi_run(host_ssi_t *ssi) {
+    uint32_t n = ssi - host_ssi;
+    host_dma_t *rx = &host_dma[host_ssi_dma[n][0]];
+    host_dma_t *tx = &host_dma[host_ssi_dma[n][1]];
+    host_dma_ctl_t *ctl;
+
+    if(!(ssi->regs[SSI_O_CR1 / 4] & SSI_CR1_SSE) || !(ssi->regs[SSI_O_DMACTL / 4] & SSI_DMACTL_TXDMAE)) {
+        return;
+    }
+
+    while((ctl = host_dma_active(tx))) {
+        host_ssi_shift(ssi, rx, host_dma_get(ctl));
+        if(host_dma_done(tx, ctl)) {
+            ssi->dma_runs++;
+            ssi->dma_done = true;
+        }
+    }
+}
+
+static uint32_t host_ssi_read(host_ssi_t *ssi, uint32_t off) {
+    uint32_t sr = SSI_SR_TFE | SSI_SR_TNF;
+
+    switch(off) {
+        case SSI_O_DR:
+            return ssi->rx[ssi->rx_tail & (HOST_SSI_FIFO - 1)];
+
+        case SSI_O_SR:
+            sr |= host_ssi_rx_count(ssi) ? SSI_SR_RNE : 0;
+            sr |= host_ssi_rx_count(ssi) == HOST_SSI_FIFO ? SSI_SR_RFF : 0;
+            return sr;
+
+        // The TX FIFO is always empty, and with EOT set that is also the
+        // end of transmission
+        case SSI_O_RIS:
+            return ssi->regs[SSI_O_RIS / 4] | SSI_TXFF;
+
+        case SSI_O_MIS:
+            return (ssi->regs[SSI_O_RIS / 4] | SSI_TXFF) & ssi->regs[SSI_O_IM / 4];
+
+        case SSI_O_ICR:
+            return 0;
+
+        default:
+            return ssi->regs[off / 4];
+    }
+}
+
+static void host_ssi_write(host_ssi_t *ssi, uint32_t off, uint32_t value) {
+    switch(off) {
+        case SSI_O_DR:
+            host_ssi_shift(ssi, 0, value);
+            break;
+
+        case SSI_O_ICR:
+            ssi->regs[SSI_O_RIS / 4] &= ~(value & (SSI_RXOR | SSI_RXTO));
+            break;
+
+        case SSI_O_SR:
+        case SSI_O_RIS:
+        case SSI_O_MIS:
+            break;
+
+        default:
+            ssi->regs[off / 4] = value;
+            host_ssi_run(ssi);
+            break;
+    }
+}
+
+//
+// ADC0-1 sequencer 0. Each trigger converts every step, the results count
+// up by one so the bench can tell which were lost. With uDMA enabled the
+// end of the frame moves the FIFO out; a full FIFO drops the conversion
+// and flags the overflow
+//
+
+static host_adc_t *host_adc_get(uint32_t addr) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_ADC; i++) {
+        if((addr & ~0xFFF) == host_adc_base[i]) {
+            return &host_adc[i];
+        }
+    }
+    return 0;
+}
+
+// The uDMA request stays up while the FIFO holds samples, so a channel
+// enabled since the last frame empties it first
+static void host_adc_drain(host_adc_t *adc) {
+    host_dma_t *dma = &host_dma[host_adc_dma[adc - host_adc]];
+    host_dma_ctl_t *ctl;
+
+    if(!(adc->regs[ADC_O_ACTSS / 4] & ADC_ACTSS_ADEN0)) {
+        return;
+    }
+    while(adc->fifo_head != adc->fifo_tail && (ctl = host_dma_active(dma))) {
+        host_dma_put(ctl, adc->fifo[adc->fifo_tail++ & (HOST_ADC_FIFO - 1)]);
+        if(host_dma_done(dma, ctl)) {
+            adc->dma_done = true;
+        }
+    }
+}
+
+static void host_adc_frame(host_adc_t *adc) {
+    uint32_t i;
+
+    host_adc_drain(adc);
+    for(i = 0; i < adc->steps; i++) {
+        if(adc->fifo_head - adc->fifo_tail == HOST_ADC_FIFO) {
+            adc->regs[ADC_O_OSTAT / 4] |= ADC_OSTAT_OV0;
+        } else {
+            adc->fifo[adc->fifo_head++ & (HOST_ADC_FIFO - 1)] = adc->sample & 0xFFF;
+        }
+        adc->sample++;
+    }
+    host_adc_drain(adc);
+}
+
+// Sequencers set to the timer trigger that are running
+static void host_adc_trigger(void) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_ADC; i++) {
+        if((host_adc[i].regs[ADC_O_ACTSS / 4] & ADC_ACTSS_ASEN0) &&
+           (host_adc[i].regs[ADC_O_EMUX / 4] & ADC_EMUX_EM0_M) == ADC_TRIGGER_TIMER) {
+            host_adc_frame(&host_adc[i]);
+        }
+    }
+}
+
+static uint32_t host_adc_read(host_adc_t *adc, uint32_t off) {
+    switch(off) {
+        case ADC_O_SSFIFO0:
+            return adc->fifo[adc->fifo_tail & (HOST_ADC_FIFO - 1)];
+
+        default:
+            return adc->regs[off / 4];
+    }
+}
+
+static void host_adc_write(host_adc_t *adc, uint32_t off, uint32_t value) {
+    switch(off) {
+        case ADC_O_OSTAT:
+        case ADC_O_ISC:
+            adc->regs[off / 4] &= ~value;
+            break;
+
+        case ADC_O_SSFIFO0:
+            break;
+
+        default:
+            adc->regs[off / 4] = value;
+            break;
+    }
+}
+
+//
+// Timers. Only the A half's timeout is modelled; time passes when the
+// bench calls host_timer_expire()
+//
+
+static host_timer_t *host_timer_get(uint32_t addr) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_TIMERS; i++) {
+        if((addr & ~0xFFF) == host_timer_base[i]) {
+            return &host_timer[i];
+        }
+    }
+    return 0;
+}
+
+static uint32_t host_timer_read(host_timer_t *timer, uint32_t off) {
+    switch(off) {
+        case TIMER_O_MIS:
+            return timer->regs[TIMER_O_RIS / 4] & timer->regs[TIMER_O_IMR / 4];
+
+        case TIMER_O_ICR:
+            return 0;
+
+        default:
+            return timer->regs[off / 4];
+    }
+}
+
+static void host_timer_write(host_timer_t *timer, uint32_t off, uint32_t value) {
+    switch(off) {
+        case TIMER_O_ICR:
+            timer->regs[TIMER_O_RIS / 4] &= ~value;
+            break;
+
+        case TIMER_O_RIS:
+        case TIMER_O_MIS:
+            break;
+
+        default:
+            timer->regs[off / 4] = value;
+            break;
+    }
+}
+
+//
+// Register access
+//
+
+static uint32_t host_reg_read(uint32_t addr) {
+    host_gpio_t *gpio = host_gpio_port(addr);
+    host_ssi_t *ssi;
+    host_adc_t *adc;
+    host_timer_t *timer;
+
+    if(gpio) {
+        return host_gpio_read(gpio, addr & 0xFFF);
+    }
+    if((addr & ~0xFFF) == UART1_BASE) {
+        return host_uart_read(addr & 0xFFF);
+    }
+    if((ssi = host_ssi_get(addr))) {
+        return host_ssi_read(ssi, addr & 0xFFF);
+    }
+    if((adc = host_adc_get(addr))) {
+        return host_adc_read(adc, addr & 0xFFF);
+    }
+    if((timer = host_timer_get(addr))) {
+        return host_timer_read(timer, addr & 0xFFF);
+    }
+    return 0;
+}
+
+static void host_reg_write(uint32_t addr, uint32_t value) {
+    host_gpio_t *gpio = host_gpio_port(addr);
+    host_ssi_t *ssi;
+    host_adc_t *adc;
+    host_timer_t *timer;
+
+    if(gpio) {
+        host_gpio_write(gpio, addr & 0xFFF, value);
+    } else if((addr & ~0xFFF) == UART1_BASE) {
+        host_uart_write(addr & 0xFFF, value);
+    } else if((ssi = host_ssi_get(addr))) {
+        host_ssi_write(ssi, addr & 0xFFF, value);
+    } else if((adc = host_adc_get(addr))) {
+        host_adc_write(adc, addr & 0xFFF, value);
+    } else if((timer = host_timer_get(addr))) {
+        host_timer_write(timer, addr & 0xFFF, value);
+    }
+}
+
+// Apply writes left in the slots. A slot still holding its read value may
+// yet be stored to, so it stays pending unless reading it had a side effect
+static void host_commit(void) {
+    uint64_t pending = host_slot_pending;
+    host_ssi_t *ssi;
+
+    while(pending) {
+        uint32_t i = __builtin_ctzll(pending);
+        host_slot_t *slot = &host_slots[i];
+        pending &= pending - 1;
+
+        if(slot->value != slot->read) {
+            host_reg_write(slot->addr, slot->value);
+            host_reg_stores++;
+        } else if(slot->addr == UART1_BASE + UART_O_DR) {
+            host_uart_rx_get();
+        } else if((slot->addr & 0xFFF) == SSI_O_DR && (ssi = host_ssi_get(slot->addr))) {
+            if(host_ssi_rx_count(ssi)) {
+                ssi->rx_tail++;
+            }
+        } else {
+            continue;
+        }
+        host_slot_pending &= ~(1ULL << i);
+    }
+}
+
+volatile uint32_t *host_reg(uint32_t addr) {
+    uint32_t i = host_slot_next++ & (HOST_SLOTS - 1);
+    host_slot_t *slot = &host_slots[i];
+
+    host_commit();
+    host_reg_count++;
+
+    // Drop the slot leaving the window
+    host_slot_pending &= ~(1ULL << ((i - HOST_SLOT_WINDOW) & (HOST_SLOTS - 1)));
+
+    slot->addr  = addr;
+    slot->read  = host_reg_read(addr);
+    slot->value = slot->read;
+    host_slot_pending |= 1ULL << i;
+
+    return &slot->value;
+}
+
+uint32_t host_reg_load(volatile uint32_t *reg) {
+    host_reg_loads++;
+    return *reg;
+}
+
+// Stores straight through, so the same value stored again is seen too. The
+// slot is done with, a DR slot must not be taken for a read afterwards
+void host_reg_store(volatile uint32_t *reg, uint32_t value) {
+    host_slot_t *slot = (host_slot_t *)((uintptr_t)reg - offsetof(host_slot_t, value));
+
+    host_commit();
+    host_reg_write(slot->addr, value);
+    host_reg_stores++;
+    slot->read  = value;
+    slot->value = value;
+    host_slot_pending &= ~(1ULL << (slot - host_slots));
+}
+
+//
+// Interrupts
+//
+
+static void host_irq_pend(uint32_t irq) {
+    host_irq_pending[irq / 32] |= 1 << (irq % 32);
+}
+
+// Lowest numbered interrupt that is both pending and enabled
+static uint32_t host_irq_next(void) {
+    uint32_t i, ready;
+
+    for(i = 0; i < HOST_IRQ_WORDS; i++) {
+        ready = host_irq_pending[i] & host_irq_enabled[i];
+        if(ready) {
+            return i * 32 + __ctz(ready);
+        }
+    }
+    return NUM_INTERRUPTS;
+}
+
+// Peripheral interrupt lines stay asserted until the source is cleared, so
+// an interrupt is pended again after its handler if it still is
+static void host_irq_lines(void) {
+    uint32_t i;
+
+    for(i = 0; i < HOST_NUM_PORTS; i++) {
+        if(host_gpio[i].regs[GPIO_O_RIS / 4] & host_gpio[i].regs[GPIO_O_IM / 4]) {
+            host_irq_pend(host_gpio_int[i]);
+        }
+    }
+
+    for(i = 0; i < HOST_NUM_TIMERS; i++) {
+        if(host_timer[i].regs[TIMER_O_RIS / 4] & host_timer[i].regs[TIMER_O_IMR / 4]) {
+            host_irq_pend(host_timer_int[i]);
+        }
+    }
+
+    for(i = 0; i < HOST_NUM_ADC; i++) {
+        if(host_adc[i].dma_done) {
+            host_irq_pend(host_adc_int[i]);
+            host_adc[i].dma_done = false;
+        }
+    }
+
+    for(i = 0; i < HOST_NUM_SSI; i++) {
+        if((host_ssi_read(&host_ssi[i], SSI_O_MIS)) || host_ssi[i].dma_done) {
+            host_irq_pend(host_ssi_int[i]);
+            host_ssi[i].dma_done = false;
+        }
+    }
+
+    if((host_uart1.regs[UART_O_RIS / 4] & host_uart1.regs[UART_O_IM / 4]) || host_uart1.dma_done) {
+        host_irq_pend(INT_UART1);
+        host_uart1.dma_done = false;
+    }
+}
+
+static void host_deliver(void) {
+    uint32_t irq;
+    void (*handler)(void);
+
+    if(host_delivering) {
+        return;
+    }
+    host_delivering = true;
+
+    // Lowest numbered first, one at a time
+    for(;;) {
+        host_irq_lines();
+
+        if(host_primask || host_active) {
+            break;
+        }
+
+        irq = host_irq_next();
+        if(irq == NUM_INTERRUPTS) {
+            break;
+        }
+
+        host_irq_pending[irq / 32] &= ~(1 << (irq % 32));
+
+        handler = host_irq_handler[irq] ? host_irq_handler[irq] : host_default_handler(irq);
+        if(handler) {
+            host_active = irq;
+            handler();
+            host_commit();
+            host_slot_pending = 0;
+            host_uart_drain();
+            host_active = 0;
+        }
+    }
+
+    host_delivering = false;
+}
+
+void host_sync(void) {
+    host_commit();
+    host_slot_pending = 0;
+    host_uart_drain();
+    host_deliver();
+}
+
+uint64_t host_reg_accesses(void) {
+    return host_reg_count;
+}
+
+uint64_t host_reg_reads(void) {
+    return host_reg_loads;
+}
+
+uint64_t host_reg_writes(void) {
+    host_commit();
+    return host_reg_stores;
+}
+
+uint32_t host_in_isr(void) {
+    return host_active;
+}
+
+uint32_t host_irq_save(void) {
+    uint32_t primask = host_primask;
+    host_primask = 1;
+    return primask;
+}
+
+void host_irq_restore(uint32_t primask) {
+    host_primask = primask;
+    host_sync();
+}
+
+uint64_t host_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//
+// Test bench side
+//
+
+void host_gpio_input(uint32_t port, uint8_t pins, uint8_t level) {
+    host_gpio_t *gpio = &host_gpio[port];
+
+    host_commit();
+    gpio->in = (gpio->in & ~pins) | (level & pins);
+    host_gpio_update(gpio);
+    host_sync();
+}
+
+uint8_t host_gpio_level(uint32_t port) {
+    host_sync();
+    return host_gpio_pins(&host_gpio[port]);
+}
+
+uint32_t host_uart_rx(const char *data, uint32_t len) {
+    uint32_t n = 0;
+
+    host_commit();
+    while(n < len && host_uart_rx_count() < HOST_UART_FIFO) {
+        host_uart1.rx[host_uart1.rx_head++ & (HOST_UART_FIFO - 1)] = data[n++];
+    }
+    host_sync();
+
+    return n;
+}
+
+bool host_timer_expire(uint32_t n) {
+    host_timer_t *timer = &host_timer[n];
+
+    host_commit();
+
+    if(!(timer->regs[TIMER_O_CTL / 4] & TIMER_CTL_TAEN)) {
+        return false;
+    }
+
+    timer->regs[TIMER_O_RIS / 4] |= TIMER_TIMA_TIMEOUT;
+    timer->regs[TIMER_O_TAV / 4] = timer->regs[TIMER_O_TAILR / 4];
+    if((timer->regs[TIMER_O_TAMR / 4] & TIMER_TAMR_TAMR_M) == TIMER_TAMR_TAMR_1_SHOT) {
+        timer->regs[TIMER_O_CTL / 4] &= ~TIMER_CTL_TAEN;
+    }
+    if(timer->regs[TIMER_O_CTL / 4] & TIMER_CTL_TAOTE) {
+        host_adc_trigger();
+    }
+
+    host_sync();
+    return true;
+}
+
+uint64_t host_uart_tx_count(void) {
+    host_sync();
+    return host_capture_head;
+}
+
+uint32_t host_uart_tx_take(char *data, uint32_t max) {
+    uint32_t n = 0;
+
+    host_sync();
+    while(n < max && host_capture_tail != host_capture_head) {
+        data[n++] = host_capture[host_capture_tail++ & (HOST_UART_CAPTURE - 1)];
+    }
+
+    return n;
+}
+
+uint32_t host_ssi_take(uint32_t n, uint16_t *words, uint32_t max) {
+    host_ssi_t *ssi = &host_ssi[n];
+    uint32_t i = 0;
+
+    host_sync();
+    while(i < max && ssi->sent_tail != ssi->sent_head) {
+        words[i++] = ssi->sent[ssi->sent_tail++ & (HOST_SSI_CAPTURE - 1)];
+    }
+
+    return i;
+}
+
+uint32_t host_ssi_dma_runs(uint32_t n) {
+    host_sync();
+    return host_ssi[n].dma_runs;
+}
+
+//
+// driverlib
+//
+
+void SysCtlPeripheralEnable(uint32_t peripheral) {
+    (void)peripheral;
+}
+
+uint32_t SysCtlClockGet(void) {
+    return 80000000;
+}
+
+void SysCtlDelay(uint32_t count) {
+    (void)count;
+}
+
+bool IntMasterEnable(void) {
+    bool was = host_primask;
+    host_irq_restore(0);
+    return was;
+}
+
+bool IntMasterDisable(void) {
+    return host_irq_save();
+}
+
+void IntRegister(uint32_t interrupt, void (*handler)(void)) {
+    host_irq_handler[interrupt] = handler;
+}
+
+void IntEnable(uint32_t interrupt) {
+    host_commit();
+    host_irq_enabled[interrupt / 32] |= 1 << (interrupt % 32);
+    host_sync();
+}
+
+void IntDisable(uint32_t interrupt) {
+    host_irq_enabled[interrupt / 32] &= ~(1 << (interrupt % 32));
+}
+
+void IntPendSet(uint32_t interrupt) {
+    host_commit();
+    host_irq_pend(interrupt);
+    host_sync();
+}
+
+void IntPrioritySet(uint32_t interrupt, uint8_t priority) {
+    (void)interrupt;
+    (void)priority;
+}
+
+void GPIOPinWrite(uint32_t port, uint8_t pins, uint8_t val) {
+    host_commit();
+    host_gpio_write(host_gpio_port(port), GPIO_O_DATA + (pins << 2), val);
+    host_sync();
+}
+
+int32_t GPIOPinRead(uint32_t port, uint8_t pins) {
+    host_sync();
+    return host_gpio_read(host_gpio_port(port), GPIO_O_DATA + (pins << 2));
+}
+
+void GPIOPinIntEnable(uint32_t port, uint8_t pins) {
+    host_gpio_t *gpio = host_gpio_port(port);
+
+    host_commit();
+    host_gpio_write(gpio, GPIO_O_IM, gpio->regs[GPIO_O_IM / 4] | pins);
+    host_sync();
+}
+
+void GPIOPinIntDisable(uint32_t port, uint8_t pins) {
+    host_gpio_t *gpio = host_gpio_port(port);
+
+    host_commit();
+    host_gpio_write(gpio, GPIO_O_IM, gpio->regs[GPIO_O_IM / 4] & ~pins);
+    host_sync();
+}
+
+void GPIOPinIntClear(uint32_t port, uint8_t pins) {
+    host_commit();
+    host_gpio_write(host_gpio_port(port), GPIO_O_ICR, pins);
+    host_sync();
+}
+
+void GPIOPinConfigure(uint32_t config) {
+    (void)config;
+}
+
+void GPIOPinTypeUART(uint32_t port, uint8_t pins) {
+    host_gpio_t *gpio = host_gpio_port(port);
+
+    host_commit();
+    host_gpio_write(gpio, GPIO_O_AFSEL, gpio->regs[GPIO_O_AFSEL / 4] | pins);
+    host_gpio_write(gpio, GPIO_O_DEN, gpio->regs[GPIO_O_DEN / 4] | pins);
+    host_sync();
+}
+
+void GPIOPinTypeSSI(uint32_t port, uint8_t pins) {
+    host_gpio_t *gpio = host_gpio_port(port);
+
+    host_commit();
+    host_gpio_write(gpio, GPIO_O_AFSEL, gpio->regs[GPIO_O_AFSEL / 4] | pins);
+    host_gpio_write(gpio, GPIO_O_DEN, gpio->regs[GPIO_O_DEN / 4] | pins);
+    host_sync();
+}
+
+void GPIOPinTypeADC(uint32_t port, uint8_t pins) {
+    host_gpio_t *gpio = host_gpio_port(port);
+
+    host_commit();
+    host_gpio_write(gpio, GPIO_O_DIR, gpio->regs[GPIO_O_DIR / 4] & ~pins);
+    host_gpio_write(gpio, GPIO_O_DEN, gpio->regs[GPIO_O_DEN / 4] & ~pins);
+    host_sync();
+}
+
+void UARTConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t baud, uint32_t config) {
+    (void)base;
+    (void)clock;
+    (void)baud;
+    (void)config;
+}
+
+void UARTFIFOLevelSet(uint32_t base, uint32_t tx_level, uint32_t rx_level) {
+    host_commit();
+    host_reg_write(base + UART_O_IFLS, tx_level | rx_level);
+}
+
+void UARTEnable(uint32_t base) {
+    (void)base;
+}
+
+void UARTDMAEnable(uint32_t base, uint32_t flags) {
+    if(base == UART1_BASE) {
+        host_uart_dmactl |= flags;
+    }
+}
+
+void UARTIntEnable(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_reg_write(base + UART_O_IM, host_reg_read(base + UART_O_IM) | flags);
+    host_sync();
+}
+
+uint32_t UARTIntStatus(uint32_t base, bool masked) {
+    host_commit();
+    return host_reg_read(base + (masked ? UART_O_MIS : UART_O_RIS));
+}
+
+void UARTIntClear(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_reg_write(base + UART_O_ICR, flags);
+}
+
+void UARTCharPut(uint32_t base, unsigned char data) {
+    host_commit();
+    host_reg_write(base + UART_O_DR, data);
+    host_sync();
+}
+
+int32_t UARTCharGetNonBlocking(uint32_t base) {
+    host_commit();
+    return (base == UART1_BASE) ? host_uart_rx_get() : -1;
+}
+
+void SSIConfigSetExpClk(uint32_t base, uint32_t clock, uint32_t protocol, uint32_t mode,
+                        uint32_t bit_rate, uint32_t width) {
+    host_ssi_t *ssi = host_ssi_get(base);
+
+    (void)clock;
+    (void)mode;
+    (void)bit_rate;
+    host_commit();
+    ssi->regs[SSI_O_CR0 / 4] = (protocol << 6) | (width - 1);
+}
+
+void SSIEnable(uint32_t base) {
+    host_commit();
+    host_ssi_write(host_ssi_get(base), SSI_O_CR1, host_ssi_get(base)->regs[SSI_O_CR1 / 4] | SSI_CR1_SSE);
+    host_sync();
+}
+
+void SSIDisable(uint32_t base) {
+    host_commit();
+    host_ssi_get(base)->regs[SSI_O_CR1 / 4] &= ~SSI_CR1_SSE;
+}
+
+void SSIIntEnable(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_ssi_get(base)->regs[SSI_O_IM / 4] |= flags;
+    host_sync();
+}
+
+void SSIIntDisable(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_ssi_get(base)->regs[SSI_O_IM / 4] &= ~flags;
+}
+
+uint32_t SSIIntStatus(uint32_t base, bool masked) {
+    host_commit();
+    return host_ssi_read(host_ssi_get(base), masked ? SSI_O_MIS : SSI_O_RIS);
+}
+
+void SSIIntClear(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_ssi_write(host_ssi_get(base), SSI_O_ICR, flags);
+}
+
+void uDMAEnable(void) {
+}
+
+void uDMAControlBaseSet(void *control_table) {
+    (void)control_table;
+}
+
+uint32_t uDMAErrorStatusGet(void) {
+    return 0;
+}
+
+void uDMAErrorStatusClear(void) {
+}
+
+void uDMAChannelAssign(uint32_t mapping) {
+    (void)mapping;
+}
+
+// Only the structure select is modelled
+void uDMAChannelAttributeEnable(uint32_t channel, uint32_t attr) {
+    if(attr & UDMA_ATTR_ALTSELECT) {
+        host_dma[channel & (HOST_DMA_CHANNELS - 1)].alt = true;
+    }
+}
+
+void uDMAChannelAttributeDisable(uint32_t channel, uint32_t attr) {
+    if(attr & UDMA_ATTR_ALTSELECT) {
+        host_dma[channel & (HOST_DMA_CHANNELS - 1)].alt = false;
+    }
+}
+
+void uDMAChannelControlSet(uint32_t channel, uint32_t control) {
+    host_dma[channel & (HOST_DMA_CHANNELS - 1)].ctl[!!(channel & UDMA_ALT_SELECT)].control = control;
+}
+
+void uDMAChannelTransferSet(uint32_t channel, uint32_t mode, void *src, void *dst, uint32_t count) {
+    host_dma_ctl_t *ctl = &host_dma[channel & (HOST_DMA_CHANNELS - 1)].ctl[!!(channel & UDMA_ALT_SELECT)];
+
+    ctl->src   = src;
+    ctl->dst   = dst;
+    ctl->mode  = mode;
+    ctl->count = count;
+}
+
+// UART1 TX finishes as soon as it is enabled, SSI channels once the SSI
+// asks for them. Either completes on the peripheral's own vector
+void uDMAChannelEnable(uint32_t channel) {
+    host_dma_t *dma = &host_dma[channel & (HOST_DMA_CHANNELS - 1)];
+    host_dma_ctl_t *ctl = &dma->ctl[dma->alt];
+    uint32_t i;
+
+    host_commit();
+    dma->enabled = true;
+
+    if(channel == UDMA_CHANNEL_UART1TX && (host_uart_dmactl & UART_DMA_TX) &&
+       (uintptr_t)ctl->dst == UART1_BASE + UART_O_DR) {
+        host_capture_put((const char *)ctl->src, ctl->count);
+        host_uart1.dma_done = true;
+        ctl->mode = UDMA_MODE_STOP;
+        dma->enabled = false;
+    }
+
+    for(i = 0; i < HOST_NUM_SSI; i++) {
+        if((channel & (HOST_DMA_CHANNELS - 1)) == host_ssi_dma[i][1]) {
+            host_ssi_run(&host_ssi[i]);
+        }
+    }
+}
+
+void uDMAChannelDisable(uint32_t channel) {
+    host_commit();
+    host_dma[channel & (HOST_DMA_CHANNELS - 1)].enabled = false;
+}
+
+bool uDMAChannelIsEnabled(uint32_t channel) {
+    return host_dma[channel & (HOST_DMA_CHANNELS - 1)].enabled;
+}
+
+uint32_t uDMAChannelModeGet(uint32_t channel) {
+    return host_dma[channel & (HOST_DMA_CHANNELS - 1)].ctl[!!(channel & UDMA_ALT_SELECT)].mode;
+}
+
+void TimerConfigure(uint32_t base, uint32_t config) {
+    host_timer_t *timer = host_timer_get(base);
+
+    host_commit();
+    timer->regs[TIMER_O_CTL / 4] = 0;
+    timer->regs[TIMER_O_CFG / 4] = config >> 24;
+    timer->regs[TIMER_O_TAMR / 4] = config & 0xFF;
+}
+
+void TimerLoadSet(uint32_t base, uint32_t which, uint32_t value) {
+    host_timer_t *timer = host_timer_get(base);
+
+    host_commit();
+    if(which & TIMER_A) {
+        timer->regs[TIMER_O_TAILR / 4] = value;
+        timer->regs[TIMER_O_TAV / 4] = value;
+    }
+}
+
+void TimerEnable(uint32_t base, uint32_t which) {
+    host_commit();
+    host_timer_get(base)->regs[TIMER_O_CTL / 4] |= which & TIMER_CTL_TAEN;
+}
+
+void TimerDisable(uint32_t base, uint32_t which) {
+    host_commit();
+    host_timer_get(base)->regs[TIMER_O_CTL / 4] &= ~(which & TIMER_CTL_TAEN);
+}
+
+void TimerControlTrigger(uint32_t base, uint32_t which, bool enable) {
+    host_timer_t *timer = host_timer_get(base);
+
+    host_commit();
+    if(which & TIMER_A) {
+        if(enable) {
+            timer->regs[TIMER_O_CTL / 4] |= TIMER_CTL_TAOTE;
+        } else {
+            timer->regs[TIMER_O_CTL / 4] &= ~TIMER_CTL_TAOTE;
+        }
+    }
+}
+
+void TimerIntEnable(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_timer_get(base)->regs[TIMER_O_IMR / 4] |= flags;
+    host_sync();
+}
+
+void TimerIntDisable(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_timer_get(base)->regs[TIMER_O_IMR / 4] &= ~flags;
+}
+
+void TimerIntClear(uint32_t base, uint32_t flags) {
+    host_commit();
+    host_timer_get(base)->regs[TIMER_O_RIS / 4] &= ~flags;
+}
+
+// Only sequencer 0 is modelled
+void ADCSequenceConfigure(uint32_t base, uint32_t seq, uint32_t trigger, uint32_t priority) {
+    host_adc_t *adc = host_adc_get(base);
+
+    (void)seq;
+    (void)priority;
+    host_commit();
+    adc->regs[ADC_O_EMUX / 4] = (adc->regs[ADC_O_EMUX / 4] & ~ADC_EMUX_EM0_M) | trigger;
+}
+
+void ADCSequenceStepConfigure(uint32_t base, uint32_t seq, uint32_t step, uint32_t config) {
+    (void)seq;
+    host_commit();
+    if(config & ADC_CTL_END) {
+        host_adc_get(base)->steps = step + 1;
+    }
+}
+
+void ADCSequenceEnable(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_ACTSS / 4] |= ADC_ACTSS_ASEN0;
+}
+
+void ADCSequenceDisable(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_ACTSS / 4] &= ~ADC_ACTSS_ASEN0;
+}
+
+void ADCSequenceDMAEnable(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_ACTSS / 4] |= ADC_ACTSS_ADEN0;
+}
+
+void ADCSequenceDMADisable(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_ACTSS / 4] &= ~ADC_ACTSS_ADEN0;
+}
+
+int32_t ADCSequenceOverflow(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    return host_adc_get(base)->regs[ADC_O_OSTAT / 4] & ADC_OSTAT_OV0;
+}
+
+void ADCSequenceOverflowClear(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_OSTAT / 4] &= ~ADC_OSTAT_OV0;
+}
+
+void ADCIntClear(uint32_t base, uint32_t seq) {
+    (void)seq;
+    host_commit();
+    host_adc_get(base)->regs[ADC_O_RIS / 4] = 0;
+}
@@ -0,0 +1,92 @@
+#ifndef __HOST_H__
+#define __HOST_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Linux backend for the driver layer.
+ *
+ * The headers under host/inc and host/driverlib stand in for TI's when
+ * building with -DHOST -Ihost. HWREG goes through host_reg(), which keeps
+ * a register model of the GPIO ports, UART1, SSI0-2, ADC0-1, uDMA and
+ * timers 0-5, and the driverlib calls the drivers use act on the same
+ * model. Time does not pass on its own: the bench expires timers
+ * explicitly, and a timer with its ADC trigger on starts a conversion
+ * frame as it expires. Interrupts are delivered to the same handler names
+ * nvic_table binds, one at a time, as soon as PRIMASK allows; there is no
+ * preemption between handlers.
+ *
+ * HWREG returns a pointer to a scratch slot preloaded with the register's
+ * read value. A slot that no longer holds that value was written, and the
+ * write is applied before the next access, interrupt or driverlib call.
+ * In C++ HWREG wraps the slot in HostReg, which loads and stores through
+ * host_reg_load() and host_reg_store() so each one is seen and counted.
+ */
+
+// Pointer behind HWREG(addr)
+volatile uint32_t *host_reg(uint32_t addr);
+
+// Load from and store to the register behind a host_reg() slot
+uint32_t host_reg_load(volatile uint32_t *reg);
+void host_reg_store(volatile uint32_t *reg, uint32_t value);
+
+// Apply any register writes still held in HWREG slots
+void host_sync(void);
+
+// HWREG accesses so far. A read-modify-write like HWREG(a) |= b is one
+uint64_t host_reg_accesses(void);
+
+// Register loads through HWREG in C++ so far. A read-modify-write like
+// HWREG(a) |= b is one, along with one store. C code is not counted
+uint64_t host_reg_reads(void);
+
+// Register stores through HWREG so far. From C a store of the value the
+// register already reads back cannot be seen, and is not counted
+uint64_t host_reg_writes(void);
+
+// Simulated PRIMASK and exception state, see cpu.h
+uint32_t host_in_isr(void);
+uint32_t host_irq_save(void);
+void host_irq_restore(uint32_t primask);
+
+// Monotonic nanoseconds, stands in for the DWT cycle counter
+uint64_t host_ns(void);
+
+// Drive the external level of input pins on a port (0-5). Edges raise
+// interrupts the same way the pins would
+void host_gpio_input(uint32_t port, uint8_t pins, uint8_t level);
+
+// Current level of every pin on a port, outputs included
+uint8_t host_gpio_level(uint32_t port);
+
+// Let timer n (0-5) A run down to its timeout once, raising its interrupt.
+// Returns false if the timer is not enabled
+bool host_timer_expire(uint32_t n);
+
+// Queue bytes on the UART1 RX line. The RX FIFO holds 16, extras are lost
+uint32_t host_uart_rx(const char *data, uint32_t len);
+
+// Bytes sent on UART1, through the FIFO or by uDMA
+uint64_t host_uart_tx_count(void);
+
+// Take up to max sent bytes, oldest first. The capture keeps the last 64K
+uint32_t host_uart_tx_take(char *data, uint32_t max);
+
+// Take up to max words sent on SSI n (0-2), oldest first. MISO is tied to
+// MOSI, so these are also the words received. The capture keeps the last 4K
+uint32_t host_ssi_take(uint32_t n, uint16_t *words, uint32_t max);
+
+// uDMA transfers SSI n has run, one per piece of an SPI transfer
+uint32_t host_ssi_dma_runs(uint32_t n);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
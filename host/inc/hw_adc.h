@@ -0,0 +1,19 @@
+#ifndef __HW_ADC_H__
+#define __HW_ADC_H__
+
+#define ADC_O_ACTSS         0x00000000
+#define ADC_O_RIS           0x00000004
+#define ADC_O_IM            0x00000008
+#define ADC_O_ISC           0x0000000C
+#define ADC_O_OSTAT         0x00000010
+#define ADC_O_EMUX          0x00000014
+#define ADC_O_SSFIFO0       0x00000048
+
+#define ADC_ACTSS_ASEN0     0x00000001
+#define ADC_ACTSS_ADEN0     0x00000100
+
+#define ADC_EMUX_EM0_M      0x0000000F
+
+#define ADC_OSTAT_OV0       0x00000001
+
+#endif
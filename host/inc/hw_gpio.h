@@ -0,0 +1,27 @@
+#ifndef __HW_GPIO_H__
+#define __HW_GPIO_H__
+
+#define GPIO_O_DATA         0x00000000
+#define GPIO_O_DIR          0x00000400
+#define GPIO_O_IS           0x00000404
+#define GPIO_O_IBE          0x00000408
+#define GPIO_O_IEV          0x0000040C
+#define GPIO_O_IM           0x00000410
+#define GPIO_O_RIS          0x00000414
+#define GPIO_O_MIS          0x00000418
+#define GPIO_O_ICR          0x0000041C
+#define GPIO_O_AFSEL        0x00000420
+#define GPIO_O_DR2R         0x00000500
+#define GPIO_O_DR4R         0x00000504
+#define GPIO_O_DR8R         0x00000508
+#define GPIO_O_ODR          0x0000050C
+#define GPIO_O_PUR          0x00000510
+#define GPIO_O_PDR          0x00000514
+#define GPIO_O_SLR          0x00000518
+#define GPIO_O_DEN          0x0000051C
+#define GPIO_O_LOCK         0x00000520
+#define GPIO_O_CR           0x00000524
+#define GPIO_O_AMSEL        0x00000528
+#define GPIO_O_PCTL         0x0000052C
+
+#endif
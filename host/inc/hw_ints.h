@@ -0,0 +1,34 @@
+#ifndef __HW_INTS_H__
+#define __HW_INTS_H__
+
+#define INT_GPIOA           16
+#define INT_GPIOB           17
+#define INT_GPIOC           18
+#define INT_GPIOD           19
+#define INT_GPIOE           20
+#define INT_UART0           21
+#define INT_UART1           22
+#define INT_SSI0            23
+#define INT_ADC0SS0         30
+#define INT_TIMER0A         35
+#define INT_TIMER0B         36
+#define INT_TIMER1A         37
+#define INT_TIMER1B         38
+#define INT_TIMER2A         39
+#define INT_TIMER2B         40
+#define INT_GPIOF           46
+#define INT_SSI1            50
+#define INT_TIMER3A         51
+#define INT_TIMER3B         52
+#define INT_UDMA            62
+#define INT_UDMAERR         63
+#define INT_ADC1SS0         64
+#define INT_SSI2            73
+#define INT_TIMER4A         86
+#define INT_TIMER4B         87
+#define INT_TIMER5A         108
+#define INT_TIMER5B         109
+
+#define NUM_INTERRUPTS      155
+
+#endif
@@ -0,0 +1,26 @@
+#ifndef __HW_MEMMAP_H__
+#define __HW_MEMMAP_H__
+
+// Base addresses of the peripherals the host model simulates
+#define GPIO_PORTA_BASE     0x40004000
+#define GPIO_PORTB_BASE     0x40005000
+#define GPIO_PORTC_BASE     0x40006000
+#define GPIO_PORTD_BASE     0x40007000
+#define UART0_BASE          0x4000C000
+#define UART1_BASE          0x4000D000
+#define SSI0_BASE           0x40008000
+#define SSI1_BASE           0x40009000
+#define SSI2_BASE           0x4000A000
+#define TIMER0_BASE         0x40030000
+#define TIMER1_BASE         0x40031000
+#define TIMER2_BASE         0x40032000
+#define TIMER3_BASE         0x40033000
+#define TIMER4_BASE         0x40034000
+#define TIMER5_BASE         0x40035000
+#define ADC0_BASE           0x40038000
+#define ADC1_BASE           0x40039000
+#define GPIO_PORTE_BASE     0x40024000
+#define GPIO_PORTF_BASE     0x40025000
+#define UDMA_BASE           0x400FF000
+
+#endif
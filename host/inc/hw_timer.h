@@ -0,0 +1,19 @@
+#ifndef __HW_TIMER_H__
+#define __HW_TIMER_H__
+
+#define TIMER_O_CFG         0x00000000
+#define TIMER_O_TAMR        0x00000004
+#define TIMER_O_CTL         0x0000000C
+#define TIMER_O_IMR         0x00000018
+#define TIMER_O_RIS         0x0000001C
+#define TIMER_O_MIS         0x00000020
+#define TIMER_O_ICR         0x00000024
+#define TIMER_O_TAILR       0x00000028
+#define TIMER_O_TAV         0x00000050
+
+#define TIMER_CTL_TAEN      0x00000001
+#define TIMER_CTL_TAOTE     0x00000020
+#define TIMER_TAMR_TAMR_M   0x00000003
+#define TIMER_TAMR_TAMR_1_SHOT 0x00000001
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef __HW_TYPES_H__
+#define __HW_TYPES_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "host.h"
+
+// Registers go through the host model, see host.h
+#ifdef __cplusplus
+
+// One HWREG expression. Converting it is a load, assigning it a store and
+// a compound assignment both. Left unused, as in (void)HWREG(x), it still
+// reads the register
+class HostReg {
+  public:
+    explicit HostReg(uint32_t addr) : reg(host_reg(addr)), used(false) {}
+
+    ~HostReg() {
+        if(!used) {
+            host_reg_load(reg);
+        }
+    }
+
+    operator uint32_t() const {
+        used = true;
+        return host_reg_load(reg);
+    }
+
+    HostReg &operator=(uint32_t x)  { store(x); return *this; }
+    HostReg &operator=(const HostReg &r) { store(r); return *this; }
+    HostReg &operator|=(uint32_t x) { store(*this | x); return *this; }
+    HostReg &operator&=(uint32_t x) { store(*this & x); return *this; }
+    HostReg &operator^=(uint32_t x) { store(*this ^ x); return *this; }
+
+  private:
+    void store(uint32_t x) {
+        used = true;
+        host_reg_store(reg, x);
+    }
+
+    volatile uint32_t *reg;
+    mutable bool used;
+};
+
+#define HWREG(x)    (HostReg((uint32_t)(x)))
+
+#else
+
+#define HWREG(x)    (*host_reg((uint32_t)(x)))
+
+#endif
+
+#endif
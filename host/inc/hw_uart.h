@@ -0,0 +1,18 @@
+#ifndef __HW_UART_H__
+#define __HW_UART_H__
+
+#define UART_O_DR           0x00000000
+#define UART_O_FR           0x00000018
+#define UART_O_IFLS         0x00000034
+#define UART_O_IM           0x00000038
+#define UART_O_RIS          0x0000003C
+#define UART_O_MIS          0x00000040
+#define UART_O_ICR          0x00000044
+
+#define UART_FR_BUSY        0x00000008
+#define UART_FR_RXFE        0x00000010
+#define UART_FR_TXFF        0x00000020
+#define UART_FR_RXFF        0x00000040
+#define UART_FR_TXFE        0x00000080
+
+#endif
@@ -7,17 +7,26 @@
 #include <driverlib/watchdog.h>
 
 #include "compiler.h"
+#include "timebase.h"
 
-__section(".init")
+// Called by reset_handler before .data and .bss are initialized, so this
+// must not touch RAM
 void clock_init(void) {
-    // Run directly from the crystal
-    MAP_SysCtlClockSet(SYSCTL_SYSDIV_1   |
+    // 80MHz from the PLL
+    MAP_SysCtlClockSet(SYSCTL_SYSDIV_2_5 |
                        SYSCTL_USE_PLL    |
                        SYSCTL_XTAL_16MHZ |
                        SYSCTL_OSC_MAIN);
 }
 
-__section(".init")
+__init(102)
+void time_init(void) {
+    // Start the monotonic clock behind _gettimeofday/_times. It reads the
+    // rate clock_init left behind
+    timebase_init();
+}
+
+__init(101)
 void fpu_init(void) {
     // Enable FPU.
     // Must be done in privileged mode
@@ -45,7 +54,7 @@ void fpu_init(void) {
     // MAP_FPUStackingEnable();
 }
 
-__section(".init")
+__init(103)
 void wdt_init(void) {
     // Enable watchdog peripheral
     MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_WDOG0);
@@ -0,0 +1,462 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_nvic.h>
+#include <inc/hw_timer.h>
+#include <driverlib/debug.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+#include <driverlib/fpu.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "timebase.h"
+#include "mem.h"
+#include "kernel.h"
+
+// One shot wakeup timer for sleeping threads, full 32-bit width
+#define KERNEL_TIMER_BASE   TIMER4_BASE
+#define KERNEL_TIMER_PERIPH SYSCTL_PERIPH_TIMER4
+#define KERNEL_TIMER_INT    INT_TIMER4A
+
+// Longest single timer period, keeps the cycle count inside 32 bits
+#define KERNEL_MAX_SLEEP_NS 1000000000ULL
+
+// Return to thread mode on the process stack, basic frame
+#define KERNEL_EXC_RETURN   0xFFFFFFFD
+
+#define KERNEL_IDLE_WORDS   64
+
+static kthread_t *kernel_ready_head[KERNEL_NUM_PRIO];
+static kthread_t *kernel_ready_tail[KERNEL_NUM_PRIO];
+static uint32_t kernel_ready_map;
+
+// Sleeping threads sorted by wake time
+static kthread_t *kernel_sleepers;
+
+// Read by the context switch code
+kthread_t *kernel_current;
+
+static kthread_t kernel_idle;
+KTHREAD_STACK(kernel_idle_stack, KERNEL_IDLE_WORDS);
+
+// Called from the handlers below
+uint32_t *kernel_switch(uint32_t *sp);
+uint32_t *kernel_first(void);
+
+// The ready, wait and sleep lists are only changed with interrupts masked
+
+static void kernel_ready_push(kthread_t *thread) {
+    uint8_t prio = thread->prio;
+
+    thread->next  = NULL;
+    thread->state = KTHREAD_READY;
+    if(kernel_ready_tail[prio]) {
+        kernel_ready_tail[prio]->next = thread;
+    } else {
+        kernel_ready_head[prio] = thread;
+    }
+    kernel_ready_tail[prio] = thread;
+    kernel_ready_map |= 1u << prio;
+}
+
+static void kernel_ready_remove(kthread_t *thread) {
+    uint8_t prio = thread->prio;
+    kthread_t **p, *prev = NULL;
+
+    for(p = &kernel_ready_head[prio]; *p; prev = *p, p = &(*p)->next) {
+        if(*p == thread) {
+            *p = thread->next;
+            if(kernel_ready_tail[prio] == thread) {
+                kernel_ready_tail[prio] = prev;
+            }
+            break;
+        }
+    }
+    thread->next = NULL;
+
+    if(!kernel_ready_head[prio]) {
+        kernel_ready_map &= ~(1u << prio);
+    }
+}
+
+static kthread_t *kernel_ready_top(void) {
+    // Idle is always ready, so the map is never empty
+    return kernel_ready_head[31 - __clz(kernel_ready_map)];
+}
+
+// Request a switch if something other than the current thread should run.
+// PendSV waits for every other interrupt and for PRIMASK to be cleared
+static void kernel_preempt(void) {
+    if(kernel_current && kernel_ready_top() != kernel_current) {
+        HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+    }
+}
+
+// Highest priority first, FIFO among equals
+static void kernel_wait_insert(kthread_t **list, kthread_t *thread) {
+    while(*list && (*list)->prio >= thread->prio) {
+        list = &(*list)->next;
+    }
+    thread->next = *list;
+    *list = thread;
+}
+
+// Take the current thread off the ready list and park it on list
+static void kernel_block(kthread_t **list) {
+    kthread_t *self = kernel_current;
+
+    kernel_ready_remove(self);
+    self->state = KTHREAD_BLOCKED;
+    kernel_wait_insert(list, self);
+    HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+}
+
+static void kernel_timer_arm(void) {
+    uint64_t now, delta;
+    uint32_t cycles;
+
+    MAP_TimerDisable(KERNEL_TIMER_BASE, TIMER_A);
+    if(!kernel_sleepers) {
+        return;
+    }
+
+    now = timebase_ns();
+    delta = kernel_sleepers->wake > now ? kernel_sleepers->wake - now : 0;
+    if(delta > KERNEL_MAX_SLEEP_NS) {
+        delta = KERNEL_MAX_SLEEP_NS;
+    }
+
+    cycles = (uint32_t)(delta * timebase_hz() / 1000000000ULL);
+    MAP_TimerLoadSet(KERNEL_TIMER_BASE, TIMER_A, cycles ? cycles : 1);
+    MAP_TimerEnable(KERNEL_TIMER_BASE, TIMER_A);
+}
+
+// Bound into nvic_table by name
+void timer4a_handler(void) {
+    uint32_t primask = cpu_irq_save();
+    uint64_t now = timebase_ns();
+    kthread_t *thread;
+
+    HWREG(KERNEL_TIMER_BASE + TIMER_O_ICR) = TIMER_TIMA_TIMEOUT;
+
+    while((thread = kernel_sleepers) && thread->wake <= now) {
+        kernel_sleepers = thread->next;
+        kernel_ready_push(thread);
+    }
+
+    kernel_timer_arm();
+    kernel_preempt();
+    cpu_irq_restore(primask);
+}
+
+uint32_t *kernel_switch(uint32_t *sp) {
+    uint32_t primask = cpu_irq_save();
+
+    kernel_current->sp = sp;
+    kernel_current = kernel_ready_top();
+
+    cpu_irq_restore(primask);
+    return kernel_current->sp;
+}
+
+uint32_t *kernel_first(void) {
+    kernel_current = kernel_ready_top();
+    return kernel_current->sp;
+}
+
+// Bound into nvic_table by name. Saves r4-r11 and EXC_RETURN on the
+// outgoing thread's stack, plus s16-s31 if its frame has FP state (bit 4
+// of EXC_RETURN clear). Touching s16-s31 also triggers the lazy save of
+// s0-s15 into the space the hardware reserved
+__naked void pendsv_handler(void) {
+    __asm__ __volatile__(
+        "mrs      r0, psp           \n"
+#ifdef __ARM_FP
+        "tst      lr, #0x10         \n"
+        "it       eq                \n"
+        "vstmdbeq r0!, {s16-s31}    \n"
+#endif
+        "stmdb    r0!, {r4-r11, lr} \n"
+        "bl       kernel_switch     \n"
+        "ldmia    r0!, {r4-r11, lr} \n"
+#ifdef __ARM_FP
+        "tst      lr, #0x10         \n"
+        "it       eq                \n"
+        "vldmiaeq r0!, {s16-s31}    \n"
+#endif
+        "msr      psp, r0           \n"
+        "bx       lr                \n"
+    );
+}
+
+// Bound into nvic_table by name. Only used by kernel_start: resets the
+// main stack to its initial value from the vector table and returns into
+// the first thread
+__naked void svcall_handler(void) {
+    __asm__ __volatile__(
+        "movw     r0, #0xED08       \n"
+        "movt     r0, #0xE000       \n"
+        "ldr      r0, [r0]          \n"
+        "ldr      r0, [r0]          \n"
+        "msr      msp, r0           \n"
+        "bl       kernel_first      \n"
+        "ldmia    r0!, {r4-r11, lr} \n"
+        "msr      psp, r0           \n"
+        "bx       lr                \n"
+    );
+}
+
+static void kernel_idle_fn(void *arg) {
+    while(1) {
+        __asm__ __volatile__("wfi");
+    }
+}
+
+void kernel_init(void) {
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(KERNEL_TIMER_PERIPH);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_TimerConfigure(KERNEL_TIMER_BASE, TIMER_CFG_ONE_SHOT);
+    MAP_TimerIntEnable(KERNEL_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntEnable(KERNEL_TIMER_INT);
+
+#ifdef __ARM_FP
+    // Threads' FP state is saved through the exception frame
+    MAP_FPULazyStackingEnable();
+#endif
+
+    // Switch only once no other handler is active
+    MAP_IntPrioritySet(FAULT_PENDSV, 0xFF);
+
+    timebase_init();
+
+    kthread_create(&kernel_idle, "idle", kernel_idle_fn, NULL,
+                   kernel_idle_stack, KERNEL_IDLE_WORDS, 0);
+}
+
+void kernel_start(void) {
+    __asm__ __volatile__("cpsie i \n"
+                         "svc   #0\n");
+
+    while(1);
+}
+
+void kthread_create(kthread_t *thread, const char *name, kthread_fn_t fn, void *arg,
+                    uint32_t *stack, uint32_t stack_words, uint8_t prio) {
+    uint32_t *sp = stack + stack_words;
+    uint32_t i, primask;
+
+    // Check parameters
+    ASSERT(prio < KERNEL_NUM_PRIO);
+    ASSERT(prio > 0 || thread == &kernel_idle);
+    ASSERT(((uint32_t)sp & 7) == 0);
+
+    // Painted so kthread_stack_peak() can find the deepest use
+    mem_paint(stack, sp);
+
+    // Exception frame popped by the hardware on the first switch in
+    *--sp = 0x01000000;                     // xPSR, Thumb bit
+    *--sp = (uint32_t)fn & ~1u;             // PC
+    *--sp = (uint32_t)kthread_exit;         // LR
+    *--sp = 0;                              // R12
+    *--sp = 0;                              // R3
+    *--sp = 0;                              // R2
+    *--sp = 0;                              // R1
+    *--sp = (uint32_t)arg;                  // R0
+
+    // Software saved part, see pendsv_handler
+    *--sp = KERNEL_EXC_RETURN;
+    for(i = 0; i < 8; i++) {
+        *--sp = 0;                          // R11-R4
+    }
+
+    thread->sp          = sp;
+    thread->name        = name;
+    thread->stack       = stack;
+    thread->stack_words = stack_words;
+    thread->prio        = prio;
+    thread->wait_bits   = 0;
+    thread->wait_mode   = 0;
+
+    primask = cpu_irq_save();
+    kernel_ready_push(thread);
+    kernel_preempt();
+    cpu_irq_restore(primask);
+}
+
+uint32_t kthread_stack_peak(kthread_t *thread) {
+    return mem_painted_used(thread->stack, thread->stack + thread->stack_words);
+}
+
+kthread_t *kthread_self(void) {
+    return kernel_current;
+}
+
+void kthread_yield(void) {
+    uint32_t primask = cpu_irq_save();
+
+    kernel_ready_remove(kernel_current);
+    kernel_ready_push(kernel_current);
+    kernel_preempt();
+
+    cpu_irq_restore(primask);
+}
+
+void kthread_sleep_us(uint32_t us) {
+    kthread_t *self = kernel_current;
+    kthread_t **p = &kernel_sleepers;
+    uint32_t primask = cpu_irq_save();
+
+    self->wake = timebase_ns() + us * 1000ULL;
+    kernel_ready_remove(self);
+    self->state = KTHREAD_SLEEPING;
+
+    while(*p && (*p)->wake <= self->wake) {
+        p = &(*p)->next;
+    }
+    self->next = *p;
+    *p = self;
+
+    if(kernel_sleepers == self) {
+        kernel_timer_arm();
+    }
+    HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+
+    cpu_irq_restore(primask);
+}
+
+void kthread_exit(void) {
+    cpu_irq_save();
+
+    kernel_ready_remove(kernel_current);
+    kernel_current->state = KTHREAD_DEAD;
+    HWREG(NVIC_INT_CTRL) = NVIC_INT_CTRL_PEND_SV;
+
+    cpu_irq_restore(0);
+    while(1);
+}
+
+void ksem_init(ksem_t *sem, uint32_t count) {
+    sem->count   = count;
+    sem->waiters = NULL;
+}
+
+void ksem_post(ksem_t *sem) {
+    uint32_t primask = cpu_irq_save();
+    kthread_t *thread = sem->waiters;
+
+    if(thread) {
+        sem->waiters = thread->next;
+        kernel_ready_push(thread);
+        kernel_preempt();
+    } else {
+        sem->count++;
+    }
+
+    cpu_irq_restore(primask);
+}
+
+void ksem_wait(ksem_t *sem) {
+    uint32_t primask = cpu_irq_save();
+
+    // A post hands the count straight to the woken thread
+    if(sem->count) {
+        sem->count--;
+    } else {
+        kernel_block(&sem->waiters);
+    }
+
+    cpu_irq_restore(primask);
+}
+
+bool ksem_trywait(ksem_t *sem) {
+    uint32_t primask = cpu_irq_save();
+    bool taken = sem->count != 0;
+
+    if(taken) {
+        sem->count--;
+    }
+
+    cpu_irq_restore(primask);
+    return taken;
+}
+
+void kflags_init(kflags_t *flags) {
+    flags->bits    = 0;
+    flags->waiters = NULL;
+}
+
+// Bits of flags that satisfy a wait, or 0
+static uint32_t kflags_match(uint32_t bits, uint32_t want, uint8_t mode) {
+    uint32_t match = bits & want;
+
+    if(mode & KFLAGS_ALL) {
+        return match == want ? match : 0;
+    }
+    return match;
+}
+
+void kflags_set(kflags_t *flags, uint32_t bits) {
+    uint32_t primask = cpu_irq_save();
+    kthread_t **p = &flags->waiters;
+    kthread_t *thread;
+    uint32_t match;
+
+    flags->bits |= bits;
+
+    while((thread = *p)) {
+        match = kflags_match(flags->bits, thread->wait_bits, thread->wait_mode);
+        if(match) {
+            *p = thread->next;
+            thread->wait_bits = match;
+            if(thread->wait_mode & KFLAGS_CLEAR) {
+                flags->bits &= ~match;
+            }
+            kernel_ready_push(thread);
+        } else {
+            p = &thread->next;
+        }
+    }
+
+    kernel_preempt();
+    cpu_irq_restore(primask);
+}
+
+void kflags_clear(kflags_t *flags, uint32_t bits) {
+    uint32_t primask = cpu_irq_save();
+
+    flags->bits &= ~bits;
+
+    cpu_irq_restore(primask);
+}
+
+uint32_t kflags_wait(kflags_t *flags, uint32_t bits, uint8_t mode) {
+    kthread_t *self = kernel_current;
+    uint32_t primask = cpu_irq_save();
+    uint32_t match = kflags_match(flags->bits, bits, mode);
+
+    if(match) {
+        if(mode & KFLAGS_CLEAR) {
+            flags->bits &= ~match;
+        }
+    } else {
+        self->wait_bits = bits;
+        self->wait_mode = mode;
+        kernel_block(&flags->waiters);
+    }
+
+    cpu_irq_restore(primask);
+
+    // Filled in by kflags_set when woken
+    return match ? match : self->wait_bits;
+}
@@ -0,0 +1,128 @@
+#ifndef __KERNEL_H__
+#define __KERNEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "compiler.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Small preemptive kernel with fixed priority threads.
+ *
+ * Everything is statically allocated by the caller: thread control blocks,
+ * stacks, semaphores and flag groups. Higher numbers are more urgent and
+ * the highest ready thread always runs; threads of equal priority only
+ * switch on kthread_yield() or when one blocks. The ready thread is picked
+ * with one CLZ over a priority bitmap.
+ *
+ * Switches happen in PendSV at the lowest interrupt priority, so ISRs are
+ * never delayed by the scheduler. FP registers s16-s31 are only saved for
+ * threads that have used the FPU (the hardware marks this in EXC_RETURN),
+ * which relies on the automatic FP stacking that is on out of reset.
+ *
+ *     KTHREAD_STACK(ctrl_stack, 256);
+ *     static kthread_t ctrl;
+ *
+ *     kernel_init();
+ *     kthread_create(&ctrl, "ctrl", ctrl_loop, NULL, ctrl_stack, 256, 10);
+ *     kernel_start();
+ *
+ * Posting semaphores and setting flags is safe from interrupts. Blocking
+ * calls may only be made from threads.
+ */
+
+#define KERNEL_NUM_PRIO     32
+
+// Stack for a thread, words must be even to keep 8-byte alignment
+#define KTHREAD_STACK(name, words) \
+    static uint32_t name[words] __aligned(8)
+
+typedef void (*kthread_fn_t)(void *arg);
+
+typedef enum {
+    KTHREAD_READY = 0,
+    KTHREAD_BLOCKED,
+    KTHREAD_SLEEPING,
+    KTHREAD_DEAD
+} kthread_state_t;
+
+// Flag waits
+#define KFLAGS_ANY          0x00
+#define KFLAGS_ALL          0x01
+#define KFLAGS_CLEAR        0x02
+
+typedef struct kthread {
+    uint32_t *sp;               // saved stack pointer, must stay first
+    struct kthread *next;       // ready, wait or sleep list link
+    const char *name;
+    uint32_t *stack;
+    uint32_t stack_words;
+    uint64_t wake;              // timebase_ns() deadline while sleeping
+    uint32_t wait_bits;         // flags waited for, then flags matched
+    uint8_t wait_mode;
+    uint8_t prio;
+    uint8_t state;
+} kthread_t;
+
+typedef struct {
+    volatile uint32_t count;
+    kthread_t *waiters;
+} ksem_t;
+
+typedef struct {
+    volatile uint32_t bits;
+    kthread_t *waiters;
+} kflags_t;
+
+// Set up the idle thread and scheduler interrupts
+void kernel_init(void);
+
+// Switch to the highest priority thread. Does not return; the main stack
+// is handed back to interrupt handlers
+void kernel_start(void) __attribute__((noreturn));
+
+void kthread_create(kthread_t *thread, const char *name, kthread_fn_t fn, void *arg,
+                    uint32_t *stack, uint32_t stack_words, uint8_t prio);
+
+kthread_t *kthread_self(void);
+
+// Most bytes of its stack a thread has used so far
+uint32_t kthread_stack_peak(kthread_t *thread);
+
+// Let other ready threads of the same priority run
+void kthread_yield(void);
+
+void kthread_sleep_us(uint32_t us);
+
+// Also called when a thread function returns
+void kthread_exit(void) __attribute__((noreturn));
+
+void ksem_init(ksem_t *sem, uint32_t count);
+
+// Wake the highest priority waiter, or count up if there is none
+void ksem_post(ksem_t *sem);
+
+void ksem_wait(ksem_t *sem);
+
+// Take the semaphore if it is available without blocking
+bool ksem_trywait(ksem_t *sem);
+
+void kflags_init(kflags_t *flags);
+
+void kflags_set(kflags_t *flags, uint32_t bits);
+
+void kflags_clear(kflags_t *flags, uint32_t bits);
+
+// Block until any or all (KFLAGS_ALL) of bits are set and return the bits
+// that matched. KFLAGS_CLEAR consumes them
+uint32_t kflags_wait(kflags_t *flags, uint32_t bits, uint8_t mode);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include <sys/types.h>
 
+#include "pool.h"
+
 
 /*
  * The default pulls in 70K of garbage
@@ -22,10 +24,11 @@ extern "C" {
 
 
 /*
- * Implement C++ new/delete operators using the heap
+ * Implement C++ new/delete operators using the block pools, which fall
+ * back to the heap (see pool.h)
  */
 void *operator new(size_t size) {
-    return malloc(size);
+    return pool_alloc(size);
 }
 
 void *operator new(size_t, void *ptr) {
@@ -33,7 +36,7 @@ void *operator new(size_t, void *ptr) {
 }
 
 void *operator new[](size_t size) {
-    return malloc(size);
+    return pool_alloc(size);
 }
 
 void *operator new[](size_t, void *ptr) {
@@ -41,11 +44,11 @@ void *operator new[](size_t, void *ptr) {
 }
 
 void operator delete(void *p) {
-    free(p);
+    pool_free(p);
 }
 
 void operator delete[](void *p) {
-    free(p);
+    pool_free(p);
 }
 
 /*
@@ -0,0 +1,81 @@
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "compiler.h"
+#include "log.h"
+
+#if (LOG_BUF_WORDS & (LOG_BUF_WORDS - 1))
+#error "LOG_BUF_WORDS must be a power of two"
+#endif
+
+// Newlib output syscall, see syscalls.c
+extern int _write(int file, char *ptr, int len);
+
+uint32_t log_buf[LOG_BUF_WORDS];
+volatile uint32_t log_head;
+volatile uint32_t log_tail;
+volatile uint32_t log_dropped;
+
+void log_init(void) {
+    dwt_init();
+}
+
+// Records in the n words from tail, which always end on a record
+static uint32_t log_records(uint32_t tail, uint32_t n) {
+    uint32_t count = 0;
+    uint32_t end = tail + n;
+
+    while(tail != end) {
+        tail += (log_buf[tail & (LOG_BUF_WORDS - 1)] >> 24) + 2;
+        count++;
+    }
+    return count;
+}
+
+// Write n words, true if all of them were taken
+static bool log_write(const uint32_t *words, uint32_t n) {
+    return n == 0 || _write(1, (char *)words, n * 4) == (int)(n * 4);
+}
+
+uint32_t log_flush(void) {
+    uint32_t frame[3];
+    uint32_t tail = log_tail;
+    uint32_t head = log_head;
+    uint32_t n = head - tail;
+    uint32_t off, run, primask;
+
+    if(n == 0) {
+        return 0;
+    }
+
+    // Frame header: magic, word count, total records dropped so far. If
+    // it does not go out whole the frame is not started, and the records
+    // stay queued for the next flush
+    frame[0] = LOG_FRAME_MAGIC;
+    frame[1] = n;
+    frame[2] = log_dropped;
+    if(!log_write(frame, 3)) {
+        return 0;
+    }
+
+    // Records end exactly at head, so frames never split a record
+    off = tail & (LOG_BUF_WORDS - 1);
+    run = LOG_BUF_WORDS - off;
+    if(run > n) {
+        run = n;
+    }
+
+    // A frame cut short is thrown away by the decoder, so its records are
+    // lost. Count them, the next frame reports them dropped
+    if(!log_write(&log_buf[off], run) || !log_write(&log_buf[0], n - run)) {
+        primask = cpu_irq_save();
+        log_dropped += log_records(tail, n);
+        cpu_irq_restore(primask);
+        n = 0;
+    }
+
+    __compiler_barrier();
+    log_tail = head;
+
+    return n;
+}
@@ -0,0 +1,104 @@
+#ifndef __LOG_H__
+#define __LOG_H__
+
+#include <stdint.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dwt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Deferred-format binary logging.
+ *
+ *     LOG("adc %u overrun on seq %u", count, seq);
+ *
+ * The format string (prefixed with file:line) is placed in the .logfmt
+ * section, which is kept in demo.elf but never loaded onto the target. At
+ * runtime only a header word holding the string's offset in that section,
+ * a DWT cycle timestamp and the raw arguments are written to a RAM ring,
+ * which makes LOG() cheap enough to call from interrupts.
+ *
+ * log_flush() drains the ring through _write as binary frames, which
+ * tools/logdecode.py turns back into text using demo.elf. Arguments are
+ * passed as 32-bit words: integers, chars and pointers work, %s only
+ * decodes pointers into flash, floats are not supported.
+ */
+
+// Ring size in 32-bit words, must be a power of two
+#ifndef LOG_BUF_WORDS
+#define LOG_BUF_WORDS 256
+#endif
+
+// Frame marker, "LOG1" on the wire
+#define LOG_FRAME_MAGIC 0x31474F4C
+
+#define LOG_MAX_ARGS 4
+
+extern uint32_t log_buf[LOG_BUF_WORDS];
+extern volatile uint32_t log_head;
+extern volatile uint32_t log_tail;
+extern volatile uint32_t log_dropped;
+
+#define LOG_STR_(x) #x
+#define LOG_STR(x)  LOG_STR_(x)
+
+// Count 0 to LOG_MAX_ARGS variadic arguments
+#define LOG_NARGS(...)  LOG_NARGS_(0, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, n, ...) n
+
+#define LOG_ARG(...)    LOG_ARG_(0, ##__VA_ARGS__, 0, 0, 0, 0)
+#define LOG_ARG_(_0, a0, a1, a2, a3, ...)                                   \
+    (uint32_t)(uintptr_t)(a0), (uint32_t)(uintptr_t)(a1),                   \
+    (uint32_t)(uintptr_t)(a2), (uint32_t)(uintptr_t)(a3)
+
+#define LOG(fmt, ...) do {                                                  \
+        static const char log_fmt_[] __section(".logfmt") =                 \
+            __FILE__ ":" LOG_STR(__LINE__) "\0" fmt;                        \
+        log_record((uint32_t)(uintptr_t)log_fmt_,                           \
+                   LOG_NARGS(__VA_ARGS__), LOG_ARG(__VA_ARGS__));           \
+    } while(0)
+
+// Header word: string offset in the low 24 bits, argument count above
+static __always_inline void log_record(uint32_t id, uint32_t n,
+                                       uint32_t a0, uint32_t a1,
+                                       uint32_t a2, uint32_t a3) {
+    uint32_t primask = cpu_irq_save();
+    uint32_t head = log_head;
+
+    if(LOG_BUF_WORDS - (head - log_tail) < n + 2) {
+        log_dropped++;
+    } else {
+        // n is a constant here, so the unused stores fold away
+        log_buf[(head + 0) & (LOG_BUF_WORDS - 1)] = (id & 0x00FFFFFF) | (n << 24);
+        log_buf[(head + 1) & (LOG_BUF_WORDS - 1)] = dwt_cycles();
+        if(n > 0) log_buf[(head + 2) & (LOG_BUF_WORDS - 1)] = a0;
+        if(n > 1) log_buf[(head + 3) & (LOG_BUF_WORDS - 1)] = a1;
+        if(n > 2) log_buf[(head + 4) & (LOG_BUF_WORDS - 1)] = a2;
+        if(n > 3) log_buf[(head + 5) & (LOG_BUF_WORDS - 1)] = a3;
+        log_head = head + n + 2;
+    }
+
+    cpu_irq_restore(primask);
+}
+
+// Start the timestamp counter
+void log_init(void);
+
+// Write everything logged so far to _write as one frame. Call from the
+// main loop, not from interrupts. Returns the number of words sent. If
+// _write fails or comes up short on the header nothing is consumed and
+// the next flush tries again; if it does on the records they are counted
+// in log_dropped, and the decoder skips the broken frame. A frame the
+// UART takes whole and later overwrites (UART_OVERFLOW_OVERWRITE) is
+// skipped by the decoder too, but its records are not counted
+uint32_t log_flush(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -22,30 +22,55 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include <inc/hw_types.h>
-#include <driverlib/gpio.h>
+#include <inc/hw_memmap.h>
+#include <driverlib/rom.h>
 #include <driverlib/rom_map.h>
-#include <driverlib/sysctl.h>
+#include <driverlib/watchdog.h>
 
 #include "gpiopin.h"
+#include "evloop.h"
+#include "log.h"
+#include "uart.h"
+#include "startup.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef StaticGPIOPin<5, 2> BlueLED;
+
+static void blink(void *ctx) {
+    BlueLED::toggle();
+
+    // Feed the watchdog started by wdt_init, which leaves it locked
+    MAP_WatchdogUnlock(WATCHDOG0_BASE);
+    MAP_WatchdogIntClear(WATCHDOG0_BASE);
+    MAP_WatchdogLock(WATCHDOG0_BASE);
+}
+
 int main(void) {
+    static evloop_timer_t blink_timer;
+
+    // Logs go out on UART1, which stays unclocked until this
+    uart_init(115200);
+
+    // Report boot time
+    LOG("reset to main: %u cycles", startup_cycles);
+    log_flush();
+
     // Configure GPIO
-    GPIOPin blue_led = GPIOPin(5, 2);
-    blue_led.set_direction(GPIO_PIN_DIR_OUT);
-
-    while(1)
-    {
-        // Blink the BLUE LED
-        MAP_SysCtlDelay(MAP_SysCtlClockGet() / 10 / 3);
-        blue_led = 1;
-        MAP_SysCtlDelay(MAP_SysCtlClockGet() / 10 / 3);
-        blue_led = 0;
-    }
+    BlueLED::init(GPIO_PIN_DIR_OUT);
+
+    // Blink the BLUE LED
+    evloop_init();
+    evloop_timer_init(&blink_timer, blink, NULL);
+    evloop_timer_start(&blink_timer, 100000, 100000);
+
+    evloop_run();
+
+    while(1);
 }
 
 #ifdef __cplusplus
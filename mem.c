@@ -0,0 +1,92 @@
+#include <stdint.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sys/types.h>
+#include <inc/hw_types.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/mpu.h>
+
+#include "compiler.h"
+#include "mem.h"
+
+// Highest MPU region, so it wins over any region set up later
+#define MEM_GUARD_REGION    7
+
+// Linker defined symbols, see sections.ld
+extern uint32_t _end;
+extern uint32_t _stack_top;
+extern uint32_t _stack_limit;
+extern uint32_t _stack_guard;
+extern uint32_t _stack_guard_size;
+extern uint32_t _heap_limit;
+
+static char *heap_end;
+
+void mem_paint(uint32_t *start, uint32_t *end) {
+    while(start < end) {
+        *start++ = MEM_PAINT;
+    }
+}
+
+uint32_t mem_painted_used(const uint32_t *start, const uint32_t *end) {
+    const uint32_t *p = start;
+
+    while(p < end && *p == MEM_PAINT) {
+        p++;
+    }
+
+    return (uint32_t)((const char *)end - (const char *)p);
+}
+
+uint32_t mem_stack_size(void) {
+    return (uint32_t)((char *)&_stack_top - (char *)&_stack_limit);
+}
+
+uint32_t mem_stack_peak(void) {
+    return mem_painted_used(&_stack_limit, &_stack_top);
+}
+
+uint32_t mem_heap_size(void) {
+    return (uint32_t)((char *)&_heap_limit - (char *)&_end);
+}
+
+uint32_t mem_heap_used(void) {
+    return heap_end ? (uint32_t)(heap_end - (char *)&_end) : 0;
+}
+
+void mem_guard_init(void) {
+    uint32_t size = (uint32_t)&_stack_guard_size;
+
+    // Region size field is log2(size) - 1. Privileged code has the default
+    // map everywhere else. The MPU is left off in HardFault, so the
+    // escalated fault can still stack its frame into the guard
+    MAP_MPURegionSet(MEM_GUARD_REGION, (uint32_t)&_stack_guard,
+                     ((__ctz(size) - 1) << 1)   |
+                     MPU_RGN_PERM_NOEXEC        |
+                     MPU_RGN_PERM_PRV_NO_USR_NO |
+                     MPU_RGN_ENABLE);
+    MAP_MPUEnable(MPU_CONFIG_PRIV_DEFAULT);
+}
+
+// Grows the heap up to the stack guard. Checking against the stack pointer
+// instead would be meaningless on a kernel thread stack
+caddr_t _sbrk(unsigned int incr)
+{
+    char *prev_heap_end;
+
+    if (heap_end == NULL) {
+        heap_end = (char *)&_end;
+    }
+
+    prev_heap_end = heap_end;
+
+    if (incr > (uint32_t)((char *)&_heap_limit - heap_end)) {
+        errno = ENOMEM;
+        return (caddr_t) -1;
+    }
+
+    heap_end += incr;
+
+    return (caddr_t)prev_heap_end;
+}
@@ -0,0 +1,46 @@
+#ifndef __MEM_H__
+#define __MEM_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * RAM usage telemetry and stack overflow guard.
+ *
+ * RAM is laid out by sections.ld as data, bss, heap growing up from _end,
+ * a small no-access guard and then the main stack of _stack_size bytes at
+ * the top. reset_handler paints everything from _end to the stack pointer
+ * with MEM_PAINT, so the deepest the stack has reached is the first word
+ * that no longer holds the pattern. Running the stack into the guard
+ * faults straight away instead of silently corrupting the heap.
+ */
+
+#define MEM_PAINT 0xC5C5C5C5
+
+// Fill words with MEM_PAINT
+void mem_paint(uint32_t *start, uint32_t *end);
+
+// Bytes from the top of [start, end) down to the last word that is not
+// MEM_PAINT, for stacks painted with mem_paint
+uint32_t mem_painted_used(const uint32_t *start, const uint32_t *end);
+
+// Main stack size and the most of it ever used
+uint32_t mem_stack_size(void);
+uint32_t mem_stack_peak(void);
+
+// Heap space between _end and the guard, and how much _sbrk has handed
+// out. newlib never gives memory back, so the current size is the peak
+uint32_t mem_heap_size(void);
+uint32_t mem_heap_used(void);
+
+// Map the guard below the main stack as no-access. Called by reset_handler
+void mem_guard_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
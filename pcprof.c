@@ -0,0 +1,162 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_timer.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+
+#include "compiler.h"
+#include "pcprof.h"
+
+#define PCPROF_TIMER_BASE   WTIMER5_BASE
+#define PCPROF_TIMER_PERIPH SYSCTL_PERIPH_WTIMER5
+#define PCPROF_TIMER_INT    INT_WTIMER5A
+
+// Probe this many slots before giving up on a sample
+#define PCPROF_MAX_PROBE    8
+
+#if (PCPROF_SLOTS & (PCPROF_SLOTS - 1))
+#error "PCPROF_SLOTS must be a power of two"
+#endif
+
+typedef struct {
+    uint32_t addr;
+    uint32_t count;
+} pcprof_slot_t;
+
+static pcprof_slot_t pcprof_pc[PCPROF_SLOTS];
+static pcprof_slot_t pcprof_lr[PCPROF_SLOTS];
+static uint32_t pcprof_samples;
+static uint32_t pcprof_dropped;
+
+// Sampling rate while running, 0 when stopped. The rate of the last run
+// is kept for pcprof_dump()
+static uint32_t pcprof_hz;
+static uint32_t pcprof_rate;
+
+// Called from the naked handler with the interrupted exception frame
+void pcprof_sample(uint32_t *frame);
+
+static uint32_t pcprof_insert(pcprof_slot_t *table, uint32_t addr) {
+    // Fibonacci hash of the halfword address
+    uint32_t i = ((addr >> 1) * 2654435761u) >> (32 - __ctz(PCPROF_SLOTS));
+    uint32_t n;
+
+    for(n = 0; n < PCPROF_MAX_PROBE; n++) {
+        pcprof_slot_t *slot = &table[(i + n) & (PCPROF_SLOTS - 1)];
+
+        if(slot->addr == addr) {
+            slot->count++;
+            return 1;
+        }
+        if(slot->count == 0) {
+            slot->addr  = addr;
+            slot->count = 1;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+void pcprof_sample(uint32_t *frame) {
+    // Basic frame: r0-r3, r12, lr, pc, xpsr
+    uint32_t lr = frame[5] & ~1u;
+    uint32_t pc = frame[6] & ~1u;
+
+    HWREG(PCPROF_TIMER_BASE + TIMER_O_ICR) = TIMER_TIMA_TIMEOUT;
+
+    pcprof_samples++;
+    if(!pcprof_insert(pcprof_pc, pc)) {
+        pcprof_dropped++;
+    }
+    pcprof_insert(pcprof_lr, lr);
+}
+
+// Bound into nvic_table by name. Finds the frame on whichever stack the
+// interrupted code was using
+__naked void wtimer5a_handler(void) {
+    __asm__ __volatile__(
+        "tst    lr, #4          \n"
+        "ite    eq              \n"
+        "mrseq  r0, msp         \n"
+        "mrsne  r0, psp         \n"
+        "b      pcprof_sample   \n"
+    );
+}
+
+int pcprof_start(uint32_t hz) {
+    uint32_t i, clock = MAP_SysCtlClockGet();
+
+    if(hz == 0 || hz > clock) {
+        return -1;
+    }
+
+    pcprof_stop();
+
+    for(i = 0; i < PCPROF_SLOTS; i++) {
+        pcprof_pc[i].addr = pcprof_pc[i].count = 0;
+        pcprof_lr[i].addr = pcprof_lr[i].count = 0;
+    }
+    pcprof_samples = 0;
+    pcprof_dropped = 0;
+    pcprof_rate = hz;
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(PCPROF_TIMER_PERIPH);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_TimerConfigure(PCPROF_TIMER_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_A_PERIODIC);
+    MAP_TimerLoadSet(PCPROF_TIMER_BASE, TIMER_A, clock / hz - 1);
+    MAP_TimerIntEnable(PCPROF_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntPrioritySet(PCPROF_TIMER_INT, 0x00);
+    MAP_IntEnable(PCPROF_TIMER_INT);
+    pcprof_hz = hz;
+    MAP_TimerEnable(PCPROF_TIMER_BASE, TIMER_A);
+
+    return 0;
+}
+
+void pcprof_stop(void) {
+    if(pcprof_hz) {
+        MAP_TimerDisable(PCPROF_TIMER_BASE, TIMER_A);
+        MAP_IntDisable(PCPROF_TIMER_INT);
+        pcprof_hz = 0;
+    }
+}
+
+void pcprof_dump(void) {
+    uint32_t i;
+    bool running = pcprof_hz != 0;
+
+    if(running) {
+        MAP_TimerDisable(PCPROF_TIMER_BASE, TIMER_A);
+    }
+
+    // Line format read by tools/pcprof.py
+    printf("PCPROF %lu %lu %lu\n", (unsigned long)pcprof_rate,
+           (unsigned long)pcprof_samples, (unsigned long)pcprof_dropped);
+    for(i = 0; i < PCPROF_SLOTS; i++) {
+        if(pcprof_pc[i].count) {
+            printf("P %08lx %lu\n", (unsigned long)pcprof_pc[i].addr, (unsigned long)pcprof_pc[i].count);
+        }
+    }
+    for(i = 0; i < PCPROF_SLOTS; i++) {
+        if(pcprof_lr[i].count) {
+            printf("L %08lx %lu\n", (unsigned long)pcprof_lr[i].addr, (unsigned long)pcprof_lr[i].count);
+        }
+    }
+    printf("END\n");
+
+    if(running) {
+        MAP_TimerEnable(PCPROF_TIMER_BASE, TIMER_A);
+    }
+}
@@ -0,0 +1,42 @@
+#ifndef __PCPROF_H__
+#define __PCPROF_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Statistical PC-sampling profiler. Wide timer 5A interrupts at a fixed
+ * rate and records the stacked PC and LR of whatever it interrupted into
+ * two small hash histograms. LR is only a hint at the caller: it is exact
+ * for leaf functions and stale for code that has reused it.
+ *
+ * pcprof_dump() prints the histograms through stdout; feed that to
+ * tools/pcprof.py with build/demo.elf to get a flat profile.
+ *
+ * The sampling interrupt runs at the highest priority so it can land in
+ * other handlers; those need a lower (numerically higher) priority to
+ * show up. Overhead scales with the sampling rate.
+ */
+
+// Slots per histogram, must be a power of two
+#ifndef PCPROF_SLOTS
+#define PCPROF_SLOTS 256
+#endif
+
+// Start sampling hz times per second. Clears previous results. Returns -1
+// if hz is 0 or above the core clock, otherwise 0
+int pcprof_start(uint32_t hz);
+
+void pcprof_stop(void);
+
+// Print the histograms. Sampling is paused while printing
+void pcprof_dump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
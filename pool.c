@@ -0,0 +1,178 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "pool.h"
+
+#define POOL_COUNT(size, count)     + 1
+#define POOL_BYTES(size, count)     + (size) * (count)
+#define POOL_INIT(size, count)      { size, count },
+
+#define POOL_NUM_CLASSES    (0 POOL_CLASSES(POOL_COUNT))
+#define POOL_ARENA_BYTES    (0 POOL_CLASSES(POOL_BYTES))
+
+typedef struct pool_block {
+    struct pool_block *next;
+} pool_block_t;
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t blocks;
+    uint8_t *start;             // first block
+    uint8_t *end;               // one past the last block
+    uint8_t *fresh;             // blocks from here on have never been used
+    pool_block_t *free;
+    pool_stats_t stats;
+} pool_class_t;
+
+static uint8_t pool_arena[POOL_ARENA_BYTES] __aligned(8);
+
+static pool_class_t pool_classes[POOL_NUM_CLASSES] = {
+    POOL_CLASSES(POOL_INIT)
+};
+
+static bool pool_ready;
+static uint32_t pool_heap_count;
+static uint32_t pool_fail_count;
+
+// Carve the arena into classes. Blocks are not threaded onto the free
+// lists here; untouched ones are handed out from 'fresh' instead
+static void pool_init(void) {
+    uint8_t *p = pool_arena;
+    uint32_t i;
+
+    for(i = 0; i < POOL_NUM_CLASSES; i++) {
+        pool_class_t *cls = &pool_classes[i];
+
+        cls->start = cls->fresh = p;
+        p += cls->block_size * cls->blocks;
+        cls->end = p;
+        cls->free = NULL;
+        cls->stats.block_size = cls->block_size;
+        cls->stats.blocks = cls->blocks;
+    }
+
+    pool_ready = true;
+}
+
+void *pool_alloc(size_t size) {
+    uint32_t primask = cpu_irq_save();
+    pool_class_t *cls = NULL;
+    void *block = NULL;
+    uint32_t i;
+
+    if(!pool_ready) {
+        pool_init();
+    }
+
+    for(i = 0; i < POOL_NUM_CLASSES; i++) {
+        if(size <= pool_classes[i].block_size) {
+            cls = &pool_classes[i];
+            break;
+        }
+    }
+
+    if(cls) {
+        if(cls->free) {
+            block = cls->free;
+            cls->free = cls->free->next;
+        } else if(cls->fresh < cls->end) {
+            block = cls->fresh;
+            cls->fresh += cls->block_size;
+        }
+
+        if(block) {
+            cls->stats.allocs++;
+            if(++cls->stats.used > cls->stats.high_water) {
+                cls->stats.high_water = cls->stats.used;
+            }
+        } else {
+            cls->stats.exhausted++;
+        }
+    }
+
+    cpu_irq_restore(primask);
+
+    if(block) {
+        return block;
+    }
+
+#if POOL_HEAP_FALLBACK
+    // malloc takes newlib's lock hooks, which do nothing here, so it is
+    // not safe against interrupts
+    if(!cpu_in_isr()) {
+        block = malloc(size);
+    }
+#endif
+
+    primask = cpu_irq_save();
+    if(block) {
+        pool_heap_count++;
+    } else {
+        pool_fail_count++;
+    }
+    cpu_irq_restore(primask);
+
+    return block;
+}
+
+void pool_free(void *ptr) {
+    uint8_t *p = ptr;
+    uint32_t primask;
+    uint32_t i;
+
+    if(p < pool_arena || p >= pool_arena + sizeof(pool_arena)) {
+        // NULL lands here too; free() ignores it
+        free(ptr);
+        return;
+    }
+
+    primask = cpu_irq_save();
+
+    for(i = 0; i < POOL_NUM_CLASSES; i++) {
+        pool_class_t *cls = &pool_classes[i];
+
+        if(p < cls->end) {
+            pool_block_t *block = ptr;
+
+            block->next = cls->free;
+            cls->free = block;
+            cls->stats.used--;
+            break;
+        }
+    }
+
+    cpu_irq_restore(primask);
+}
+
+uint32_t pool_num_classes(void) {
+    return POOL_NUM_CLASSES;
+}
+
+int pool_stats_get(uint32_t cls, pool_stats_t *stats) {
+    uint32_t primask;
+
+    if(cls >= POOL_NUM_CLASSES) {
+        return -1;
+    }
+
+    primask = cpu_irq_save();
+    if(!pool_ready) {
+        pool_init();
+    }
+    *stats = pool_classes[cls].stats;
+    cpu_irq_restore(primask);
+
+    return 0;
+}
+
+uint32_t pool_heap_allocs(void) {
+    return pool_heap_count;
+}
+
+uint32_t pool_failures(void) {
+    return pool_fail_count;
+}
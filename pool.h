@@ -0,0 +1,64 @@
+#ifndef __POOL_H__
+#define __POOL_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Fixed block allocator behind operator new/delete.
+ *
+ * Each size class is a statically reserved array of equal blocks with its
+ * own free list, so pool_alloc() and pool_free() are constant time, never
+ * fragment and are safe to call from interrupts. A request goes to the
+ * smallest class it fits. When that class is empty or the request is too
+ * large it falls back to malloc() if POOL_HEAP_FALLBACK is set, except in
+ * interrupt context where it fails instead. Heap blocks must likewise not
+ * be freed from interrupts.
+ *
+ * Classes are listed as X(block_size, block_count). Block sizes must be
+ * multiples of 8 and in increasing order.
+ */
+#ifndef POOL_CLASSES
+#define POOL_CLASSES(X) \
+    X(16,  32)          \
+    X(32,  32)          \
+    X(64,  16)          \
+    X(128, 8)
+#endif
+
+#ifndef POOL_HEAP_FALLBACK
+#define POOL_HEAP_FALLBACK 1
+#endif
+
+typedef struct {
+    uint32_t block_size;
+    uint32_t blocks;
+    uint32_t used;              // blocks allocated now
+    uint32_t high_water;        // most blocks ever allocated at once
+    uint32_t allocs;            // successful allocations
+    uint32_t exhausted;         // requests for this class it could not serve
+} pool_stats_t;
+
+void *pool_alloc(size_t size);
+
+// Accepts pointers from either the pools or the heap fallback, and NULL
+void pool_free(void *ptr);
+
+uint32_t pool_num_classes(void);
+
+// Returns 0 on success, -1 for a bad class number
+int pool_stats_get(uint32_t cls, pool_stats_t *stats);
+
+// Allocations handed to malloc() and ones that failed outright
+uint32_t pool_heap_allocs(void);
+uint32_t pool_failures(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
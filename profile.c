@@ -0,0 +1,91 @@
+#include <stdint.h>
+#include <stdio.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "profile.h"
+
+// Linker defined sections
+extern profile_zone_t __profile_zones_start[];
+extern profile_zone_t __profile_zones_end[];
+
+// Cost of the two counter reads around an empty zone
+static uint32_t profile_bias;
+
+void profile_init(void) {
+    uint32_t start, cycles;
+
+    dwt_init();
+
+    start = dwt_cycles();
+    __compiler_barrier();
+    cycles = dwt_cycles() - start;
+
+    profile_bias = cycles;
+}
+
+void profile_record(profile_zone_t *zone, uint32_t cycles) {
+    uint32_t primask;
+    uint32_t bucket;
+
+    cycles = (cycles > profile_bias) ? cycles - profile_bias : 0;
+    bucket = cycles ? 31 - __clz(cycles) : 0;
+
+    // Zones may be shared between thread and interrupt code
+    primask = cpu_irq_save();
+
+    zone->count++;
+    zone->total += cycles;
+    if(cycles < zone->min) {
+        zone->min = cycles;
+    }
+    if(cycles > zone->max) {
+        zone->max = cycles;
+    }
+    zone->hist[bucket]++;
+
+    cpu_irq_restore(primask);
+}
+
+void profile_dump(void) {
+    profile_zone_t *zone;
+    uint32_t i;
+
+    printf("%-20s %10s %10s %10s %10s\n", "zone", "count", "min", "max", "mean");
+
+    for(zone = __profile_zones_start; zone < __profile_zones_end; zone++) {
+        if(zone->count == 0) {
+            printf("%-20s %10u\n", zone->name, 0u);
+            continue;
+        }
+
+        printf("%-20s %10lu %10lu %10lu %10lu\n", zone->name,
+               (unsigned long)zone->count, (unsigned long)zone->min,
+               (unsigned long)zone->max, (unsigned long)(zone->total / zone->count));
+
+        // Non-empty histogram buckets as "low+: count"
+        for(i = 0; i < PROFILE_HIST_BUCKETS; i++) {
+            if(zone->hist[i]) {
+                printf("    %10lu+: %lu\n", i ? 1UL << i : 0UL, (unsigned long)zone->hist[i]);
+            }
+        }
+    }
+}
+
+void profile_reset(void) {
+    profile_zone_t *zone;
+    uint32_t i;
+    uint32_t primask = cpu_irq_save();
+
+    for(zone = __profile_zones_start; zone < __profile_zones_end; zone++) {
+        zone->count = 0;
+        zone->min   = UINT32_MAX;
+        zone->max   = 0;
+        zone->total = 0;
+        for(i = 0; i < PROFILE_HIST_BUCKETS; i++) {
+            zone->hist[i] = 0;
+        }
+    }
+
+    cpu_irq_restore(primask);
+}
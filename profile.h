@@ -0,0 +1,106 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <stdint.h>
+
+#include "compiler.h"
+#include "dwt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cycle-count profiling zones. Each zone keeps count, min/max/total and a
+ * log2 histogram of its DWT cycle counts, bucket n counting runs of
+ * 2^n to 2^(n+1)-1 cycles. Zones are static and collected into the
+ * .profile_zones section, so profile_dump() finds them all without any
+ * registration.
+ *
+ *     void foo(void) {                     void Bar::baz() {
+ *         PROFILE_BEGIN(foo_loop);             PROFILE_SCOPE(baz);
+ *         ...                                  ...
+ *         PROFILE_END(foo_loop);           }
+ *     }
+ *
+ * Build with PROFILE_ENABLE=1 to turn it on. Otherwise the macros expand
+ * to nothing and no code or data is left behind.
+ */
+#ifndef PROFILE_ENABLE
+#define PROFILE_ENABLE 0
+#endif
+
+#define PROFILE_HIST_BUCKETS 32
+
+typedef struct {
+    const char *name;
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t hist[PROFILE_HIST_BUCKETS];
+} profile_zone_t;
+
+// Start the cycle counter and measure the cost of an empty zone, which is
+// subtracted from every sample
+void profile_init(void);
+
+// Print every zone through stdout
+void profile_dump(void);
+
+// Clear every zone
+void profile_reset(void);
+
+void profile_record(profile_zone_t *zone, uint32_t cycles);
+
+#if PROFILE_ENABLE
+
+#define PROFILE_ZONE_(name)                                                 \
+    static profile_zone_t profile_zone_##name __section(".profile_zones") = \
+        { #name, 0, UINT32_MAX, 0, 0, {0} }
+
+#define PROFILE_BEGIN(name)                                                 \
+    PROFILE_ZONE_(name);                                                    \
+    uint32_t profile_start_##name = dwt_cycles()
+
+#define PROFILE_END(name)                                                   \
+    profile_record(&profile_zone_##name, dwt_cycles() - profile_start_##name)
+
+#else
+
+#define PROFILE_BEGIN(name)
+#define PROFILE_END(name)
+
+#endif
+
+#ifdef __cplusplus
+}
+
+#if PROFILE_ENABLE
+
+// Records the cycles between construction and the end of the scope
+class ProfileScope {
+  private:
+    profile_zone_t *zone;
+    uint32_t start;
+
+  public:
+    __always_inline ProfileScope(profile_zone_t *_zone) : zone(_zone), start(dwt_cycles()) {}
+    __always_inline ~ProfileScope() {
+        profile_record(zone, dwt_cycles() - start);
+    }
+};
+
+#define PROFILE_SCOPE(name)                                                 \
+    PROFILE_ZONE_(name);                                                    \
+    ProfileScope profile_scope_##name(&profile_zone_##name)
+
+#else
+
+#define PROFILE_SCOPE(name)
+
+#endif
+
+#endif
+
+#endif
@@ -0,0 +1,387 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inc/hw_types.h>
+#include <inc/hw_nvic.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+
+#include "compiler.h"
+#include "dsp.h"
+#include "dwt.h"
+#include "pool.h"
+#include "startup.h"
+
+/*
+ * Benchmark image for QEMU's lm3s6965evb, built and run by make bench-qemu.
+ * make bench-qemu-m4 builds the same image with QEMU_MPS2 for a Cortex-M4
+ * with FPU on QEMU's mps2-an386, so the DSP extension and FPU paths of
+ * dsp.c get built and checked too. That board has no Stellaris system
+ * control and no free interrupt line, so it runs everything but the
+ * interrupt benchmarks.
+ *
+ * Everything is reported over semihosting, one line per benchmark:
+ *
+ *     HZ <core clock>
+ *     BENCH <name> <iterations> <ticks>
+ *     DONE <failures>
+ *
+ * ticks are SysTick counts at the core clock (see dwt.h) with the cost of
+ * an empty measurement taken off. QEMU runs with -icount, which makes
+ * virtual time, and so SysTick, a fixed function of instructions executed.
+ * The counts are exactly repeatable and track instruction count, not
+ * pipeline or flash wait state timing. tools/benchqemu.py turns them into
+ * instructions per iteration.
+ */
+
+// Iterations per benchmark. Each run must stay under 2^24 ticks
+#define BENCH_REPS          64
+
+// Unused on the LM3S6965 and not wired up by QEMU, so free for a
+// software triggered interrupt
+#define BENCH_IRQ           (62 - 16)
+
+// Core clock QEMU gives the MPS2 boards
+#define BENCH_MPS2_HZ       25000000
+
+// Semihosting operations
+#define SEMIHOST_WRITE0     0x04
+#define SEMIHOST_EXIT       0x18
+
+#define ADP_STOPPED_EXIT    0x20026
+#define ADP_STOPPED_ERROR   0x20023
+
+static uint32_t bench_overhead;
+static uint32_t bench_failures;
+
+static volatile uint32_t bench_isr_count;
+static volatile uint32_t bench_isr_entry;
+
+static uint8_t bench_src[1024 + 8] __aligned(8);
+static uint8_t bench_dst[1024 + 8] __aligned(8);
+
+// Called through pointers so the compiler cannot inline or fold them
+static void *(*volatile bench_memcpy)(void *, const void *, size_t) = memcpy;
+static void *(*volatile bench_memset)(void *, int, size_t) = memset;
+
+static uint32_t semihost(uint32_t op, const void *arg) {
+    register uint32_t r0 __asm__("r0") = op;
+    register const void *r1 __asm__("r1") = arg;
+
+    __asm__ __volatile__("bkpt 0xAB" : "+r" (r0) : "r" (r1) : "memory");
+    return r0;
+}
+
+static void bench_puts(const char *s) {
+    semihost(SEMIHOST_WRITE0, s);
+}
+
+static void bench_putu(uint32_t x) {
+    char buf[11];
+    char *p = &buf[10];
+
+    *p = '\0';
+    do {
+        *--p = '0' + x % 10;
+        x /= 10;
+    } while(x);
+
+    bench_puts(p);
+}
+
+static void bench_check(bool ok, const char *what) {
+    if(!ok) {
+        bench_puts("FAIL ");
+        bench_puts(what);
+        bench_puts("\n");
+        bench_failures++;
+    }
+}
+
+static __always_inline uint32_t bench_begin(void) {
+    return dwt_cycles();
+}
+
+static void bench_end(const char *name, uint32_t iterations, uint32_t start) {
+    uint32_t ticks = (dwt_cycles() - start) & DWT_CYCLES_MASK;
+
+    ticks = (ticks > bench_overhead) ? ticks - bench_overhead : 0;
+
+    bench_puts("BENCH ");
+    bench_puts(name);
+    bench_puts(" ");
+    bench_putu(iterations);
+    bench_puts(" ");
+    bench_putu(ticks);
+    bench_puts("\n");
+}
+
+#ifdef QEMU_MPS2
+// startup.c calls this before RAM is set up. The clock is fixed, but the
+// FPU must be on before any floating point code runs
+void clock_init(void) {
+    HWREG(NVIC_CPAC) |= NVIC_CPAC_CP10_FULL | NVIC_CPAC_CP11_FULL;
+    __asm__ __volatile__("dsb\n\tisb" ::: "memory");
+}
+
+static uint32_t bench_hz(void) {
+    return BENCH_MPS2_HZ;
+}
+#else
+// startup.c calls this before RAM is set up. 50MHz is the LM3S6965's
+// fastest clock and what QEMU assumes for this PLL setting
+void clock_init(void) {
+    MAP_SysCtlClockSet(SYSCTL_SYSDIV_4   |
+                       SYSCTL_USE_PLL    |
+                       SYSCTL_XTAL_8MHZ  |
+                       SYSCTL_OSC_MAIN);
+}
+
+static uint32_t bench_hz(void) {
+    return MAP_SysCtlClockGet();
+}
+#endif
+
+// Bound into nvic_table by name
+void udma_sw_handler(void) {
+    bench_isr_entry = dwt_cycles();
+    bench_isr_count++;
+}
+
+static void bench_boot(void) {
+    bench_puts("BENCH boot 1 ");
+    bench_putu(startup_cycles);
+    bench_puts("\n");
+}
+
+#ifndef QEMU_MPS2
+static void bench_isr(void) {
+    uint32_t i, start, trigger, latency = 0;
+
+    HWREG(NVIC_EN0 + (BENCH_IRQ / 32) * 4) = 1 << (BENCH_IRQ % 32);
+
+    // Trigger, entry, handler, return
+    bench_isr_count = 0;
+    start = bench_begin();
+    for(i = 0; i < BENCH_REPS; i++) {
+        HWREG(NVIC_SW_TRIG) = BENCH_IRQ;
+        __asm__ __volatile__("dsb\n\tisb" ::: "memory");
+    }
+    bench_end("isr_roundtrip", BENCH_REPS, start);
+    bench_check(bench_isr_count == BENCH_REPS, "isr_roundtrip count");
+
+    // Trigger to first instruction of the handler
+    for(i = 0; i < BENCH_REPS; i++) {
+        trigger = dwt_cycles();
+        HWREG(NVIC_SW_TRIG) = BENCH_IRQ;
+        __asm__ __volatile__("dsb\n\tisb" ::: "memory");
+        latency += (bench_isr_entry - trigger) & DWT_CYCLES_MASK;
+    }
+    bench_puts("BENCH isr_entry ");
+    bench_putu(BENCH_REPS);
+    bench_puts(" ");
+    bench_putu(latency);
+    bench_puts("\n");
+
+    HWREG(NVIC_DIS0 + (BENCH_IRQ / 32) * 4) = 1 << (BENCH_IRQ % 32);
+}
+#endif
+
+static void bench_mem(void) {
+    static const struct {
+        const char *copy;
+        const char *fill;
+        uint32_t len;
+        uint32_t offset;
+    } cases[] = {
+        {"memcpy_16",        "memset_16",        16,   0},
+        {"memcpy_64",        "memset_64",        64,   0},
+        {"memcpy_256",       "memset_256",       256,  0},
+        {"memcpy_1024",      "memset_1024",      1024, 0},
+        {"memcpy_16_odd",    "memset_16_odd",    16,   1},
+        {"memcpy_256_odd",   "memset_256_odd",   256,  1},
+        {"memcpy_1024_odd",  "memset_1024_odd",  1024, 1},
+    };
+    uint32_t c, i, start;
+
+    for(i = 0; i < sizeof(bench_src); i++) {
+        bench_src[i] = (uint8_t)(i * 7);
+    }
+
+    for(c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+        uint8_t *dst = bench_dst + cases[c].offset;
+        uint32_t len = cases[c].len;
+
+        // Misaligned cases offset the source by a different amount, so
+        // the two pointers cannot be brought into alignment together
+        const uint8_t *src = bench_src + cases[c].offset * 2;
+
+        start = bench_begin();
+        for(i = 0; i < BENCH_REPS; i++) {
+            bench_memcpy(dst, src, len);
+        }
+        bench_end(cases[c].copy, BENCH_REPS, start);
+        bench_check(memcmp(dst, src, len) == 0, cases[c].copy);
+
+        start = bench_begin();
+        for(i = 0; i < BENCH_REPS; i++) {
+            bench_memset(dst, 0x5A, len);
+        }
+        bench_end(cases[c].fill, BENCH_REPS, start);
+        bench_check(dst[0] == 0x5A && dst[len - 1] == 0x5A, cases[c].fill);
+    }
+}
+
+static void bench_alloc(void) {
+    static const struct {
+        const char *pool;
+        const char *heap;
+        uint32_t size;
+    } cases[] = {
+        {"pool_16",  "malloc_16",  16},
+        {"pool_64",  "malloc_64",  64},
+        {"pool_128", "malloc_128", 128},
+    };
+    void *p[8];
+    uint32_t c, i, j, start;
+
+    for(c = 0; c < sizeof(cases) / sizeof(*cases); c++) {
+        // Eight live blocks at a time, freed in allocation order
+        start = bench_begin();
+        for(i = 0; i < BENCH_REPS / 8; i++) {
+            for(j = 0; j < 8; j++) {
+                p[j] = pool_alloc(cases[c].size);
+            }
+            for(j = 0; j < 8; j++) {
+                pool_free(p[j]);
+            }
+        }
+        bench_end(cases[c].pool, BENCH_REPS, start);
+        bench_check(p[7] != NULL, cases[c].pool);
+
+        start = bench_begin();
+        for(i = 0; i < BENCH_REPS / 8; i++) {
+            for(j = 0; j < 8; j++) {
+                p[j] = malloc(cases[c].size);
+            }
+            for(j = 0; j < 8; j++) {
+                free(p[j]);
+            }
+        }
+        bench_end(cases[c].heap, BENCH_REPS, start);
+        bench_check(p[7] != NULL, cases[c].heap);
+    }
+
+    bench_check(pool_failures() == 0, "pool_failures");
+}
+
+// Per sample cost of the DSP kernels, checked against the reference
+// versions. The M3 image runs the portable C paths, the M4 one the DSP
+// extension and FPU paths
+static void bench_dsp(void) {
+    static q15_t x[256], y[256], ref[256];
+    static q15_t h[32], state[DSP_FIR_STATE_LEN(32, 64)];
+    static float xf[256], yf[256], reff[256];
+    static float twiddle[DSP_RFFT_TWIDDLE_LEN(256)];
+    static const q15_t bq15[10] = {
+        1106, 2211, 1106, -18727, 6763,
+        4799, 9598, 4799,      0, 2811,
+    };
+    static const float bqf[10] = {
+        0.0675f, 0.1349f, 0.0675f, -1.1430f, 0.4128f,
+        0.2929f, 0.5858f, 0.2929f, -0.0000f, 0.1716f,
+    };
+    q15_t bq_state15[8];
+    float bq_state[4];
+    dsp_fir_q15_t fir;
+    dsp_biquad_q15_t bq15s;
+    dsp_biquad_f32_t bq;
+    dsp_rfft_f32_t fft;
+    uint32_t i, start, seed = 12345;
+    int64_t dot;
+
+    for(i = 0; i < 256; i++) {
+        seed = seed * 1664525 + 1013904223;
+        x[i] = (int32_t)seed >> 16;
+        xf[i] = x[i] * (1.0f / 32768.0f);
+    }
+    for(i = 0; i < 32; i++) {
+        h[i] = x[i] >> 4;
+    }
+
+    start = bench_begin();
+    dsp_add_q15(x, &x[128], y, 128);
+    bench_end("dsp_add_q15", 128, start);
+    dsp_add_q15_ref(x, &x[128], ref, 128);
+    bench_check(memcmp(y, ref, 128 * sizeof(q15_t)) == 0, "dsp_add_q15");
+
+    start = bench_begin();
+    dsp_mul_q15(x, &x[128], y, 128);
+    bench_end("dsp_mul_q15", 128, start);
+    dsp_mul_q15_ref(x, &x[128], ref, 128);
+    bench_check(memcmp(y, ref, 128 * sizeof(q15_t)) == 0, "dsp_mul_q15");
+
+    start = bench_begin();
+    dot = dsp_dot_q15(x, &x[128], 128);
+    bench_end("dsp_dot_q15", 128, start);
+    bench_check(dot == dsp_dot_q15_ref(x, &x[128], 128), "dsp_dot_q15");
+
+    dsp_fir_q15_init(&fir, h, 32, state);
+    start = bench_begin();
+    for(i = 0; i < 256; i += 64) {
+        dsp_fir_q15(&fir, &x[i], &y[i], 64);
+    }
+    bench_end("dsp_fir_q15_32tap", 256, start);
+    dsp_fir_q15_ref(h, 32, x, ref, 256);
+    bench_check(memcmp(y, ref, sizeof(y)) == 0, "dsp_fir_q15_32tap");
+
+    dsp_biquad_q15_init(&bq15s, bq15, 2, 1, bq_state15);
+    start = bench_begin();
+    dsp_biquad_q15(&bq15s, x, y, 256);
+    bench_end("dsp_biquad_q15_2stage", 256, start);
+    dsp_biquad_q15_ref(bq15, 2, 1, x, ref, 256);
+    bench_check(memcmp(y, ref, sizeof(y)) == 0, "dsp_biquad_q15_2stage");
+
+    dsp_biquad_f32_init(&bq, bqf, 2, bq_state);
+    start = bench_begin();
+    dsp_biquad_f32(&bq, xf, yf, 256);
+    bench_end("dsp_biquad_f32_2stage", 256, start);
+    dsp_biquad_f32_ref(bqf, 2, xf, reff, 256);
+    bench_check(memcmp(yf, reff, sizeof(yf)) == 0, "dsp_biquad_f32_2stage");
+
+    bench_check(dsp_rfft_f32_init(&fft, 256, twiddle) == 0, "dsp_rfft_f32_init");
+    start = bench_begin();
+    dsp_rfft_f32(&fft, xf);
+    bench_end("dsp_rfft_f32_256", 1, start);
+}
+
+int main(void) {
+    uint32_t start;
+
+    // Cost of an empty measurement, taken off every result
+    bench_overhead = 0;
+    start = bench_begin();
+    bench_overhead = (dwt_cycles() - start) & DWT_CYCLES_MASK;
+
+    bench_puts("HZ ");
+    bench_putu(bench_hz());
+    bench_puts("\n");
+
+    bench_boot();
+#ifndef QEMU_MPS2
+    bench_isr();
+#endif
+    bench_mem();
+    bench_alloc();
+    bench_dsp();
+
+    bench_puts("DONE ");
+    bench_putu(bench_failures);
+    bench_puts("\n");
+
+    semihost(SEMIHOST_EXIT, (const void *)(bench_failures ? ADP_STOPPED_ERROR : ADP_STOPPED_EXIT));
+
+    for(;;);
+}
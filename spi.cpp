@@ -0,0 +1,326 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_ssi.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/ssi.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dma.h"
+#include "spi.h"
+
+// Longest uDMA transfer, longer SPI transfers go in pieces
+#define SPI_DMA_MAX             1024
+
+// uDMA channel number out of a uDMAChannelAssign() mapping
+#define SPI_DMA_CHANNEL(assign) ((assign) & 0xFF)
+
+typedef struct {
+    uint32_t base;
+    uint32_t periph;
+    uint32_t int_num;
+    uint32_t gpio_periph;
+    uint32_t gpio_base;
+    uint8_t pins;
+    uint32_t pin_config[3];
+    uint32_t rx_assign;
+    uint32_t tx_assign;
+
+    bool initialised;
+
+    // Transfers waiting, the head is the one on the bus
+    spi_xfer_t *head;
+    spi_xfer_t *tail;
+
+    // Words of the head transfer done, and in the uDMA piece under way
+    uint32_t pos;
+    uint32_t chunk;
+
+    // TX only transfer waiting for the shifter to empty
+    bool draining;
+
+    // Chip select left asserted by SPI_XFER_CS_HOLD
+    GPIOPin *cs_held;
+
+    // Settings the SSI was last configured with
+    uint32_t bit_rate;
+    uint8_t word_bits;
+    uint8_t mode;
+} spi_bus_t;
+
+static spi_bus_t spi_buses[SPI_BUSES] = {
+    {SSI0_BASE, SYSCTL_PERIPH_SSI0, INT_SSI0, SYSCTL_PERIPH_GPIOA, GPIO_PORTA_BASE,
+     GPIO_PIN_2 | GPIO_PIN_4 | GPIO_PIN_5, {GPIO_PA2_SSI0CLK, GPIO_PA4_SSI0RX, GPIO_PA5_SSI0TX},
+     UDMA_CH10_SSI0RX, UDMA_CH11_SSI0TX},
+    {SSI1_BASE, SYSCTL_PERIPH_SSI1, INT_SSI1, SYSCTL_PERIPH_GPIOD, GPIO_PORTD_BASE,
+     GPIO_PIN_0 | GPIO_PIN_2 | GPIO_PIN_3, {GPIO_PD0_SSI1CLK, GPIO_PD2_SSI1RX, GPIO_PD3_SSI1TX},
+     UDMA_CH24_SSI1RX, UDMA_CH25_SSI1TX},
+    {SSI2_BASE, SYSCTL_PERIPH_SSI2, INT_SSI2, SYSCTL_PERIPH_GPIOB, GPIO_PORTB_BASE,
+     GPIO_PIN_4 | GPIO_PIN_6 | GPIO_PIN_7, {GPIO_PB4_SSI2CLK, GPIO_PB6_SSI2RX, GPIO_PB7_SSI2TX},
+     UDMA_CH12_SSI2RX, UDMA_CH13_SSI2TX},
+};
+
+static const uint32_t spi_protocols[4] = {
+    SSI_FRF_MOTO_MODE_0, SSI_FRF_MOTO_MODE_1, SSI_FRF_MOTO_MODE_2, SSI_FRF_MOTO_MODE_3,
+};
+
+// Source for transfers without a TX buffer. In RAM, 8-bit words take the
+// low byte
+static uint16_t spi_fill = SPI_TX_FILL;
+
+void spi_init(uint32_t bus) {
+    spi_bus_t *b = &spi_buses[bus];
+    uint32_t rx = SPI_DMA_CHANNEL(b->rx_assign);
+    uint32_t tx = SPI_DMA_CHANNEL(b->tx_assign);
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(b->periph);
+    MAP_SysCtlPeripheralEnable(b->gpio_periph);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_GPIOPinConfigure(b->pin_config[0]);
+    MAP_GPIOPinConfigure(b->pin_config[1]);
+    MAP_GPIOPinConfigure(b->pin_config[2]);
+    MAP_GPIOPinTypeSSI(b->gpio_base, b->pins);
+
+    MAP_SSIDisable(b->base);
+    HWREG(b->base + SSI_O_DMACTL) = 0;
+    b->bit_rate = 0;
+
+    // RX outranks TX so the receive FIFO never overflows while both run
+    dma_init();
+    MAP_uDMAChannelAssign(b->rx_assign);
+    MAP_uDMAChannelAssign(b->tx_assign);
+    MAP_uDMAChannelAttributeDisable(rx, UDMA_ATTR_ALTSELECT | UDMA_ATTR_REQMASK | UDMA_ATTR_USEBURST);
+    MAP_uDMAChannelAttributeDisable(tx, UDMA_ATTR_ALTSELECT | UDMA_ATTR_REQMASK | UDMA_ATTR_USEBURST |
+                                    UDMA_ATTR_HIGH_PRIORITY);
+    MAP_uDMAChannelAttributeEnable(rx, UDMA_ATTR_HIGH_PRIORITY);
+
+    // Completions of either channel arrive on the SSI vector
+    MAP_IntEnable(b->int_num);
+    b->initialised = true;
+}
+
+// Reprogram the SSI only when the settings change from the last transfer
+static void spi_configure(spi_bus_t *b, const spi_xfer_t *x) {
+    if(x->bit_rate == b->bit_rate && x->word_bits == b->word_bits && x->mode == b->mode) {
+        return;
+    }
+
+    MAP_SSIDisable(b->base);
+    MAP_SSIConfigSetExpClk(b->base, MAP_SysCtlClockGet(), spi_protocols[x->mode], SSI_MODE_MASTER,
+                           x->bit_rate, x->word_bits);
+
+    // The TX interrupt means the shifter has finished, not FIFO space
+    HWREG(b->base + SSI_O_CR1) |= SSI_CR1_EOT;
+    MAP_SSIEnable(b->base);
+
+    b->bit_rate = x->bit_rate;
+    b->word_bits = x->word_bits;
+    b->mode = x->mode;
+}
+
+// Hand the next piece of the head transfer to uDMA
+static void spi_chunk(spi_bus_t *b) {
+    const spi_xfer_t *x = b->head;
+    uint32_t rx = SPI_DMA_CHANNEL(b->rx_assign);
+    uint32_t tx = SPI_DMA_CHANNEL(b->tx_assign);
+    bool wide = x->word_bits > 8;
+    uint32_t size = wide ? UDMA_SIZE_16 : UDMA_SIZE_8;
+    uint32_t inc = wide ? UDMA_SRC_INC_16 : UDMA_SRC_INC_8;
+    uint32_t offset = b->pos << wide;
+
+    b->chunk = x->len - b->pos;
+    if(b->chunk > SPI_DMA_MAX) {
+        b->chunk = SPI_DMA_MAX;
+    }
+
+    // Receive is armed first so no word can arrive before it is
+    if(x->rx) {
+        MAP_uDMAChannelControlSet(rx | UDMA_PRI_SELECT, size | UDMA_SRC_INC_NONE |
+                                  (wide ? UDMA_DST_INC_16 : UDMA_DST_INC_8) | UDMA_ARB_4);
+        MAP_uDMAChannelTransferSet(rx | UDMA_PRI_SELECT, UDMA_MODE_BASIC, (void *)(b->base + SSI_O_DR),
+                                   (uint8_t *)x->rx + offset, b->chunk);
+        MAP_uDMAChannelEnable(rx);
+    }
+
+    if(x->tx) {
+        MAP_uDMAChannelControlSet(tx | UDMA_PRI_SELECT, size | inc | UDMA_DST_INC_NONE | UDMA_ARB_4);
+        MAP_uDMAChannelTransferSet(tx | UDMA_PRI_SELECT, UDMA_MODE_BASIC, (uint8_t *)x->tx + offset,
+                                   (void *)(b->base + SSI_O_DR), b->chunk);
+    } else {
+        MAP_uDMAChannelControlSet(tx | UDMA_PRI_SELECT, size | UDMA_SRC_INC_NONE | UDMA_DST_INC_NONE |
+                                  UDMA_ARB_4);
+        MAP_uDMAChannelTransferSet(tx | UDMA_PRI_SELECT, UDMA_MODE_BASIC, &spi_fill,
+                                   (void *)(b->base + SSI_O_DR), b->chunk);
+    }
+    MAP_uDMAChannelEnable(tx);
+
+    HWREG(b->base + SSI_O_DMACTL) = SSI_DMACTL_TXDMAE | (x->rx ? SSI_DMACTL_RXDMAE : 0);
+}
+
+// Put the head transfer on the bus. Called with the bus interrupt unable
+// to run: masked, or from the handler itself
+static void spi_start(spi_bus_t *b) {
+    spi_xfer_t *x = b->head;
+
+    if(b->cs_held && b->cs_held != x->cs) {
+        b->cs_held->write(1);
+    }
+    b->cs_held = NULL;
+
+    // A marker moves no data, finish it from the handler in queue order
+    if(!x->len) {
+        MAP_IntPendSet(b->int_num);
+        return;
+    }
+
+    spi_configure(b, x);
+    if(x->cs) {
+        x->cs->write(0);
+    }
+
+    b->pos = 0;
+    b->draining = false;
+    spi_chunk(b);
+}
+
+int spi_submit(uint32_t bus, spi_xfer_t *xfer) {
+    spi_bus_t *b;
+    uint32_t primask;
+
+    if(bus >= SPI_BUSES || !spi_buses[bus].initialised || xfer->busy) {
+        return -1;
+    }
+    if(xfer->word_bits < 4 || xfer->word_bits > 16 || xfer->mode > 3 || xfer->bit_rate == 0) {
+        return -1;
+    }
+    b = &spi_buses[bus];
+
+    xfer->next = NULL;
+    xfer->busy = true;
+
+    primask = cpu_irq_save();
+    if(b->tail) {
+        b->tail->next = xfer;
+        b->tail = xfer;
+    } else {
+        b->head = b->tail = xfer;
+        spi_start(b);
+    }
+    cpu_irq_restore(primask);
+
+    return 0;
+}
+
+bool spi_idle(uint32_t bus) {
+    return spi_buses[bus].head == NULL;
+}
+
+// The head transfer is over. The next one goes on the bus before the
+// callback runs, so the gap between them is only this handler
+static void spi_finish(spi_bus_t *b) {
+    spi_xfer_t *x = b->head;
+
+    HWREG(b->base + SSI_O_DMACTL) = 0;
+
+    if(x->cs) {
+        if(x->flags & SPI_XFER_CS_HOLD) {
+            b->cs_held = x->cs;
+        } else {
+            x->cs->write(1);
+        }
+    }
+
+    b->head = x->next;
+    if(b->head) {
+        spi_start(b);
+    } else {
+        b->tail = NULL;
+    }
+
+    x->busy = false;
+    if(x->callback) {
+        x->callback(x->ctx);
+    }
+}
+
+static void spi_service(spi_bus_t *b) {
+    spi_xfer_t *x = b->head;
+
+    if(!x) {
+        return;
+    }
+    if(!x->len) {
+        spi_finish(b);
+        return;
+    }
+
+    // The last word has left the shifter. Drop what piled up in the RX
+    // FIFO meanwhile
+    if(b->draining) {
+        if(!(MAP_SSIIntStatus(b->base, true) & SSI_TXFF)) {
+            return;
+        }
+        MAP_SSIIntDisable(b->base, SSI_TXFF);
+        while(HWREG(b->base + SSI_O_SR) & SSI_SR_RNE) {
+            (void)HWREG(b->base + SSI_O_DR);
+        }
+        MAP_SSIIntClear(b->base, SSI_RXOR);
+        b->draining = false;
+        spi_finish(b);
+        return;
+    }
+
+    // Receive finishes last when there is one. Otherwise this may be the
+    // TX channel finishing first
+    if(MAP_uDMAChannelIsEnabled(SPI_DMA_CHANNEL(x->rx ? b->rx_assign : b->tx_assign))) {
+        return;
+    }
+
+    b->pos += b->chunk;
+    if(b->pos < x->len) {
+        spi_chunk(b);
+        return;
+    }
+
+    // Transmit only: uDMA is done when the last word is in the FIFO, wait
+    // for it to go out
+    if(!x->rx) {
+        b->draining = true;
+        MAP_SSIIntEnable(b->base, SSI_TXFF);
+        return;
+    }
+
+    spi_finish(b);
+}
+
+// Bound into nvic_table by name
+extern "C" {
+
+void ssi0_handler(void) {
+    spi_service(&spi_buses[0]);
+}
+
+void ssi1_handler(void) {
+    spi_service(&spi_buses[1]);
+}
+
+void ssi2_handler(void) {
+    spi_service(&spi_buses[2]);
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef __SPI_H__
+#define __SPI_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "gpiopin.h"
+
+/*
+ * SPI master on SSI0-SSI2, run from a queue of transfers.
+ *
+ * Each transfer names its own chip select, bit rate, word size and SPI
+ * mode, so devices with different settings can share a bus. Transfers are
+ * owned by the caller and linked into the bus queue by spi_submit();
+ * nothing is allocated. uDMA moves the words both ways, and the SSI
+ * interrupt that marks the end of one transfer releases its chip select,
+ * starts the next queued one straight away and only then runs the
+ * completion callback, so the bus stays busy with no polling.
+ *
+ * With rx NULL the receive side is not read at all: uDMA only feeds the
+ * TX FIFO, what comes back is dropped, and the end of the transfer is
+ * taken from the SSI end of transmission interrupt. With tx NULL the
+ * clocks come from SPI_TX_FILL sent from a single word, so reads need no
+ * dummy buffer. A zero length transfer moves no data; it is a marker that
+ * completes in queue order, for example to release a chip select held
+ * with SPI_XFER_CS_HOLD.
+ *
+ * Pins, and the uDMA channels each bus takes over in spi_init():
+ *
+ *     SSI0  CLK PA2, RX PA4, TX PA5    channels 10, 11
+ *     SSI1  CLK PD0, RX PD2, TX PD3    channels 24, 25, also ADC1 and waveform
+ *     SSI2  CLK PB4, RX PB6, TX PB7    channels 12, 13, also capture on PC6, PC7
+ *
+ * Chip selects are GPIOPins set up by the caller as outputs, idle high.
+ *
+ *     static GPIOPin flash_cs(0, 3);
+ *     static uint8_t cmd[4] = {0x03, 0, 0, 0};
+ *     static uint8_t page[256];
+ *     static spi_xfer_t read_cmd = {NULL, &flash_cs, 10000000, 8, 0, SPI_XFER_CS_HOLD,
+ *                                   cmd, NULL, 4, NULL, NULL};
+ *     static spi_xfer_t read_data = {NULL, &flash_cs, 10000000, 8, 0, 0,
+ *                                    NULL, page, 256, page_read, NULL};
+ *
+ *     spi_init(0);
+ *     spi_submit(0, &read_cmd);
+ *     spi_submit(0, &read_data);
+ */
+
+#define SPI_BUSES               3
+
+// Word sent when a transfer has no TX buffer
+#ifndef SPI_TX_FILL
+#define SPI_TX_FILL             0xFFFF
+#endif
+
+// Leave the chip select asserted after the transfer. The next transfer
+// releases it first if it uses a different chip select
+#define SPI_XFER_CS_HOLD        0x01
+
+typedef void (*spi_cb_t)(void *ctx);
+
+typedef struct spi_xfer {
+    struct spi_xfer *next;      // queue link, set by spi_submit()
+    GPIOPin *cs;                // driven low during the transfer, NULL for none
+    uint32_t bit_rate;          // up to half the core clock
+    uint8_t word_bits;          // 4-16
+    uint8_t mode;               // SPI mode 0-3, clock polarity and phase
+    uint8_t flags;              // SPI_XFER_*
+    const void *tx;             // NULL sends SPI_TX_FILL
+    void *rx;                   // NULL drops what comes back
+    uint32_t len;               // words, in uint8_t up to 8 bits, uint16_t above
+    spi_cb_t callback;          // optional, called from the SSI interrupt
+    void *ctx;
+    volatile bool busy;         // set by spi_submit(), cleared when done
+} spi_xfer_t;
+
+// Set up the pins, SSI and uDMA channels of a bus (0-2)
+void spi_init(uint32_t bus);
+
+// Queue a transfer. It must stay untouched until busy clears. Safe from
+// interrupts and from completion callbacks. Returns -1 if the bus is not
+// initialised, the transfer is already queued or its settings are invalid
+int spi_submit(uint32_t bus, spi_xfer_t *xfer);
+
+// No transfer queued or running
+bool spi_idle(uint32_t bus);
+
+#endif
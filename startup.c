@@ -26,22 +26,108 @@
 #include <driverlib/rom.h>
 
 #include "compiler.h"
+#include "dwt.h"
+#include "mem.h"
+#include "startup.h"
 
 // Application entry point
 extern int main(void);
 
+// Fast clock setup in init.c, run before RAM is initialized
+extern void clock_init(void);
+
 // Default exception handlers
 void reset_handler(void);
 void nmi_handler(void);
 void hardfault_handler(void);
 void default_handler(void);
 
+// Peripheral and system handlers. A driver binds itself straight into the
+// vector table by defining a function with one of these names; any that are
+// not linked in fall through to default_handler.
+void mem_manage_handler(void) __weak __alias("default_handler");
+void bus_fault_handler(void) __weak __alias("default_handler");
+void usage_fault_handler(void) __weak __alias("default_handler");
+void svcall_handler(void) __weak __alias("default_handler");
+void debug_monitor_handler(void) __weak __alias("default_handler");
+void pendsv_handler(void) __weak __alias("default_handler");
+void systick_handler(void) __weak __alias("default_handler");
+void gpio_port_a_handler(void) __weak __alias("default_handler");
+void gpio_port_b_handler(void) __weak __alias("default_handler");
+void gpio_port_c_handler(void) __weak __alias("default_handler");
+void gpio_port_d_handler(void) __weak __alias("default_handler");
+void gpio_port_e_handler(void) __weak __alias("default_handler");
+void uart0_handler(void) __weak __alias("default_handler");
+void uart1_handler(void) __weak __alias("default_handler");
+void ssi0_handler(void) __weak __alias("default_handler");
+void i2c0_handler(void) __weak __alias("default_handler");
+void adc0_seq0_handler(void) __weak __alias("default_handler");
+void adc0_seq1_handler(void) __weak __alias("default_handler");
+void adc0_seq2_handler(void) __weak __alias("default_handler");
+void adc0_seq3_handler(void) __weak __alias("default_handler");
+void wdt_handler(void) __weak __alias("default_handler");
+void timer0a_handler(void) __weak __alias("default_handler");
+void timer0b_handler(void) __weak __alias("default_handler");
+void timer1a_handler(void) __weak __alias("default_handler");
+void timer1b_handler(void) __weak __alias("default_handler");
+void timer2a_handler(void) __weak __alias("default_handler");
+void timer2b_handler(void) __weak __alias("default_handler");
+void comp0_handler(void) __weak __alias("default_handler");
+void comp1_handler(void) __weak __alias("default_handler");
+void sysctl_handler(void) __weak __alias("default_handler");
+void flash_handler(void) __weak __alias("default_handler");
+void gpio_port_f_handler(void) __weak __alias("default_handler");
+void uart2_handler(void) __weak __alias("default_handler");
+void ssi1_handler(void) __weak __alias("default_handler");
+void timer3a_handler(void) __weak __alias("default_handler");
+void timer3b_handler(void) __weak __alias("default_handler");
+void i2c1_handler(void) __weak __alias("default_handler");
+void can0_handler(void) __weak __alias("default_handler");
+void hibernate_handler(void) __weak __alias("default_handler");
+void usb_handler(void) __weak __alias("default_handler");
+void udma_sw_handler(void) __weak __alias("default_handler");
+void udma_error_handler(void) __weak __alias("default_handler");
+void adc1_seq0_handler(void) __weak __alias("default_handler");
+void adc1_seq1_handler(void) __weak __alias("default_handler");
+void adc1_seq2_handler(void) __weak __alias("default_handler");
+void adc1_seq3_handler(void) __weak __alias("default_handler");
+void ssi2_handler(void) __weak __alias("default_handler");
+void ssi3_handler(void) __weak __alias("default_handler");
+void uart3_handler(void) __weak __alias("default_handler");
+void uart4_handler(void) __weak __alias("default_handler");
+void uart5_handler(void) __weak __alias("default_handler");
+void uart6_handler(void) __weak __alias("default_handler");
+void uart7_handler(void) __weak __alias("default_handler");
+void i2c2_handler(void) __weak __alias("default_handler");
+void i2c3_handler(void) __weak __alias("default_handler");
+void timer4a_handler(void) __weak __alias("default_handler");
+void timer4b_handler(void) __weak __alias("default_handler");
+void timer5a_handler(void) __weak __alias("default_handler");
+void timer5b_handler(void) __weak __alias("default_handler");
+void wtimer0a_handler(void) __weak __alias("default_handler");
+void wtimer0b_handler(void) __weak __alias("default_handler");
+void wtimer1a_handler(void) __weak __alias("default_handler");
+void wtimer1b_handler(void) __weak __alias("default_handler");
+void wtimer2a_handler(void) __weak __alias("default_handler");
+void wtimer2b_handler(void) __weak __alias("default_handler");
+void wtimer3a_handler(void) __weak __alias("default_handler");
+void wtimer3b_handler(void) __weak __alias("default_handler");
+void wtimer4a_handler(void) __weak __alias("default_handler");
+void wtimer4b_handler(void) __weak __alias("default_handler");
+void wtimer5a_handler(void) __weak __alias("default_handler");
+void wtimer5b_handler(void) __weak __alias("default_handler");
+void sysexc_handler(void) __weak __alias("default_handler");
+
 // Linker defined sections
 extern uint32_t _etext;
 extern uint32_t _data;
 extern uint32_t _edata;
+extern uint32_t _ramfunc;
+extern uint32_t _eramfunc;
+extern uint32_t _ramfunc_load;
 extern uint32_t _bss;
 extern uint32_t _ebss;
+extern uint32_t _end;
 extern uint32_t _stack_top;
 extern void (*__init_array_start[])(void);
 extern void (*__init_array_end[])(void);
@@ -64,92 +150,92 @@ nvic_handler_t nvic_table[] = {
     hardfault_handler,      // hard fault handler.              3
 
     // Configurable priority exceptions.
-    default_handler,        // Memory Management Fault          4
-    default_handler,        // Bus Fault                        5
-    default_handler,        // Usage Fault                      6
+    mem_manage_handler,     // Memory Management Fault          4
+    bus_fault_handler,      // Bus Fault                        5
+    usage_fault_handler,    // Usage Fault                      6
     0,                      // Reserved                         7
     0,                      // Reserved                         8
     0,                      // Reserved                         9
     0,                      // Reserved                         10
-    default_handler,        // SV call                          11
-    default_handler,        // Debug monitor                    12
+    svcall_handler,         // SV call                          11
+    debug_monitor_handler,  // Debug monitor                    12
     0,                      // Reserved                         13
-    default_handler,        // PendSV                           14
-    default_handler,        // SysTick                          15
+    pendsv_handler,         // PendSV                           14
+    systick_handler,        // SysTick                          15
 
     // Peripherial exceptions start here.
-    default_handler,        // GPIO Port A                      16
-    default_handler,        // GPIO Port B                      17
-    default_handler,        // GPIO Port C                      18
-    default_handler,        // GPIO Port D                      19
-    default_handler,        // GPIO Port E                      20
-    default_handler,        // UART 0                           21
-    default_handler,        // UART 1                           22
-    default_handler,        // SSI 0                            23
-    default_handler,        // I2C 0                            24
+    gpio_port_a_handler,    // GPIO Port A                      16
+    gpio_port_b_handler,    // GPIO Port B                      17
+    gpio_port_c_handler,    // GPIO Port C                      18
+    gpio_port_d_handler,    // GPIO Port D                      19
+    gpio_port_e_handler,    // GPIO Port E                      20
+    uart0_handler,          // UART 0                           21
+    uart1_handler,          // UART 1                           22
+    ssi0_handler,           // SSI 0                            23
+    i2c0_handler,           // I2C 0                            24
     0,                      // Reserved                         25
     0,                      // Reserved                         26
     0,                      // Reserved                         27
     0,                      // Reserved                         28
     0,                      // Reserved                         29
-    default_handler,        // ADC 0 Seq 0                      30
-    default_handler,        // ADC 0 Seq 1                      31
-    default_handler,        // ADC 0 Seq 2                      32
-    default_handler,        // ADC 0 Seq 3                      33
-    default_handler,        // WDT 0 and 1                      34
-    default_handler,        // 16/32 bit timer 0 A              35
-    default_handler,        // 16/32 bit timer 0 B              36
-    default_handler,        // 16/32 bit timer 1 A              37
-    default_handler,        // 16/32 bit timer 1 B              38
-    default_handler,        // 16/32 bit timer 2 A              39
-    default_handler,        // 16/32 bit timer 2 B              40
-    default_handler,        // Analog comparator 0              41
-    default_handler,        // Analog comparator 1              42
+    adc0_seq0_handler,      // ADC 0 Seq 0                      30
+    adc0_seq1_handler,      // ADC 0 Seq 1                      31
+    adc0_seq2_handler,      // ADC 0 Seq 2                      32
+    adc0_seq3_handler,      // ADC 0 Seq 3                      33
+    wdt_handler,            // WDT 0 and 1                      34
+    timer0a_handler,        // 16/32 bit timer 0 A              35
+    timer0b_handler,        // 16/32 bit timer 0 B              36
+    timer1a_handler,        // 16/32 bit timer 1 A              37
+    timer1b_handler,        // 16/32 bit timer 1 B              38
+    timer2a_handler,        // 16/32 bit timer 2 A              39
+    timer2b_handler,        // 16/32 bit timer 2 B              40
+    comp0_handler,          // Analog comparator 0              41
+    comp1_handler,          // Analog comparator 1              42
     0,                      // Reserved                         43
-    default_handler,        // System control                   44
-    default_handler,        // Flash + EEPROM control           45
-    default_handler,        // GPIO Port F                      46
+    sysctl_handler,         // System control                   44
+    flash_handler,          // Flash + EEPROM control           45
+    gpio_port_f_handler,    // GPIO Port F                      46
     0,                      // Reserved                         47
     0,                      // Reserved                         48
-    default_handler,        // UART 2                           49
-    default_handler,        // SSI 1                            50
-    default_handler,        // 16/32 bit timer 3 A              51
-    default_handler,        // 16/32 bit timer 3 B              52
-    default_handler,        // I2C 1                            53
+    uart2_handler,          // UART 2                           49
+    ssi1_handler,           // SSI 1                            50
+    timer3a_handler,        // 16/32 bit timer 3 A              51
+    timer3b_handler,        // 16/32 bit timer 3 B              52
+    i2c1_handler,           // I2C 1                            53
     0,                      // Reserved                         54
-    default_handler,        // CAN 0                            55
+    can0_handler,           // CAN 0                            55
     0,                      // Reserved                         56
     0,                      // Reserved                         57
     0,                      // Reserved                         58
-    default_handler,        // Hibernation module               59
-    default_handler,        // USB                              60
+    hibernate_handler,      // Hibernation module               59
+    usb_handler,            // USB                              60
     0,                      // Reserved                         61
-    default_handler,        // UDMA SW                          62
-    default_handler,        // UDMA Error                       63
-    default_handler,        // ADC 1 Seq 0                      64
-    default_handler,        // ADC 1 Seq 1                      65
-    default_handler,        // ADC 1 Seq 2                      66
-    default_handler,        // ADC 1 Seq 3                      67
+    udma_sw_handler,        // UDMA SW                          62
+    udma_error_handler,     // UDMA Error                       63
+    adc1_seq0_handler,      // ADC 1 Seq 0                      64
+    adc1_seq1_handler,      // ADC 1 Seq 1                      65
+    adc1_seq2_handler,      // ADC 1 Seq 2                      66
+    adc1_seq3_handler,      // ADC 1 Seq 3                      67
     0,                      // Reserved                         68
     0,                      // Reserved                         69
     0,                      // Reserved                         70
     0,                      // Reserved                         71
     0,                      // Reserved                         72
-    default_handler,        // SSI 2                            73
-    default_handler,        // SSI 2                            74
-    default_handler,        // UART 3                           75
-    default_handler,        // UART 4                           76
-    default_handler,        // UART 5                           77
-    default_handler,        // UART 6                           78
-    default_handler,        // UART 7                           79
+    ssi2_handler,           // SSI 2                            73
+    ssi3_handler,           // SSI 3                            74
+    uart3_handler,          // UART 3                           75
+    uart4_handler,          // UART 4                           76
+    uart5_handler,          // UART 5                           77
+    uart6_handler,          // UART 6                           78
+    uart7_handler,          // UART 7                           79
     0,                      // Reserved                         80
     0,                      // Reserved                         81
     0,                      // Reserved                         82
     0,                      // Reserved                         83
-    default_handler,        // I2C 2                            84
-    default_handler,        // I2C 4                            85
-    default_handler,        // 16/32 bit timer 4 A              86
-    default_handler,        // 16/32 bit timer 4 B              87
+    i2c2_handler,           // I2C 2                            84
+    i2c3_handler,           // I2C 3                            85
+    timer4a_handler,        // 16/32 bit timer 4 A              86
+    timer4b_handler,        // 16/32 bit timer 4 B              87
     0,                      // Reserved                         88
     0,                      // Reserved                         89
     0,                      // Reserved                         90
@@ -170,21 +256,21 @@ nvic_handler_t nvic_table[] = {
     0,                      // Reserved                         105
     0,                      // Reserved                         106
     0,                      // Reserved                         107
-    default_handler,        // 16/32 bit timer 5 A              108
-    default_handler,        // 16/32 bit timer 5 B              109
-    default_handler,        // 32/64 bit timer 0 A              110
-    default_handler,        // 32/64 bit timer 0 B              111
-    default_handler,        // 32/64 bit timer 1 A              112
-    default_handler,        // 32/64 bit timer 1 B              113
-    default_handler,        // 32/64 bit timer 2 A              114
-    default_handler,        // 32/64 bit timer 2 B              115
-    default_handler,        // 32/64 bit timer 3 A              116
-    default_handler,        // 32/64 bit timer 3 B              117
-    default_handler,        // 32/64 bit timer 4 A              118
-    default_handler,        // 32/64 bit timer 4 B              119
-    default_handler,        // 32/64 bit timer 5 A              120
-    default_handler,        // 32/64 bit timer 5 B              121
-    default_handler,        // System Exception                 122
+    timer5a_handler,        // 16/32 bit timer 5 A              108
+    timer5b_handler,        // 16/32 bit timer 5 B              109
+    wtimer0a_handler,       // 32/64 bit timer 0 A              110
+    wtimer0b_handler,       // 32/64 bit timer 0 B              111
+    wtimer1a_handler,       // 32/64 bit timer 1 A              112
+    wtimer1b_handler,       // 32/64 bit timer 1 B              113
+    wtimer2a_handler,       // 32/64 bit timer 2 A              114
+    wtimer2b_handler,       // 32/64 bit timer 2 B              115
+    wtimer3a_handler,       // 32/64 bit timer 3 A              116
+    wtimer3b_handler,       // 32/64 bit timer 3 B              117
+    wtimer4a_handler,       // 32/64 bit timer 4 A              118
+    wtimer4b_handler,       // 32/64 bit timer 4 B              119
+    wtimer5a_handler,       // 32/64 bit timer 5 A              120
+    wtimer5b_handler,       // 32/64 bit timer 5 B              121
+    sysexc_handler,         // System Exception                 122
     0,                      // Reserved                         123
     0,                      // Reserved                         124
     0,                      // Reserved                         125
@@ -219,23 +305,83 @@ nvic_handler_t nvic_table[] = {
     0                       // Reserved                         154
 };
 
+// Cycles from reset to main(), see startup.h
+uint32_t startup_cycles;
+
+// Copy whole words, four at a time with LDM/STM. Inlined so nothing is
+// pushed below the stack pointer while reset_handler fills that RAM
+static __always_inline void startup_copy(uint32_t *dest, uint32_t *end, const uint32_t *src) {
+    uint32_t n = (end - dest) >> 2;
+
+    if(n) {
+        __asm__ __volatile__(
+            "1: ldmia %[s]!, {r4-r7}    \n"
+            "   stmia %[d]!, {r4-r7}    \n"
+            "   subs  %[n], %[n], #1    \n"
+            "   bne   1b                \n"
+            : [s] "+r" (src), [d] "+r" (dest), [n] "+r" (n)
+            :
+            : "r4", "r5", "r6", "r7", "cc", "memory");
+    }
+
+    while(dest < end) {
+        *dest++ = *src++;
+    }
+}
+
+// Fill whole words with value, four at a time with STM
+static __always_inline void startup_fill(uint32_t *dest, uint32_t *end, uint32_t value) {
+    uint32_t n = (end - dest) >> 2;
+
+    if(n) {
+        __asm__ __volatile__(
+            "   mov   r4, %[v]          \n"
+            "   mov   r5, %[v]          \n"
+            "   mov   r6, %[v]          \n"
+            "   mov   r7, %[v]          \n"
+            "1: stmia %[d]!, {r4-r7}    \n"
+            "   subs  %[n], %[n], #1    \n"
+            "   bne   1b                \n"
+            : [d] "+r" (dest), [n] "+r" (n)
+            : [v] "r" (value)
+            : "r4", "r5", "r6", "r7", "cc", "memory");
+    }
+
+    while(dest < end) {
+        *dest++ = value;
+    }
+}
+
 // Reset handler. Sets up for application on reset
 void reset_handler(void) {
-    uint32_t *src, *dest;
+    uint32_t *sp;
     uint32_t i, cnt;
 
+    // Time the boot. Only a power-on reset clears DWT_CYCCNT, after a
+    // warm reset it carries on counting from before
+    dwt_init();
+    dwt_reset();
+
+    // Switch to the PLL first so everything below runs at full speed.
+    // Must not touch RAM, .data and .bss are not set up yet
+    clock_init();
+
     // Copy data initializers from flash to RAM
-    src = &_etext;
-    dest = &_data;
-    while(dest < &_edata) {
-        *dest++ = *src++;
-    }
+    startup_copy(&_data, &_edata, &_etext);
 
-    // Zero fill bss
-    dest = &_bss;
-    while(dest < &_ebss) {
-        *dest++ = 0;
-    }
+    // Copy __ramfunc code
+    startup_copy(&_ramfunc, &_eramfunc, &_ramfunc_load);
+
+    // Zero fill bss. .noinit is left alone
+    startup_fill(&_bss, &_ebss, 0);
+
+    // Paint heap and unused stack for mem_stack_peak(). Nothing below the
+    // stack pointer is live yet
+    __asm__ __volatile__("mov %0, sp" : "=r" (sp));
+    startup_fill(&_end, sp, MEM_PAINT);
+
+    // Fault on main stack overflow instead of running into the heap
+    mem_guard_init();
 
     // Call any initializer functions/constructors
     cnt = __init_array_end - __init_array_start;
@@ -243,6 +389,8 @@ void reset_handler(void) {
         __init_array_start[i]();
     }
 
+    startup_cycles = dwt_cycles();
+
     // Application entry
     main();
 
@@ -0,0 +1,18 @@
+#ifndef __STARTUP_H__
+#define __STARTUP_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Core clock cycles from reset to the call to main(), counted by the DWT.
+// Covers the clock switch, RAM setup and every __init function
+extern uint32_t startup_cycles;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -12,7 +12,9 @@
 #include <unistd.h>
 #include <inc/hw_memmap.h>
 #include <inc/hw_types.h>
-#include <driverlib/uart.h>
+
+#include "timebase.h"
+#include "uart.h"
 
 // int _system(const char *);
 // int _rename(const char *, const char *);
@@ -24,7 +26,7 @@
 // int _link(void);
 // int _stat(const char *, struct stat *);
 // int _fstat(int, struct stat *);
-// caddr_t _sbrk(int);
+// caddr_t _sbrk(int);  see mem.c
 // int _getpid(int);
 // int _kill(int, int);
 // void _exit(int);
@@ -34,30 +36,12 @@
 // int _lseek(int, int, int);
 // int _read(int, char *, int);
 
-// Register name faking - works in collusion with the linker.
-register char * stack_ptr asm("sp");
-
-extern char _end;
-
 /* Return number of characters read, no more than 'len' */
 int _read(int file, char *ptr, int len)
 {
-    long c;
-    int bytesRead = 0;
-
     (void) file; // Indicate variable is unused
 
-    do {
-        c = UARTCharGetNonBlocking(UART1_BASE);
-        if (c == (long)(-1)) {
-            break;
-        }
-        else {
-            *ptr++ = (char)(c & 0xFF);
-        }
-    } while (++bytesRead < len);
-
-    return bytesRead;
+    return uart_read(ptr, len);
 }
 
 int _lseek(int file, int ptr, int dir)
@@ -68,12 +52,10 @@ int _lseek(int file, int ptr, int dir)
 /* Return number of characters written */
 int _write(int file, char *ptr, int len)
 {
-    unsigned i;
+    (void) file; // Indicate variable is unused
 
-    for (i=0; i < len; i++) {
-        UARTCharPut(UART1_BASE, *ptr++);
-    }
-    return len;
+    /* Queued, not sent: see uart.h for the overflow policy */
+    return uart_write(ptr, len);
 }
 
 int _open(const char *path, int flags, ...)
@@ -105,27 +87,6 @@ int _getpid(int n)
     return 1;
 }
 
-caddr_t _sbrk(unsigned int incr)
-{
-    static char * heap_end = NULL;
-    char * prev_heap_end;
-
-    if (heap_end == NULL) {
-        heap_end = &_end;
-    }
-
-    prev_heap_end = heap_end;
-
-    if (heap_end + incr > (caddr_t)stack_ptr) {
-        errno = ENOMEM;
-        return (caddr_t) -1;
-    }
-
-    heap_end += incr;
-
-    return (caddr_t)prev_heap_end;
-}
-
 int _fstat(int file, struct stat * st)
 {
     return 0;
@@ -151,14 +112,34 @@ void _raise (void)
     return;
 }
 
+/* Time since boot, there is no RTC */
 int _gettimeofday(struct timeval * tp, struct timezone * tzp)
 {
+    uint64_t ns = timebase_ns();
+
+    if (tp) {
+        tp->tv_sec  = ns / 1000000000ULL;
+        tp->tv_usec = (ns % 1000000000ULL) / 1000;
+    }
+    if (tzp) {
+        tzp->tz_minuteswest = 0;
+        tzp->tz_dsttime = 0;
+    }
     return 0;
 }
 
+/* Everything runs as user time */
 clock_t _times(struct tms * tp)
 {
-    return 0;
+    clock_t ticks = timebase_ns() / (1000000000ULL / CLOCKS_PER_SEC);
+
+    if (tp) {
+        tp->tms_utime  = ticks;
+        tp->tms_stime  = 0;
+        tp->tms_cutime = 0;
+        tp->tms_cstime = 0;
+    }
+    return ticks;
 }
 
 int _isatty(int fd)
@@ -0,0 +1,149 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <inc/hw_types.h>
+#include <inc/hw_nvic.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "timebase.h"
+
+// SysTick reload, the full 24-bit range: 0.2s per wrap at 80MHz
+#define TIMEBASE_RELOAD     0x00FFFFFF
+#define TIMEBASE_PERIOD     (TIMEBASE_RELOAD + 1)
+
+// ns per cycle in 40.24 fixed point
+#define TIMEBASE_SHIFT      24
+
+// Time at the last SysTick wrap. Two copies: the handler fills in the one
+// readers are not using, then bumps the generation to publish it
+typedef struct {
+    uint64_t cycles;
+    uint64_t ns;
+    uint64_t mult;
+} timebase_slot_t;
+
+static timebase_slot_t timebase_slot[2];
+static volatile uint32_t timebase_gen;
+static uint32_t timebase_rate;
+static bool timebase_running;
+
+static uint64_t timebase_mult(uint32_t hz) {
+    return (1000000000ULL << TIMEBASE_SHIFT) / hz;
+}
+
+// Publish a new base. Only called from the SysTick handler or with
+// interrupts masked
+static void timebase_publish(uint64_t cycles, uint64_t ns, uint64_t mult) {
+    timebase_slot_t *next = &timebase_slot[(timebase_gen + 1) & 1];
+
+    next->cycles = cycles;
+    next->ns     = ns;
+    next->mult   = mult;
+
+    __compiler_barrier();
+    timebase_gen++;
+}
+
+// Snapshot of the current base plus cycles elapsed since it
+static void timebase_read(timebase_slot_t *base, uint32_t *elapsed) {
+    uint32_t gen, v1, v2, pend;
+
+    do {
+        gen = timebase_gen;
+        __compiler_barrier();
+        *base = timebase_slot[gen & 1];
+
+        // A wrap the handler has not seen yet shows up as a pending
+        // SysTick; a wrap between the two reads just retries
+        v1   = HWREG(NVIC_ST_CURRENT);
+        pend = HWREG(NVIC_INT_CTRL) & NVIC_INT_CTRL_PENDSTSET;
+        v2   = HWREG(NVIC_ST_CURRENT);
+        __compiler_barrier();
+    } while(gen != timebase_gen || v2 > v1);
+
+    *elapsed = (TIMEBASE_RELOAD - v2) + (pend ? TIMEBASE_PERIOD : 0);
+}
+
+void timebase_init(void) {
+    if(timebase_running) {
+        return;
+    }
+
+    if(timebase_rate == 0) {
+        timebase_rate = MAP_SysCtlClockGet();
+    }
+    timebase_publish(0, 0, timebase_mult(timebase_rate));
+
+    // Core clock, full range, wrap interrupt on
+    HWREG(NVIC_ST_CTRL)    = 0;
+    HWREG(NVIC_ST_RELOAD)  = TIMEBASE_RELOAD;
+    HWREG(NVIC_ST_CURRENT) = 0;
+    HWREG(NVIC_ST_CTRL)    = NVIC_ST_CTRL_CLK_SRC | NVIC_ST_CTRL_INTEN | NVIC_ST_CTRL_ENABLE;
+
+    timebase_running = true;
+}
+
+uint64_t timebase_cycles(void) {
+    timebase_slot_t base;
+    uint32_t elapsed;
+
+    if(!timebase_running) {
+        return 0;
+    }
+
+    timebase_read(&base, &elapsed);
+    return base.cycles + elapsed;
+}
+
+uint64_t timebase_ns(void) {
+    timebase_slot_t base;
+    uint32_t elapsed;
+
+    if(!timebase_running) {
+        return 0;
+    }
+
+    timebase_read(&base, &elapsed);
+    return base.ns + ((elapsed * base.mult) >> TIMEBASE_SHIFT);
+}
+
+uint32_t timebase_hz(void) {
+    return timebase_rate;
+}
+
+void timebase_clock_set(uint32_t config) {
+    timebase_slot_t base;
+    uint32_t elapsed;
+    uint32_t primask = cpu_irq_save();
+
+    if(timebase_running) {
+        // Fold in the partial period at the old rate and restart SysTick
+        // so the next one is counted entirely at the new rate
+        timebase_read(&base, &elapsed);
+        base.cycles += elapsed;
+        base.ns     += (elapsed * base.mult) >> TIMEBASE_SHIFT;
+        HWREG(NVIC_ST_CURRENT) = 0;
+        HWREG(NVIC_INT_CTRL)   = NVIC_INT_CTRL_PENDSTCLR;
+    }
+
+    MAP_SysCtlClockSet(config);
+    timebase_rate = MAP_SysCtlClockGet();
+
+    if(timebase_running) {
+        timebase_publish(base.cycles, base.ns, timebase_mult(timebase_rate));
+    }
+
+    cpu_irq_restore(primask);
+}
+
+// Bound into nvic_table by name
+void systick_handler(void) {
+    timebase_slot_t *cur = &timebase_slot[timebase_gen & 1];
+
+    timebase_publish(cur->cycles + TIMEBASE_PERIOD,
+                     cur->ns + ((TIMEBASE_PERIOD * cur->mult) >> TIMEBASE_SHIFT),
+                     cur->mult);
+}
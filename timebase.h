@@ -0,0 +1,41 @@
+#ifndef __TIMEBASE_H__
+#define __TIMEBASE_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * 64-bit monotonic time since timebase_init().
+ *
+ * SysTick free-runs over its full 24-bit range at the core clock and each
+ * wrap is folded into a 64-bit base by systick_handler. Readers combine
+ * that base with the live SysTick count, so reads take no lock and are
+ * safe from any interrupt priority. SysTick keeps counting through WFI
+ * sleep, unlike the DWT cycle counter.
+ *
+ * Change the core clock through timebase_clock_set() so the elapsed time
+ * at the old rate is folded in before the new rate takes effect.
+ */
+
+void timebase_init(void);
+
+// Core clock cycles. Not a uniform time unit across clock changes
+uint64_t timebase_cycles(void);
+
+// Nanoseconds
+uint64_t timebase_ns(void);
+
+// Current core clock rate
+uint32_t timebase_hz(void);
+
+// Wrapper around SysCtlClockSet that keeps timebase_ns() continuous
+void timebase_clock_set(uint32_t config);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,127 @@
+#!/usr/bin/env python3
+"""
+Run the QEMU benchmark image (qemu/bench.c) and record its results as JSON.
+
+    python3 tools/benchqemu.py build/qemu/bench.elf -o build/qemu/bench.json
+    python3 tools/benchqemu.py build/qemu/bench.elf -o new.json --baseline old.json
+    python3 tools/benchqemu.py --machine mps2-an386 build/qemu-m4/bench.elf
+
+QEMU runs with -icount, so every result is a fixed function of the
+instructions executed and repeats exactly between runs. Each benchmark is
+recorded with its raw SysTick ticks and the instructions per iteration they
+stand for. With --baseline, any benchmark that got more than --threshold
+percent slower is reported and the exit status is 1.
+"""
+
+import argparse
+import json
+import subprocess
+import sys
+
+# Virtual time per instruction is 2^shift ns. 5 makes one instruction a
+# little longer than one 50MHz tick, so counts resolve single instructions
+ICOUNT_SHIFT = 5
+
+
+def run(elf, qemu, machine, shift, timeout):
+    cmd = [qemu, "-M", machine, "-display", "none",
+           "-serial", "null", "-monitor", "none",
+           "-icount", "shift=%d" % shift,
+           "-semihosting-config", "enable=on,target=native",
+           "-kernel", elf]
+    proc = subprocess.run(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                          universal_newlines=True, timeout=timeout)
+    return proc.returncode, proc.stdout
+
+
+def parse(output, shift):
+    hz = None
+    done = None
+    fails = []
+    bench = {}
+
+    for line in output.splitlines():
+        parts = line.split()
+        if not parts:
+            continue
+        if parts[0] == "HZ":
+            hz = int(parts[1])
+        elif parts[0] == "BENCH" and len(parts) == 4:
+            bench[parts[1]] = {"iterations": int(parts[2]), "ticks": int(parts[3])}
+        elif parts[0] == "FAIL":
+            fails.append(line)
+        elif parts[0] == "DONE":
+            done = int(parts[1])
+
+    if hz is None or done is None:
+        raise ValueError("incomplete benchmark output")
+
+    # ticks -> virtual ns -> instructions
+    ns_per_tick = 1e9 / hz
+    for r in bench.values():
+        r["insns"] = round(r["ticks"] * ns_per_tick / (1 << shift) / r["iterations"], 2)
+
+    return {"hz": hz, "icount_shift": shift, "failures": done, "bench": bench}, fails
+
+
+def compare(result, baseline, threshold):
+    worse = []
+    for name, r in sorted(result["bench"].items()):
+        old = baseline["bench"].get(name)
+        if old is None or old["insns"] == 0:
+            continue
+        change = 100.0 * (r["insns"] - old["insns"]) / old["insns"]
+        flag = ""
+        if change > threshold:
+            flag = "  REGRESSION"
+            worse.append(name)
+        print("%-20s %10.2f %10.2f %+7.1f%%%s" % (name, old["insns"], r["insns"], change, flag))
+    return worse
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="benchmark image")
+    parser.add_argument("-o", "--output", help="write results here as JSON")
+    parser.add_argument("--baseline", help="results of an earlier run to compare against")
+    parser.add_argument("--threshold", type=float, default=2.0,
+                        help="percent slowdown counted as a regression (default 2)")
+    parser.add_argument("--qemu", default="qemu-system-arm")
+    parser.add_argument("--machine", default="lm3s6965evb",
+                        help="QEMU machine the image was built for (default lm3s6965evb)")
+    parser.add_argument("--timeout", type=int, default=120)
+    args = parser.parse_args()
+
+    status, output = run(args.elf, args.qemu, args.machine, ICOUNT_SHIFT, args.timeout)
+    try:
+        result, fails = parse(output, ICOUNT_SHIFT)
+    except ValueError as e:
+        sys.stderr.write(output)
+        sys.stderr.write("%s: %s (qemu exit %d)\n" % (args.elf, e, status))
+        return 1
+
+    for line in fails:
+        print(line)
+
+    if args.output:
+        with open(args.output, "w") as f:
+            json.dump(result, f, indent=2, sort_keys=True)
+            f.write("\n")
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        worse = compare(result, baseline, args.threshold)
+        if worse:
+            print("%d regressions over %.1f%%" % (len(worse), args.threshold))
+            return 1
+    else:
+        for name, r in sorted(result["bench"].items()):
+            print("%-20s %10.2f insns" % (name, r["insns"]))
+
+    return 1 if result["failures"] or status else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,65 @@
+"""
+Minimal ELF32 little endian reader shared by the host tools.
+"""
+
+import struct
+
+SHT_SYMTAB = 2
+SHT_NOBITS = 8
+SHF_ALLOC = 0x2
+STT_FUNC = 2
+
+
+class Elf(object):
+    """Just enough of an ELF32 little endian reader to find sections."""
+
+    def __init__(self, path):
+        with open(path, "rb") as f:
+            self.data = f.read()
+        if self.data[:4] != b"\x7fELF" or self.data[4] != 1:
+            raise ValueError("%s is not a 32-bit ELF file" % path)
+
+        (shoff,) = struct.unpack_from("<I", self.data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", self.data, 0x2E)
+
+        self.sections = []
+        for i in range(shnum):
+            fields = struct.unpack_from("<IIIIIIIIII", self.data, shoff + i * shentsize)
+            self.sections.append(fields)
+
+        strtab = self.sections[shstrndx]
+        self.names = {}
+        for sec in self.sections:
+            self.names[self._cstr(strtab[4] + sec[0])] = sec
+
+    def _cstr(self, offset):
+        end = self.data.index(b"\0", offset)
+        return self.data[offset:end].decode("latin-1")
+
+    def section(self, name):
+        sec = self.names.get(name)
+        if sec is None:
+            return None
+        return self.data[sec[4]:sec[4] + sec[5]]
+
+    def string_at(self, addr):
+        """C string at a target address in a loaded section, or None."""
+        for sec in self.sections:
+            _, stype, flags, saddr, offset, size = sec[:6]
+            if flags & SHF_ALLOC and stype != SHT_NOBITS and saddr <= addr < saddr + size:
+                return self._cstr(offset + addr - saddr)
+        return None
+
+    def functions(self):
+        """Sorted list of (addr, size, name) for every function symbol."""
+        funcs = []
+        for sec in self.sections:
+            if sec[1] != SHT_SYMTAB:
+                continue
+            strtab = self.sections[sec[6]]
+            for off in range(sec[4], sec[4] + sec[5], 16):
+                name, value, size, info = struct.unpack_from("<IIIB", self.data, off)
+                if info & 0xF == STT_FUNC and name:
+                    funcs.append((value & ~1, size, self._cstr(strtab[4] + name)))
+        funcs.sort()
+        return funcs
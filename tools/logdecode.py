@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""
+Decode the binary LOG() stream written by log_flush() (see log.h).
+
+    python3 tools/logdecode.py build/demo.elf capture.bin
+    python3 tools/logdecode.py build/demo.elf /dev/ttyACM0 --hz 80000000
+
+Format strings are read from the .logfmt section of the ELF the firmware
+was built as. Anything on the stream that is not a log frame (plain
+printf output) is passed through unchanged. A frame whose records do not
+all point at format strings, or do not add up to its word count, was cut
+short on the way out, and so is one with a frame marker inside it; it is
+reported and skipped, and decoding picks up again at the next marker. A
+record whose arguments happen to spell the marker is lost the same way.
+"""
+
+import argparse
+import re
+import struct
+import sys
+
+from elffile import Elf
+
+FRAME_MAGIC = b"LOG1"
+
+# Header and word count limits, see log.h. Anything beyond them is not a
+# real frame
+HEADER_LEN = 12
+MAX_ARGS = 4
+MAX_WORDS = 1 << 16
+
+# "file:line" in front of every format string
+WHERE = re.compile(rb"[^\0]+:\d+$")
+
+
+# printf conversion -> python conversion; length modifiers are dropped
+CONVERSION = re.compile(r"%([-+ #0]*\d*(?:\.\d+)?)(hh|h|ll|l|z|t)?([diuxXoscp%])")
+
+
+def to_signed(v):
+    return v - (1 << 32) if v & 0x80000000 else v
+
+
+def format_record(elf, fmt, args):
+    args = list(args)
+
+    def sub(m):
+        flags, _, conv = m.groups()
+        if conv == "%":
+            return "%"
+        if not args:
+            return "<missing>"
+        v = args.pop(0)
+        if conv in "di":
+            return ("%" + flags + "d") % to_signed(v)
+        if conv == "u":
+            return ("%" + flags + "d") % v
+        if conv == "c":
+            return chr(v & 0xFF)
+        if conv == "p":
+            return "0x%08x" % v
+        if conv == "s":
+            s = elf.string_at(v)
+            return s if s is not None else "<str@0x%08x>" % v
+        return ("%" + flags + conv) % v
+
+    return CONVERSION.sub(sub, fmt)
+
+
+def split_magic(data):
+    """True if data ends with the start of a frame marker."""
+    return any(data.endswith(FRAME_MAGIC[:n]) for n in range(1, len(FRAME_MAGIC)))
+
+
+def format_string(fmts, offset):
+    """(where, fmt) of the LOG() string at offset in .logfmt, or None."""
+    if offset >= len(fmts) or (offset > 0 and fmts[offset - 1] != 0):
+        return None
+    end = fmts.find(b"\0", offset)
+    if end < 0 or not WHERE.match(fmts[offset:end]):
+        return None
+    fmt_end = fmts.find(b"\0", end + 1)
+    if fmt_end < 0:
+        return None
+    return fmts[offset:end].decode("latin-1"), fmts[end + 1:fmt_end].decode("latin-1")
+
+
+def parse_records(fmts, words):
+    """Split a frame into (where, fmt, stamp, args), or None if it is not
+    made of whole records that all point at format strings."""
+    records = []
+    i = 0
+    while i < len(words):
+        if i + 2 > len(words):
+            return None
+        header, stamp = words[i], words[i + 1]
+        nargs = header >> 24
+        strings = format_string(fmts, header & 0x00FFFFFF)
+        if nargs > MAX_ARGS or strings is None or i + 2 + nargs > len(words):
+            return None
+        records.append(strings + (stamp, words[i + 2:i + 2 + nargs]))
+        i += 2 + nargs
+    return records
+
+
+def decode(elf, stream, hz, out):
+    fmts = elf.section(".logfmt")
+    if fmts is None:
+        raise ValueError("no .logfmt section, was the firmware built with log.c?")
+
+    # read1 returns whatever is available, so a live serial port streams
+    read = getattr(stream, "read1", stream.read)
+
+    buf = b""
+    dropped = 0
+    # After a broken frame, whatever comes before the next marker is the
+    # rest of it and not text
+    skipping = False
+    while True:
+        chunk = read(4096)
+        if chunk:
+            buf += chunk
+
+        # Pass through text until the next frame
+        start = buf.find(FRAME_MAGIC)
+        if start < 0:
+            if not chunk:
+                if not skipping:
+                    out.write(buf.decode("latin-1"))
+                break
+            # Hold back what could be the start of a split magic
+            keep = len(FRAME_MAGIC) - 1
+            if len(buf) > keep:
+                if not skipping:
+                    out.write(buf[:-keep].decode("latin-1"))
+                buf = buf[-keep:]
+            continue
+        if not skipping:
+            out.write(buf[:start].decode("latin-1"))
+        buf = buf[start:]
+        skipping = False
+
+        if len(buf) < HEADER_LEN and chunk:
+            continue
+        records = None
+        if len(buf) >= HEADER_LEN:
+            _, nwords, total_dropped = struct.unpack_from("<III", buf, 0)
+            end = HEADER_LEN + nwords * 4
+            if 0 < nwords <= MAX_WORDS:
+                # A marker starting inside means this frame was cut short
+                # and the next one started in its place
+                if len(buf) < end or (chunk and len(buf) < end + 3 and split_magic(buf[:end])):
+                    if chunk:
+                        continue
+                elif FRAME_MAGIC not in buf[HEADER_LEN:end + len(FRAME_MAGIC) - 1]:
+                    words = struct.unpack_from("<%dI" % nwords, buf, HEADER_LEN)
+                    records = parse_records(fmts, words)
+
+        # Not a whole frame: drop everything up to the next marker
+        if records is None:
+            out.write("[log] skipped a broken frame\n")
+            buf = buf[len(FRAME_MAGIC):]
+            skipping = True
+            continue
+
+        buf = buf[end:]
+
+        if total_dropped != dropped:
+            out.write("[log] %d records dropped\n" % (total_dropped - dropped))
+            dropped = total_dropped
+
+        for where, fmt, stamp, args in records:
+            if hz:
+                when = "%12.6f" % (stamp / float(hz))
+            else:
+                when = "%10u" % stamp
+            out.write("%s %s: %s\n" % (when, where, format_record(elf, fmt, args)))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.strip().splitlines()[0])
+    parser.add_argument("elf", help="firmware ELF, e.g. build/demo.elf")
+    parser.add_argument("input", nargs="?", default="-",
+                        help="captured stream or serial device (default: stdin)")
+    parser.add_argument("--hz", type=int, default=0,
+                        help="core clock, to print timestamps in seconds")
+    args = parser.parse_args()
+
+    elf = Elf(args.elf)
+    if args.input == "-":
+        stream = sys.stdin.buffer
+    else:
+        stream = open(args.input, "rb")
+
+    try:
+        decode(elf, stream, args.hz, sys.stdout)
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
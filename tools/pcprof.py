@@ -0,0 +1,119 @@
+#!/usr/bin/env python3
+"""
+Symbolize the PC-sampling histograms printed by pcprof_dump() (see pcprof.h).
+
+    python3 tools/pcprof.py build/demo.elf capture.txt
+    python3 tools/pcprof.py build/demo.elf capture.txt --map build/demo.map
+
+Prints a flat profile of functions by sample count, then the callers seen
+in the stacked LR. Samples in the ROM (driverlib MAP_ calls) are reported
+as one bucket since the ROM has no symbols. The map file is only needed
+when the ELF has been stripped.
+"""
+
+import argparse
+import bisect
+import re
+import sys
+
+from elffile import Elf
+
+ROM_START = 0x01000000
+ROM_END = 0x01010000
+
+MAP_SYMBOL = re.compile(r"^\s+0x([0-9a-fA-F]{8})\s+([A-Za-z_]\w*)\s*$")
+
+
+def map_functions(path):
+    """(addr, size, name) from the symbol lines of a GNU ld map file."""
+    syms = set()
+    with open(path) as f:
+        for line in f:
+            m = MAP_SYMBOL.match(line)
+            if m:
+                syms.add((int(m.group(1), 16), m.group(2)))
+    syms = sorted(syms)
+    # No sizes in the map, so each symbol runs up to the next one
+    return [(addr, (syms[i + 1][0] if i + 1 < len(syms) else addr + 1) - addr, name)
+            for i, (addr, name) in enumerate(syms)]
+
+
+class Symbolizer(object):
+    def __init__(self, funcs):
+        self.funcs = funcs
+        self.addrs = [f[0] for f in funcs]
+
+    def name(self, addr):
+        if ROM_START <= addr < ROM_END:
+            return "[driverlib ROM]"
+        i = bisect.bisect_right(self.addrs, addr) - 1
+        if i >= 0:
+            start, size, name = self.funcs[i]
+            if addr < start + max(size, 1):
+                return name
+        return "0x%08x" % addr
+
+
+def read_dump(stream):
+    header = None
+    pcs, lrs = [], []
+    for line in stream:
+        fields = line.split()
+        if not fields:
+            continue
+        if fields[0] == "PCPROF":
+            header = [int(x) for x in fields[1:4]]
+            pcs, lrs = [], []
+        elif header is None:
+            continue
+        elif fields[0] == "P":
+            pcs.append((int(fields[1], 16), int(fields[2])))
+        elif fields[0] == "L":
+            lrs.append((int(fields[1], 16), int(fields[2])))
+        elif fields[0] == "END":
+            return header, pcs, lrs
+    if header is None:
+        raise ValueError("no PCPROF dump found")
+    return header, pcs, lrs
+
+
+def bucket(sym, samples):
+    totals = {}
+    for addr, count in samples:
+        name = sym.name(addr)
+        totals[name] = totals.get(name, 0) + count
+    return sorted(totals.items(), key=lambda kv: -kv[1])
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("elf", help="firmware ELF, e.g. build/demo.elf")
+    parser.add_argument("input", nargs="?", default="-", help="captured dump, - for stdin")
+    parser.add_argument("--map", help="linker map, used when the ELF has no symbols")
+    parser.add_argument("--top", type=int, default=30, help="rows per table")
+    args = parser.parse_args()
+
+    funcs = Elf(args.elf).functions()
+    if not funcs and args.map:
+        funcs = map_functions(args.map)
+    sym = Symbolizer(funcs)
+
+    stream = sys.stdin if args.input == "-" else open(args.input)
+    (hz, samples, dropped), pcs, lrs = read_dump(stream)
+
+    recorded = sum(c for _, c in pcs) or 1
+    print("%d samples at %d Hz, %d not recorded (table full)" % (samples, hz, dropped))
+    print()
+    print("  self%   samples  function")
+    for name, count in bucket(sym, pcs)[:args.top]:
+        print("%6.1f%% %9d  %s" % (100.0 * count / recorded, count, name))
+
+    print()
+    print("  caller samples (from LR)")
+    for name, count in bucket(sym, lrs)[:args.top]:
+        print("%6.1f%% %9d  %s" % (100.0 * count / recorded, count, name))
+
+
+if __name__ == "__main__":
+    main()
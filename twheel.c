@@ -0,0 +1,299 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_timer.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "twheel.h"
+
+// Periodic tick, full 32-bit width
+#define TWHEEL_TIMER_BASE   TIMER0_BASE
+#define TWHEEL_TIMER_PERIPH SYSCTL_PERIPH_TIMER0
+#define TWHEEL_TIMER_INT    INT_TIMER0A
+
+#define TWHEEL_SLOT_BITS    6
+#define TWHEEL_SLOTS        (1 << TWHEEL_SLOT_BITS)
+#define TWHEEL_SLOT_MASK    (TWHEEL_SLOTS - 1)
+
+// Furthest ahead the wheel can sort a timer
+#define TWHEEL_RANGE        (1ULL << (TWHEEL_SLOT_BITS * TWHEEL_LEVELS))
+
+// Longest delay, so expiry comparisons stay within half the tick range
+#define TWHEEL_MAX_TICKS    0x7FFFFFFF
+
+static twheel_timer_t *twheel_wheel[TWHEEL_LEVELS][TWHEEL_SLOTS];
+
+// Next tick to process
+static volatile uint32_t twheel_now;
+
+// Timers in the wheel. The hardware timer stops when this drops to 0
+static uint32_t twheel_count;
+static bool twheel_running;
+
+// Deferred callbacks waiting for twheel_poll()
+static twheel_timer_t *twheel_deferred_head;
+static twheel_timer_t *twheel_deferred_tail;
+
+static uint32_t twheel_load;
+
+static twheel_fn_t twheel_notify;
+static void *twheel_notify_ctx;
+
+void twheel_init(void) {
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(TWHEEL_TIMER_PERIPH);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    twheel_load = (uint64_t)MAP_SysCtlClockGet() * TWHEEL_TICK_US / 1000000 - 1;
+
+    MAP_TimerConfigure(TWHEEL_TIMER_BASE, TIMER_CFG_PERIODIC);
+    MAP_TimerIntEnable(TWHEEL_TIMER_BASE, TIMER_TIMA_TIMEOUT);
+    MAP_IntEnable(TWHEEL_TIMER_INT);
+}
+
+void twheel_timer_init(twheel_timer_t *timer, twheel_fn_t fn, void *ctx, twheel_mode_t mode) {
+    timer->next     = NULL;
+    timer->pprev    = NULL;
+    timer->expires  = 0;
+    timer->period   = 0;
+    timer->fn       = fn;
+    timer->ctx      = ctx;
+    timer->mode     = mode;
+    timer->deferred = NULL;
+    timer->queued   = false;
+    timer->due      = false;
+}
+
+// File a timer by how far off it is. Called with interrupts masked
+static void twheel_insert(twheel_timer_t *timer) {
+    uint32_t when = timer->expires;
+    uint32_t delta = when - twheel_now;
+    uint32_t level = 0;
+    twheel_timer_t **head;
+
+    if((int32_t)delta < 0) {
+        // Already due, runs on the next tick
+        when = twheel_now;
+    } else if(delta >= TWHEEL_RANGE) {
+        // Past the top level. Park it in the last slot in range, it is
+        // looked at again when that slot comes down
+        when = twheel_now + (uint32_t)(TWHEEL_RANGE - 1);
+        level = TWHEEL_LEVELS - 1;
+    } else {
+        while(delta >= (1u << (TWHEEL_SLOT_BITS * (level + 1)))) {
+            level++;
+        }
+    }
+
+    head = &twheel_wheel[level][(when >> (TWHEEL_SLOT_BITS * level)) & TWHEEL_SLOT_MASK];
+
+    timer->next = *head;
+    timer->pprev = head;
+    if(*head) {
+        (*head)->pprev = &timer->next;
+    }
+    *head = timer;
+}
+
+static void twheel_unlink(twheel_timer_t *timer) {
+    *timer->pprev = timer->next;
+    if(timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+    timer->next = NULL;
+    timer->pprev = NULL;
+}
+
+void twheel_start(twheel_timer_t *timer, uint32_t delay_us, uint32_t period_us) {
+    uint32_t delay = delay_us / TWHEEL_TICK_US + (delay_us % TWHEEL_TICK_US != 0);
+    uint32_t period = period_us / TWHEEL_TICK_US + (period_us % TWHEEL_TICK_US != 0);
+    uint32_t primask;
+
+    if(delay > TWHEEL_MAX_TICKS) {
+        delay = TWHEEL_MAX_TICKS;
+    }
+    if(period > TWHEEL_MAX_TICKS) {
+        period = TWHEEL_MAX_TICKS;
+    }
+
+    primask = cpu_irq_save();
+
+    if(timer->pprev) {
+        twheel_unlink(timer);
+    } else {
+        twheel_count++;
+    }
+
+    timer->expires = twheel_now + delay;
+    timer->period = period;
+    twheel_insert(timer);
+
+    // Restart the tick, the first one a whole period from now
+    if(!twheel_running) {
+        MAP_TimerLoadSet(TWHEEL_TIMER_BASE, TIMER_A, twheel_load);
+        MAP_TimerEnable(TWHEEL_TIMER_BASE, TIMER_A);
+        twheel_running = true;
+    }
+
+    cpu_irq_restore(primask);
+}
+
+void twheel_stop(twheel_timer_t *timer) {
+    uint32_t primask = cpu_irq_save();
+
+    if(timer->pprev) {
+        twheel_unlink(timer);
+        twheel_count--;
+    }
+
+    // Left on the deferred queue, twheel_poll() skips it
+    timer->due = false;
+
+    cpu_irq_restore(primask);
+}
+
+bool twheel_active(const twheel_timer_t *timer) {
+    return timer->pprev != NULL;
+}
+
+uint32_t twheel_poll(void) {
+    twheel_timer_t *timer;
+    uint32_t primask, n = 0;
+    bool due;
+
+    for(;;) {
+        primask = cpu_irq_save();
+        timer = twheel_deferred_head;
+        if(timer) {
+            twheel_deferred_head = timer->deferred;
+            if(!twheel_deferred_head) {
+                twheel_deferred_tail = NULL;
+            }
+            timer->queued = false;
+            due = timer->due;
+            timer->due = false;
+        }
+        cpu_irq_restore(primask);
+
+        if(!timer) {
+            break;
+        }
+        if(due) {
+            timer->fn(timer->ctx);
+            n++;
+        }
+    }
+
+    return n;
+}
+
+void twheel_poll_cb(void *ctx) {
+    twheel_poll();
+}
+
+void twheel_set_notify(twheel_fn_t fn, void *ctx) {
+    uint32_t primask = cpu_irq_save();
+    twheel_notify = fn;
+    twheel_notify_ctx = ctx;
+    cpu_irq_restore(primask);
+}
+
+uint32_t twheel_ticks(void) {
+    return twheel_now;
+}
+
+// Move one slot of a level down to finer ones. Returns the slot index so
+// the caller knows whether the level wrapped as well
+static uint32_t twheel_cascade(uint32_t level) {
+    uint32_t index = (twheel_now >> (TWHEEL_SLOT_BITS * level)) & TWHEEL_SLOT_MASK;
+    twheel_timer_t *timer = twheel_wheel[level][index];
+    twheel_timer_t *next;
+
+    twheel_wheel[level][index] = NULL;
+    while(timer) {
+        next = timer->next;
+        twheel_insert(timer);
+        timer = next;
+    }
+
+    return index;
+}
+
+static void twheel_tick(void) {
+    uint32_t primask, index, level;
+    twheel_timer_t *timer;
+    twheel_timer_t *list;
+
+    primask = cpu_irq_save();
+
+    index = twheel_now & TWHEEL_SLOT_MASK;
+    if(index == 0) {
+        for(level = 1; level < TWHEEL_LEVELS && twheel_cascade(level) == 0; level++);
+    }
+
+    // Detach the due slot, so timers started by the callbacks for this
+    // tick go to the next one. twheel_stop() works on it unchanged
+    list = twheel_wheel[0][index];
+    twheel_wheel[0][index] = NULL;
+    if(list) {
+        list->pprev = &list;
+    }
+    twheel_now++;
+
+    while((timer = list)) {
+        twheel_unlink(timer);
+
+        // Periodic timers go back in before the callback, on their own grid
+        if(timer->period) {
+            timer->expires += timer->period;
+            twheel_insert(timer);
+        } else {
+            twheel_count--;
+        }
+
+        if(timer->mode == TWHEEL_ISR) {
+            cpu_irq_restore(primask);
+            timer->fn(timer->ctx);
+            primask = cpu_irq_save();
+        } else {
+            timer->due = true;
+            if(!timer->queued) {
+                timer->queued = true;
+                timer->deferred = NULL;
+                if(twheel_deferred_tail) {
+                    twheel_deferred_tail->deferred = timer;
+                } else {
+                    twheel_deferred_head = timer;
+                    if(twheel_notify) {
+                        twheel_notify(twheel_notify_ctx);
+                    }
+                }
+                twheel_deferred_tail = timer;
+            }
+        }
+    }
+
+    if(twheel_count == 0) {
+        MAP_TimerDisable(TWHEEL_TIMER_BASE, TIMER_A);
+        twheel_running = false;
+    }
+
+    cpu_irq_restore(primask);
+}
+
+// Bound into nvic_table by name
+void timer0a_handler(void) {
+    HWREG(TWHEEL_TIMER_BASE + TIMER_O_ICR) = TIMER_TIMA_TIMEOUT;
+    twheel_tick();
+}
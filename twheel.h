@@ -0,0 +1,101 @@
+#ifndef __TWHEEL_H__
+#define __TWHEEL_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Software timers on a hierarchical timing wheel, all driven by timer 0A.
+ *
+ * Time advances in ticks of TWHEEL_TICK_US. The wheel has TWHEEL_LEVELS
+ * levels of 64 slots; level n holds timers due within 64^(n+1) ticks, in
+ * the slot for their expiry tick at that level's resolution. Each tick runs
+ * the level 0 slot it lands on. Whenever a level comes round to slot 0, the
+ * next slot of the level above is moved down and sorted by finer
+ * resolution. Starting and stopping a timer is an O(1) list operation, and
+ * a tick costs the same however many timers are waiting. Timers due
+ * further out than the top level covers wait in it and are re-sorted each
+ * time round until they are in range.
+ *
+ * Timers are owned by the caller, usually as statics; nothing is
+ * allocated. Callbacks run either from the tick interrupt (TWHEEL_ISR) or
+ * from twheel_poll() in the main loop (TWHEEL_DEFERRED). The hardware
+ * timer only runs while some timer is started.
+ *
+ * With the event loop, deferred callbacks can run as one event:
+ *
+ *     static evloop_event_t timers_event;
+ *
+ *     evloop_event_init(&timers_event, twheel_poll_cb, NULL);
+ *     twheel_init();
+ *     twheel_set_notify(evloop_post_cb, &timers_event);
+ */
+
+// Tick length
+#ifndef TWHEEL_TICK_US
+#define TWHEEL_TICK_US 1000
+#endif
+
+// Levels of 64 slots. Four cover 2^24 ticks without re-sorting
+#ifndef TWHEEL_LEVELS
+#define TWHEEL_LEVELS 4
+#endif
+
+typedef void (*twheel_fn_t)(void *ctx);
+
+typedef enum {
+    TWHEEL_ISR = 0,             // call from the tick interrupt
+    TWHEEL_DEFERRED,            // call from twheel_poll()
+} twheel_mode_t;
+
+typedef struct twheel_timer {
+    struct twheel_timer *next;
+    struct twheel_timer **pprev;    // NULL when not in the wheel
+    uint32_t expires;               // tick
+    uint32_t period;                // ticks, 0 for one shot
+    twheel_fn_t fn;
+    void *ctx;
+    twheel_mode_t mode;
+
+    // Deferred queue
+    struct twheel_timer *deferred;
+    bool queued;
+    bool due;
+} twheel_timer_t;
+
+void twheel_init(void);
+
+void twheel_timer_init(twheel_timer_t *timer, twheel_fn_t fn, void *ctx, twheel_mode_t mode);
+
+// Fire after at least delay_us, then every period_us if that is nonzero,
+// both rounded up to whole ticks. Restarts the timer if it is already
+// running. Safe from interrupts and from callbacks
+void twheel_start(twheel_timer_t *timer, uint32_t delay_us, uint32_t period_us);
+
+// Stop the timer and drop a deferred callback that has not run yet
+void twheel_stop(twheel_timer_t *timer);
+
+bool twheel_active(const twheel_timer_t *timer);
+
+// Run the deferred callbacks that are due. Returns the number run
+uint32_t twheel_poll(void);
+
+// twheel_poll with an evloop_fn_t signature
+void twheel_poll_cb(void *ctx);
+
+// Called from the tick interrupt when the deferred queue stops being
+// empty, to wake whatever calls twheel_poll()
+void twheel_set_notify(twheel_fn_t fn, void *ctx);
+
+// Ticks processed so far. Stands still while no timer is running
+uint32_t twheel_ticks(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
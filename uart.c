@@ -0,0 +1,256 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_uart.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/pin_map.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/uart.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dma.h"
+#include "uart.h"
+
+#define UART_BASE           UART1_BASE
+#define UART_DMA_CHANNEL    UDMA_CHANNEL_UART1TX
+
+// Longest basic mode uDMA transfer
+#define UART_DMA_MAX        1024
+
+// Longest copy done with interrupts masked
+#define UART_COPY_CHUNK     64
+
+#if (UART_TX_BUF_LEN & (UART_TX_BUF_LEN - 1)) || (UART_RX_BUF_LEN & (UART_RX_BUF_LEN - 1))
+#error "UART buffer lengths must be powers of two"
+#endif
+
+// TX ring. Bytes in [tail, tail + dma_len) belong to an in-flight uDMA
+// transfer and are only released when it completes
+static char uart_tx_buf[UART_TX_BUF_LEN];
+static volatile uint32_t uart_tx_head;
+static volatile uint32_t uart_tx_tail;
+static volatile uint32_t uart_tx_dma_len;
+
+// RX ring, filled from the interrupt
+static char uart_rx_buf[UART_RX_BUF_LEN];
+static volatile uint32_t uart_rx_head;
+static volatile uint32_t uart_rx_tail;
+
+static uart_overflow_t uart_overflow = UART_OVERFLOW_BLOCK;
+static uart_stats_t uart_stats;
+static bool uart_ready;
+
+// Move queued bytes to the hardware. Called from the UART interrupt, or
+// with interrupts masked
+static void uart_tx_service(void) {
+    uint32_t n, off, run;
+
+    // Release the buffer behind a finished uDMA transfer
+    if(uart_tx_dma_len) {
+        if(MAP_uDMAChannelIsEnabled(UART_DMA_CHANNEL)) {
+            return;
+        }
+        uart_tx_tail += uart_tx_dma_len;
+        uart_tx_dma_len = 0;
+    }
+
+    n = uart_tx_head - uart_tx_tail;
+    if(n == 0) {
+        return;
+    }
+
+#if UART_DMA_THRESHOLD
+    // Long runs go out by uDMA, completion comes back on the UART vector
+    off = uart_tx_tail & (UART_TX_BUF_LEN - 1);
+    run = UART_TX_BUF_LEN - off;
+    if(run > n) {
+        run = n;
+    }
+    if(run >= UART_DMA_THRESHOLD) {
+        if(run > UART_DMA_MAX) {
+            run = UART_DMA_MAX;
+        }
+        MAP_uDMAChannelTransferSet(UART_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_MODE_BASIC,
+                                   &uart_tx_buf[off], (void *)(UART_BASE + UART_O_DR), run);
+        MAP_uDMAChannelEnable(UART_DMA_CHANNEL);
+        uart_tx_dma_len = run;
+        uart_stats.tx_bytes += run;
+        uart_stats.tx_dma++;
+        return;
+    }
+#else
+    (void)off;
+    (void)run;
+#endif
+
+    // Short runs: top up the FIFO, the TX interrupt fires as it drains
+    while(n && !(HWREG(UART_BASE + UART_O_FR) & UART_FR_TXFF)) {
+        HWREG(UART_BASE + UART_O_DR) = uart_tx_buf[uart_tx_tail & (UART_TX_BUF_LEN - 1)];
+        uart_tx_tail++;
+        uart_stats.tx_bytes++;
+        n--;
+    }
+}
+
+void uart_init(uint32_t baud) {
+    // Enable peripherals
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_UART1);
+    MAP_SysCtlPeripheralEnable(SYSCTL_PERIPH_GPIOB);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    // PB0 = U1RX, PB1 = U1TX
+    MAP_GPIOPinConfigure(GPIO_PB0_U1RX);
+    MAP_GPIOPinConfigure(GPIO_PB1_U1TX);
+    MAP_GPIOPinTypeUART(GPIO_PORTB_BASE, GPIO_PIN_0 | GPIO_PIN_1);
+
+    MAP_UARTConfigSetExpClk(UART_BASE, MAP_SysCtlClockGet(), baud,
+                            UART_CONFIG_WLEN_8 | UART_CONFIG_STOP_ONE | UART_CONFIG_PAR_NONE);
+    MAP_UARTFIFOLevelSet(UART_BASE, UART_FIFO_TX2_8, UART_FIFO_RX4_8);
+
+#if UART_DMA_THRESHOLD
+    dma_init();
+    MAP_uDMAChannelAttributeDisable(UART_DMA_CHANNEL, UDMA_ATTR_ALTSELECT |
+                                                      UDMA_ATTR_HIGH_PRIORITY |
+                                                      UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelControlSet(UART_DMA_CHANNEL | UDMA_PRI_SELECT,
+                              UDMA_SIZE_8 | UDMA_SRC_INC_8 | UDMA_DST_INC_NONE | UDMA_ARB_4);
+    MAP_UARTDMAEnable(UART_BASE, UART_DMA_TX);
+#endif
+
+    MAP_UARTIntEnable(UART_BASE, UART_INT_TX | UART_INT_RX | UART_INT_RT);
+    MAP_UARTEnable(UART_BASE);
+    MAP_IntEnable(INT_UART1);
+
+    uart_ready = true;
+}
+
+void uart_set_overflow(uart_overflow_t policy) {
+    if(policy < UART_OVERFLOW_TOTAL) {
+        uart_overflow = policy;
+    }
+}
+
+int uart_write(const char *ptr, int len) {
+    uint32_t primask, space, n, off, first;
+    int done = 0;
+
+    // Not set up yet, the UART is not even clocked
+    if(!uart_ready) {
+        return -1;
+    }
+
+    while(done < len) {
+        primask = cpu_irq_save();
+
+        space = UART_TX_BUF_LEN - (uart_tx_head - uart_tx_tail);
+
+        if(space == 0) {
+            if(uart_overflow == UART_OVERFLOW_OVERWRITE && uart_tx_dma_len == 0) {
+                // Make room by discarding the oldest byte. While uDMA is
+                // reading the oldest bytes this falls through to a drop
+                uart_tx_tail++;
+                uart_stats.tx_dropped++;
+                space = 1;
+            } else if(uart_overflow == UART_OVERFLOW_BLOCK && !cpu_in_isr() && !primask) {
+                // Let the interrupt drain the buffer and try again
+                cpu_irq_restore(primask);
+                continue;
+            } else {
+                uart_stats.tx_dropped += len - done;
+                cpu_irq_restore(primask);
+                break;
+            }
+        }
+
+        n = len - done;
+        if(n > space) {
+            n = space;
+        }
+        if(n > UART_COPY_CHUNK) {
+            n = UART_COPY_CHUNK;
+        }
+
+        // Copy in, splitting at the end of the ring
+        off = uart_tx_head & (UART_TX_BUF_LEN - 1);
+        first = UART_TX_BUF_LEN - off;
+        if(first > n) {
+            first = n;
+        }
+        memcpy(&uart_tx_buf[off], &ptr[done], first);
+        memcpy(&uart_tx_buf[0], &ptr[done + first], n - first);
+
+        uart_tx_head += n;
+        done += n;
+
+        uart_tx_service();
+
+        cpu_irq_restore(primask);
+    }
+
+    return done;
+}
+
+int uart_read(char *ptr, int len) {
+    int n = 0;
+
+    // Not set up yet, the UART is not even clocked
+    if(!uart_ready) {
+        return -1;
+    }
+
+    while(n < len && uart_rx_tail != uart_rx_head) {
+        ptr[n++] = uart_rx_buf[uart_rx_tail & (UART_RX_BUF_LEN - 1)];
+        __compiler_barrier();
+        uart_rx_tail++;
+    }
+
+    return n;
+}
+
+void uart_flush(void) {
+    if(!uart_ready) {
+        return;
+    }
+
+    while(uart_tx_head != uart_tx_tail);
+    while(HWREG(UART_BASE + UART_O_FR) & UART_FR_BUSY);
+}
+
+void uart_stats_get(uart_stats_t *stats) {
+    uint32_t primask = cpu_irq_save();
+    *stats = uart_stats;
+    cpu_irq_restore(primask);
+}
+
+// Bound into nvic_table by name
+void uart1_handler(void) {
+    uint32_t status = MAP_UARTIntStatus(UART_BASE, true);
+    MAP_UARTIntClear(UART_BASE, status);
+
+    // Drain the RX FIFO
+    while(!(HWREG(UART_BASE + UART_O_FR) & UART_FR_RXFE)) {
+        char c = HWREG(UART_BASE + UART_O_DR);
+
+        if(uart_rx_head - uart_rx_tail >= UART_RX_BUF_LEN) {
+            uart_stats.rx_dropped++;
+        } else {
+            uart_rx_buf[uart_rx_head & (UART_RX_BUF_LEN - 1)] = c;
+            __compiler_barrier();
+            uart_rx_head++;
+            uart_stats.rx_bytes++;
+        }
+    }
+
+    // TX FIFO below threshold or uDMA transfer done
+    uart_tx_service();
+}
@@ -0,0 +1,68 @@
+#ifndef __UART_H__
+#define __UART_H__
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Ring buffer sizes, must be powers of two
+#ifndef UART_TX_BUF_LEN
+#define UART_TX_BUF_LEN 512
+#endif
+
+#ifndef UART_RX_BUF_LEN
+#define UART_RX_BUF_LEN 128
+#endif
+
+// Contiguous runs at least this long are sent with uDMA instead of
+// refilling the FIFO from the interrupt. Set to 0 to never use uDMA
+#ifndef UART_DMA_THRESHOLD
+#define UART_DMA_THRESHOLD 16
+#endif
+
+// What uart_write does when the TX buffer is full. The oldest queued bytes
+// are the ones a running uDMA transfer is reading, so while one is in
+// flight OVERWRITE cannot discard them and drops the new bytes instead,
+// like DROP. When writes outpace the UART that is most of the time; set
+// UART_DMA_THRESHOLD to 0 if the newest bytes must always win
+typedef enum {
+    UART_OVERFLOW_BLOCK = 0,    // wait for space (drops if called from an ISR)
+    UART_OVERFLOW_DROP,         // discard what does not fit
+    UART_OVERFLOW_OVERWRITE,    // discard the oldest queued bytes, see above
+    UART_OVERFLOW_TOTAL
+} uart_overflow_t;
+
+typedef struct {
+    uint32_t tx_bytes;          // bytes handed to the hardware
+    uint32_t rx_bytes;          // bytes received into the RX buffer
+    uint32_t tx_dropped;        // bytes lost to a full TX buffer
+    uint32_t rx_dropped;        // bytes lost to a full RX buffer
+    uint32_t tx_dma;            // uDMA transfers started
+} uart_stats_t;
+
+// Configure UART1 (PB0/PB1) for 8N1 and start the buffered transport.
+// Until this is called UART1 is not clocked, and _write/_read fail with -1
+void uart_init(uint32_t baud);
+
+void uart_set_overflow(uart_overflow_t policy);
+
+// Queue up to len bytes, returns how many were accepted, or -1 before
+// uart_init()
+int uart_write(const char *ptr, int len);
+
+// Read up to len buffered bytes without blocking. Returns -1 before
+// uart_init()
+int uart_read(char *ptr, int len);
+
+// Block until everything queued has left the shift register
+void uart_flush(void);
+
+void uart_stats_get(uart_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
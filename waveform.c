@@ -0,0 +1,211 @@
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <inc/hw_types.h>
+#include <inc/hw_memmap.h>
+#include <inc/hw_ints.h>
+#include <inc/hw_gpio.h>
+#include <driverlib/rom.h>
+#include <driverlib/rom_map.h>
+#include <driverlib/sysctl.h>
+#include <driverlib/gpio.h>
+#include <driverlib/interrupt.h>
+#include <driverlib/timer.h>
+#include <driverlib/udma.h>
+
+#include "compiler.h"
+#include "cpu.h"
+#include "dma.h"
+#include "gpiopin.h"
+#include "waveform.h"
+
+// Sample clock, 32-bit half of a wide timer. Its timeouts request uDMA
+#define WAVEFORM_TIMER_BASE     WTIMER3_BASE
+#define WAVEFORM_TIMER_PERIPH   SYSCTL_PERIPH_WTIMER3
+#define WAVEFORM_TIMER_INT      INT_WTIMER3B
+#define WAVEFORM_DMA_ASSIGN     UDMA_CH25_WTIMER3B
+#define WAVEFORM_DMA_CHANNEL    (WAVEFORM_DMA_ASSIGN & 0xFF)
+
+static waveform_config_t waveform_cfg;
+static bool waveform_configured;
+static volatile bool waveform_running;
+
+// Masked GPIODATA address the samples go to
+static uint32_t waveform_dst;
+static uint32_t waveform_load;
+
+// Samples armed in each uDMA half, 0 if it is idle
+static uint32_t waveform_armed[2];
+static dma_pingpong_t waveform_dma = {WAVEFORM_DMA_CHANNEL};
+
+// fill() returned 0, play out what is armed and stop
+static bool waveform_ending;
+
+static waveform_stats_t waveform_stats;
+
+static uint8_t *waveform_buffer(uint32_t half) {
+    return waveform_cfg.buffers + half * waveform_cfg.len;
+}
+
+// Load a half with len samples. A half left with len 0 is marked stopped,
+// so the stream ends when uDMA reaches it
+static void waveform_arm(uint32_t half, uint32_t len) {
+    if(len > waveform_cfg.len) {
+        len = waveform_cfg.len;
+    }
+
+    MAP_uDMAChannelTransferSet(WAVEFORM_DMA_CHANNEL | (half ? UDMA_ALT_SELECT : UDMA_PRI_SELECT),
+                               len ? UDMA_MODE_PINGPONG : UDMA_MODE_STOP,
+                               waveform_buffer(half), (void *)waveform_dst, len ? len : 1);
+    waveform_armed[half] = len;
+    if(!len) {
+        waveform_ending = true;
+    }
+}
+
+int waveform_config(const waveform_config_t *config) {
+    uint32_t port_base, port_periph;
+
+    if(waveform_running || !config->pins) {
+        return -1;
+    }
+    if(gpio_port_lookup(config->port, &port_base, &port_periph) < 0) {
+        return -1;
+    }
+    if(config->rate_hz == 0 || !config->buffers || config->len == 0 ||
+       config->len > WAVEFORM_BUFFER_MAX || !config->fill) {
+        return -1;
+    }
+
+    waveform_cfg = *config;
+
+    // Writes through this address only reach the pins in the mask
+    waveform_dst = port_base + GPIO_O_DATA + ((uint32_t)config->pins << 2);
+
+    // Enable peripheral
+    MAP_SysCtlPeripheralEnable(WAVEFORM_TIMER_PERIPH);
+    MAP_SysCtlPeripheralEnable(port_periph);
+
+    // Delay at least 5 cycles to avoid bus fault
+    SysCtlDelay(2);
+
+    MAP_GPIOPinTypeGPIOOutput(port_base, config->pins);
+
+    waveform_load = MAP_SysCtlClockGet() / config->rate_hz;
+    if(waveform_load == 0) {
+        waveform_load = 1;
+    }
+
+    MAP_TimerConfigure(WAVEFORM_TIMER_BASE, TIMER_CFG_SPLIT_PAIR | TIMER_CFG_B_PERIODIC);
+    MAP_TimerLoadSet(WAVEFORM_TIMER_BASE, TIMER_B, waveform_load - 1);
+
+    // Each timeout requests one byte. The timeout interrupt itself stays
+    // masked, the timer vector only sees uDMA completions
+    dma_init();
+    MAP_uDMAChannelAssign(WAVEFORM_DMA_ASSIGN);
+    MAP_uDMAChannelAttributeDisable(WAVEFORM_DMA_CHANNEL, UDMA_ATTR_ALTSELECT | UDMA_ATTR_REQMASK);
+    MAP_uDMAChannelAttributeEnable(WAVEFORM_DMA_CHANNEL, UDMA_ATTR_HIGH_PRIORITY);
+    MAP_uDMAChannelControlSet(WAVEFORM_DMA_CHANNEL | UDMA_PRI_SELECT, UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_1);
+    MAP_uDMAChannelControlSet(WAVEFORM_DMA_CHANNEL | UDMA_ALT_SELECT, UDMA_SIZE_8 | UDMA_SRC_INC_8 |
+                              UDMA_DST_INC_NONE | UDMA_ARB_1);
+
+    waveform_configured = true;
+    return 0;
+}
+
+int waveform_start(void) {
+    uint32_t len;
+
+    if(!waveform_configured || waveform_running) {
+        return -1;
+    }
+
+    len = waveform_cfg.fill(waveform_cfg.ctx, waveform_buffer(0), waveform_cfg.len);
+    if(!len) {
+        return -1;
+    }
+
+    memset(&waveform_stats, 0, sizeof(waveform_stats));
+    waveform_stats.rate_hz = MAP_SysCtlClockGet() / waveform_load;
+    waveform_ending = false;
+
+    waveform_arm(0, len);
+    waveform_arm(1, waveform_cfg.fill(waveform_cfg.ctx, waveform_buffer(1), waveform_cfg.len));
+
+    dma_pingpong_start(&waveform_dma);
+
+    waveform_running = true;
+    MAP_IntEnable(WAVEFORM_TIMER_INT);
+
+    // First sample one period from now
+    MAP_TimerLoadSet(WAVEFORM_TIMER_BASE, TIMER_B, waveform_load - 1);
+    MAP_TimerEnable(WAVEFORM_TIMER_BASE, TIMER_B);
+
+    return 0;
+}
+
+void waveform_stop(void) {
+    MAP_TimerDisable(WAVEFORM_TIMER_BASE, TIMER_B);
+    MAP_IntDisable(WAVEFORM_TIMER_INT);
+    MAP_uDMAChannelDisable(WAVEFORM_DMA_CHANNEL);
+    waveform_running = false;
+}
+
+bool waveform_busy(void) {
+    return waveform_running;
+}
+
+void waveform_stats_get(waveform_stats_t *stats) {
+    uint32_t primask = cpu_irq_save();
+    *stats = waveform_stats;
+    cpu_irq_restore(primask);
+}
+
+// A half has gone out. Refill it for after the other one
+static bool waveform_complete(void *ctx, uint32_t half) {
+    (void)ctx;
+
+    if(!waveform_armed[half]) {
+        return false;
+    }
+
+    waveform_stats.buffers++;
+    waveform_stats.samples += waveform_armed[half];
+
+    if(waveform_ending) {
+        waveform_armed[half] = 0;
+    } else {
+        waveform_arm(half, waveform_cfg.fill(waveform_cfg.ctx, waveform_buffer(half), waveform_cfg.len));
+    }
+    return true;
+}
+
+static void waveform_service(void) {
+    if(dma_pingpong_service(&waveform_dma, waveform_complete, NULL)) {
+        return;
+    }
+
+    // The channel stopped on a half with nothing in it. At the end of the
+    // stream that is the last one played
+    if(!waveform_armed[waveform_dma.next]) {
+        MAP_TimerDisable(WAVEFORM_TIMER_BASE, TIMER_B);
+        MAP_IntDisable(WAVEFORM_TIMER_INT);
+        waveform_running = false;
+        if(waveform_cfg.done) {
+            waveform_cfg.done(waveform_cfg.ctx);
+        }
+        return;
+    }
+
+    // Otherwise fill() was late: the half uDMA stopped on has been refilled
+    // since, carry on from it
+    dma_pingpong_restart(&waveform_dma);
+    waveform_stats.underruns++;
+}
+
+// Bound into nvic_table by name
+void wtimer3b_handler(void) {
+    waveform_service();
+}
@@ -0,0 +1,92 @@
+#ifndef __WAVEFORM_H__
+#define __WAVEFORM_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Timed output patterns on GPIO pins, written by uDMA instead of the CPU.
+ *
+ * Wide timer 3B times out once per sample, and each timeout requests one
+ * uDMA transfer of a byte from a pattern buffer into the masked GPIODATA
+ * address of the port, so only the pins in the mask change and the rest
+ * of the port is left alone. Samples go out on the timer period with no
+ * CPU involvement; the only variation is a few cycles of bus arbitration
+ * with other uDMA channels and the CPU.
+ *
+ * uDMA ping-pongs between two buffers of len samples. When one has gone
+ * out, the timer interrupt calls fill() to refill it while the other one
+ * plays, so a stream runs for as long as fill() keeps returning samples.
+ * Returning fewer than len plays a short buffer; returning 0 ends the
+ * stream once the other buffer has gone out, then done() is called and the
+ * pins hold the last sample. If fill() is late and both buffers run out,
+ * the output stalls on the last sample until the interrupt re-arms, and
+ * the gap is counted as an underrun.
+ *
+ * Only one stream runs at a time. Channel 25, which the timer's requests
+ * use, is also SSI1 TX's, so SSI1 cannot use uDMA while a stream runs.
+ *
+ *     // WS2812 on PB6, three samples per bit at 2.4 MHz
+ *     static uint8_t buffers[2][384];
+ *
+ *     waveform_config_t config = {
+ *         1, GPIO_PIN_6, 2400000, &buffers[0][0], 384, encode_leds, frame_sent, NULL
+ *     };
+ *
+ *     waveform_config(&config);
+ *     waveform_start();
+ */
+
+// Longest buffer, one uDMA transfer
+#define WAVEFORM_BUFFER_MAX     1024
+
+// Called from the timer interrupt to refill a buffer. Returns the samples
+// written, up to len, or 0 to end the stream
+typedef uint32_t (*waveform_fill_cb_t)(void *ctx, uint8_t *buffer, uint32_t len);
+
+// Called from the timer interrupt when a stream has ended
+typedef void (*waveform_done_cb_t)(void *ctx);
+
+typedef struct {
+    uint32_t port;              // 0-5 for A-F, as in GPIOPin
+    uint8_t pins;               // pins driven, the rest of the port is untouched
+    uint32_t rate_hz;           // samples per second
+    uint8_t *buffers;           // 2 * len samples
+    uint32_t len;               // samples per buffer, up to WAVEFORM_BUFFER_MAX
+    waveform_fill_cb_t fill;
+    waveform_done_cb_t done;    // optional
+    void *ctx;
+} waveform_config_t;
+
+typedef struct {
+    uint32_t buffers;           // buffers played
+    uint64_t samples;           // samples played
+    uint32_t underruns;         // stalls with both buffers empty
+    uint32_t rate_hz;           // sample rate the timer was set to
+} waveform_stats_t;
+
+// Set up the pins, timer and uDMA channel. Call while stopped. Returns -1
+// if the configuration is invalid, otherwise 0. The rate actually produced
+// is the core clock over a whole divisor, see waveform_stats_get()
+int waveform_config(const waveform_config_t *config);
+
+// Fill both buffers and start playing. Returns -1 if not configured,
+// already running, or fill() had nothing to send
+int waveform_start(void);
+
+// Stop at once, partway through a buffer. done() is not called
+void waveform_stop(void);
+
+bool waveform_busy(void);
+
+void waveform_stats_get(waveform_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif